@@ -21,7 +21,8 @@ CNetworkEntity::CNetworkEntity()
 	m_vecMoveSpeed(CVector3()),
 	m_vecTurnSpeed(CVector3()),
 	m_entityId(INVALID_ENTITY),
-	m_eType(UNKNOWN_ENTITY)
+	m_eType(UNKNOWN_ENTITY),
+	m_uiSyncCount(0)
 {
 
 }
@@ -132,13 +133,13 @@ void CNetworkEntity::Pulse(CVehicleEntity * pVehicle)
 void CNetworkEntity::Serialize(ePackageType pType)
 {
 	// Create Sync package here and send it to the server
-	RakNet::BitStream * pBitStream = new BitStream;
+	RakNet::BitStream bitStream;
 
 	// Backup old sync
 	memcpy(&m_pEntityLastSync, &m_pEntitySync, sizeof(CNetworkEntitySync));
 
 	// Create package
-	m_pEntitySync = *(new CNetworkEntitySync);
+	m_pEntitySync = CNetworkEntitySync();
 
 	switch(m_eType)
 	{
@@ -198,11 +199,24 @@ void CNetworkEntity::Serialize(ePackageType pType)
 		}
 	}
 
-	// Write our Entity-Sync to the bitstream
-	pBitStream->Write((char *)&m_pEntitySync, sizeof(CNetworkEntitySync));
+	// Write the entity type
+	bitStream.Write((unsigned char)m_pEntitySync.pEntityType);
+
+	// Send a full keyframe every few packets (or if the type changed), so a lost delta can't desync us for long
+	bool bKeyframe = ((m_uiSyncCount % SYNC_KEYFRAME_INTERVAL) == 0 || m_pEntityLastSync.pEntityType != m_pEntitySync.pEntityType);
+
+	// Write our quantized Entity-Sync delta to the bitstream
+	if(m_pEntitySync.pEntityType == PLAYER_ENTITY)
+		NetSync::WriteDelta(&bitStream, m_pEntitySync.pPlayerPacket, m_pEntityLastSync.pPlayerPacket, bKeyframe);
+	else if(m_pEntitySync.pEntityType == VEHICLE_ENTITY)
+		NetSync::WriteDelta(&bitStream, m_pEntitySync.pVehiclePacket, m_pEntityLastSync.pVehiclePacket, bKeyframe);
+	else
+		return;
+
+	m_uiSyncCount++;
 
 	// Send package to network
-	g_pCore->GetNetworkManager()->Call(CString("0x69766D50_F%d", eRPCIdentifier::RPC_SYNC_PACKAGE).Get(), pBitStream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, true);
+	g_pCore->GetNetworkManager()->Call(RPC_SYNC_PACKAGE, &bitStream, HIGH_PRIORITY, UNRELIABLE_SEQUENCED, true);
 }
 
 void CNetworkEntity::Deserialize(ePackageType pType)
@@ -161,6 +161,7 @@ private:
 
 	CNetworkEntitySync				m_pEntitySync;
 	CNetworkEntitySync				m_pEntityLastSync;
+	unsigned int					m_uiSyncCount;
 
 	CNetworkEntitySubPlayer			m_pPlayerHandle;
 	CNetworkEntitySubVehicle		m_pVehicleHandle;
@@ -13,6 +13,7 @@
 #include <CCore.h>
 extern	CCore			* g_pCore;
 RakNet::RPC4			* CNetworkManager::m_pRPC = NULL;
+CRPCRegistry			* CNetworkManager::m_pRPCRegistry = NULL;
 
 CNetworkManager::CNetworkManager()
 {
@@ -25,8 +26,11 @@ CNetworkManager::CNetworkManager()
 	// Attact RPC4 to RakPeerInterface
 	m_pRakPeer->AttachPlugin(m_pRPC);
 
+	// Create the rpc registry
+	m_pRPCRegistry = new CRPCRegistry(m_pRPC);
+
 	// Register the RPC's
-	CNetworkRPC::Register(m_pRPC);
+	CNetworkRPC::Register(m_pRPCRegistry);
 
 	// Set the network state
 	SetNetworkState(NETSTATE_NONE);
@@ -45,7 +49,10 @@ CNetworkManager::~CNetworkManager()
 	}
 
 	// Unregister the RPC's
-	CNetworkRPC::Unregister(m_pRPC);
+	CNetworkRPC::Unregister(m_pRPCRegistry);
+
+	// Delete the rpc registry
+	SAFE_DELETE(m_pRPCRegistry);
 
 	// Detach RPC4 from RakPeerInterface
 	m_pRakPeer->DetachPlugin(m_pRPC);
@@ -116,7 +123,7 @@ void CNetworkManager::Disconnect(bool bShowMessage)
 		return;
 
 	// Unregister the RPC's
-	CNetworkRPC::Unregister(m_pRPC);
+	CNetworkRPC::Unregister(m_pRPCRegistry);
 
 	// Close the connection
 	m_pRakPeer->CloseConnection(RakNet::UNASSIGNED_SYSTEM_ADDRESS, true);
@@ -186,6 +193,16 @@ void CNetworkManager::Call(const char * szIdentifier, RakNet::BitStream * pBitSt
 	m_pRPC->Call(szIdentifier, pBitStream, priority, reliability, 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, bBroadCast);
 }
 
+void CNetworkManager::Call(eRPCIdentifier rpcId, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, bool bBroadCast)
+{
+	// Are we not connected to a server?
+	if(!IsConnected())
+		return;
+
+	// Send it with the numeric id
+	CRPCRegistry::Call(m_pRakPeer, rpcId, pBitStream, priority, reliability, 0, RakNet::UNASSIGNED_SYSTEM_ADDRESS, bBroadCast);
+}
+
 void CNetworkManager::UpdateNetwork()
 {
 	// Create a packet
@@ -196,6 +213,13 @@ void CNetworkManager::UpdateNetwork()
 	{
 		switch(pPacket->data[0])
 		{
+			case ID_NUMERIC_RPC:
+			{
+				// Pass it to the rpc registry
+				m_pRPCRegistry->Process(pPacket);
+				break;
+			}
+
 			case ID_NO_FREE_INCOMING_CONNECTIONS:
 			{
 				g_pCore->GetChat()->Outputf(true, "#16C5F2The server is full. Rerying...");
@@ -295,5 +319,5 @@ void CNetworkManager::ConnectionAccepted(RakNet::Packet * pPacket)
 	pBitStream.Write(RakNet::RakString(SharedUtility::GetSerialHash().Get()));
 
 	// Send to the server
-	Call(GET_RPC_CODEX(RPC_INITIAL_DATA), &pBitStream, HIGH_PRIORITY, RELIABLE_ORDERED, true);
+	Call(RPC_INITIAL_DATA, &pBitStream, HIGH_PRIORITY, RELIABLE_ORDERED, true);
 }
@@ -11,11 +11,13 @@
 #define CNetworkManager_h
 
 #include <NetCommon.h>
+#include <CRPCRegistry.hpp>
 
 class CNetworkManager {
 private:
 	RakNet::RakPeerInterface				* m_pRakPeer;
 	static RakNet::RPC4						* m_pRPC;
+	static CRPCRegistry						* m_pRPCRegistry;
 
 	eNetworkState							m_eNetworkState;
 	unsigned int							m_uiLastConnectionTry;
@@ -45,9 +47,11 @@ public:
 	void									Pulse();
 
 	void									Call(const char * szIdentifier, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, bool bBroadCast);
+	void									Call(eRPCIdentifier rpcId, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, bool bBroadCast);
 
 	RakNet::RakPeerInterface				* GetRakPeer() { return m_pRakPeer; }
 	static RakNet::RPC4						* GetRPC() { return m_pRPC; }
+	static CRPCRegistry						* GetRPCRegistry() { return m_pRPCRegistry; }
 
 };
 
@@ -60,30 +60,30 @@ void PlayerLeave(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
 }
 
 
-void CNetworkRPC::Register(RakNet::RPC4 * pRPC)
+void CNetworkRPC::Register(CRPCRegistry * pRegistry)
 {
 	// Are we not already registered?
 	if(!m_bRegistered)
 	{
 		// Register the RPCs
-		pRPC->RegisterFunction(GET_RPC_CODEX(RPC_START_GAME), StartGame);
-		pRPC->RegisterFunction(GET_RPC_CODEX(RPC_NEW_PLAYER), PlayerJoin);
-		pRPC->RegisterFunction(GET_RPC_CODEX(RPC_DELETE_PLAYER), PlayerLeave);
+		pRegistry->Register(RPC_START_GAME, StartGame);
+		pRegistry->Register(RPC_NEW_PLAYER, PlayerJoin);
+		pRegistry->Register(RPC_DELETE_PLAYER, PlayerLeave);
 		
 		// Mark as registered
 		m_bRegistered = true;
 	}
 }
 
-void CNetworkRPC::Unregister(RakNet::RPC4 * pRPC)
+void CNetworkRPC::Unregister(CRPCRegistry * pRegistry)
 {
 	// Are we registered?
 	if(m_bRegistered)
 	{
 		// Unregister the RPCs
-		pRPC->UnregisterFunction(GET_RPC_CODEX(RPC_START_GAME));
-		pRPC->UnregisterFunction(GET_RPC_CODEX(RPC_NEW_PLAYER));
-		pRPC->UnregisterFunction(GET_RPC_CODEX(RPC_DELETE_PLAYER));
+		pRegistry->Unregister(RPC_START_GAME);
+		pRegistry->Unregister(RPC_NEW_PLAYER);
+		pRegistry->Unregister(RPC_DELETE_PLAYER);
 		
 		// Mark as not registered
 		m_bRegistered = false;
@@ -13,14 +13,15 @@
 #include <NetCommon.h>
 #include <Network/RPCIdentifiers.h>
 #include <CRPCHandler.hpp>
+#include <CRPCRegistry.hpp>
 
 class CNetworkRPC {
 private:
 	static	bool			m_bRegistered;
 
 public:
-	static	void			Register(RakNet::RPC4 * pRPC);
-	static	void			Unregister(RakNet::RPC4 * pRPC);
+	static	void			Register(CRPCRegistry * pRegistry);
+	static	void			Unregister(CRPCRegistry * pRegistry);
 };
 
 #endif
\ No newline at end of file
@@ -14,11 +14,25 @@ CNetworkServer::CNetworkServer()
 {
 	m_pNetPeer = new RakNet::RakPeer();
 	m_pNetPeer->AttachPlugin(this);
+
+	// Reset the player socket table
+	memset(m_pPlayerSockets, 0, sizeof(m_pPlayerSockets));
+	m_uiPlayerSocketCount = 0;
+
+	m_pProcessingPacket = NULL;
 }
 
 // Cleanup
 CNetworkServer::~CNetworkServer()
 {
+	// Delete all remaining player sockets
+	for(EntityId playerId = 0; playerId < MAX_PLAYERS; ++playerId)
+		RemovePlayerSocket(playerId);
+
+	// Delete all pooled packets
+	for(size_t i = 0; i < m_packetPool.size(); i++)
+		delete m_packetPool[i];
+
 	SAFE_DELETE(m_pNetPeer);
 }
 
@@ -53,7 +67,7 @@ PacketId CNetworkServer::ProcessPacket(RakNet::SystemAddress systemAddress, Pack
 		}
 
 		// Is this not a pre-connect packet?
-		if(packetId != ID_NEW_INCOMING_CONNECTION && packetId != ID_USER_PACKET_ENUM)
+		if(packetId != ID_NEW_INCOMING_CONNECTION && packetId != ID_USER_PACKET_ENUM && packetId != (ID_USER_PACKET_ENUM + 1))
 		{
 			// Don't process the packet
 			return INVALID_PACKET_ID;
@@ -95,18 +109,27 @@ PacketId CNetworkServer::ProcessPacket(RakNet::SystemAddress systemAddress, Pack
 	return packetId;
 }
 
+// Gets an unused packet from the pool
+NetPacket * CNetworkServer::AcquirePacket()
+{
+	// Is the pool empty?
+	if(m_packetPool.empty())
+		return new NetPacket;
+
+	// Take the last packet from the pool
+	NetPacket * pPacket = m_packetPool.back();
+	m_packetPool.pop_back();
+	return pPacket;
+}
+
 // Receives a next packet on peer
 NetPacket * CNetworkServer::Receive()
 {
-	// Get a packet from the RakNet packet queue
-	// and then construct NetPacket
-	RakNet::Packet * pRakPacket = m_pNetPeer->Receive();
+	RakNet::Packet * pRakPacket = NULL;
 
-	// Did we get a packet?
-	if(pRakPacket)
+	// Get packets from the RakNet packet queue until we find one we have to handle
+	while(pRakPacket = m_pNetPeer->Receive())
 	{
-		NetPacket * pPacket = NULL;
-
 		// Get the data
 		unsigned char * ucData = (pRakPacket->data + sizeof(PacketId));
 
@@ -116,37 +139,32 @@ NetPacket * CNetworkServer::Receive()
 		// Process the packet and get the packet id
 		PacketId packetId = ProcessPacket(pRakPacket->systemAddress, pRakPacket->data[0], ucData, uiLength);
 
-		// Is this a valid packet?
-		if(packetId != INVALID_PACKET_ID)
+		// Is this not a valid packet?
+		if(packetId == INVALID_PACKET_ID)
 		{
-			// Create the new packet
-			pPacket = new NetPacket;
+			// Delete the RakNet packet
+			m_pNetPeer->DeallocatePacket(pRakPacket);
+			continue;
+		}
+
+		// Get a packet from the pool
+		NetPacket * pPacket = AcquirePacket();
 
-			// Set the packet player socket
+		// Is the client ready? Create its player socket
+		if(packetId == PACKET_NEW_CONNECTION)
+			pPacket->pPlayerSocket = AddPlayerSocket(pRakPacket->systemAddress);
+		else
 			pPacket->pPlayerSocket = GetPlayerSocket((EntityId)pRakPacket->systemAddress.systemIndex);
 
-			// Set the packet id
-			pPacket->id = packetId;
-
-			// Set the packet length
-			pPacket->dataSize = uiLength;
-
-			// Do we have any packet data?
-			if(uiLength > 0)
-			{
-				// Allocate and copy the packet data
-				pPacket->data = new unsigned char[uiLength];
-				memcpy(pPacket->data, ucData, uiLength);
-			}
-			else
-			{
-				// Reset the packet data pointer
-				pPacket->data = NULL;
-			}
-		}
+		// Set the packet id
+		pPacket->id = packetId;
 
-		// Delete the RakNet packet
-		m_pNetPeer->DeallocatePacket(pRakPacket);
+		// Set the packet length
+		pPacket->dataSize = uiLength;
+
+		// Point directly into the RakNet packet, it stays alive until DeallocatePacket
+		pPacket->data = (uiLength > 0 ? ucData : NULL);
+		pPacket->pRakPacket = pRakPacket;
 		return pPacket;
 	}
 
@@ -160,21 +178,59 @@ void CNetworkServer::DeallocatePacket(NetPacket * pPacket)
 	// Check if we have a disconnection packet
 	if(pPacket->id == PACKET_DISCONNECTED || pPacket->id == PACKET_LOST_CONNECTION)
 	{
-		// Get the player socket
-		CNetPlayerSocket * pPlayerSocket = pPacket->pPlayerSocket;
-
 		// Delete the player socket
-		SAFE_DELETE(pPlayerSocket);
+		if(pPacket->pPlayerSocket)
+			RemovePlayerSocket(pPacket->pPlayerSocket->playerId);
+	}
 
-		// Remove the player socket from the player socket list
-		if(m_playerSocketsList.size() == 1)
-			m_playerSocketsList.clear();
-		else
-			m_playerSocketsList.remove(pPlayerSocket);
+	ReleasePacket(pPacket);
+}
+
+// Copies a packet so a handler can keep it
+NetPacket * CNetworkServer::CopyPacket(NetPacket * pPacket)
+{
+	// Get a packet from the pool
+	NetPacket * pCopy = AcquirePacket();
+	pCopy->id = pPacket->id;
+	pCopy->dataSize = pPacket->dataSize;
+	pCopy->pPlayerSocket = pPacket->pPlayerSocket;
+	pCopy->pRakPacket = NULL;
+
+	// Do we have any packet data?
+	if(pPacket->dataSize > 0)
+	{
+		// Allocate and copy the packet data
+		pCopy->data = new unsigned char[pPacket->dataSize];
+		memcpy(pCopy->data, pPacket->data, pPacket->dataSize);
+	}
+	else
+	{
+		// Reset the packet data pointer
+		pCopy->data = NULL;
+	}
+
+	return pCopy;
+}
+
+// Gives a packet back to the pool
+void CNetworkServer::ReleasePacket(NetPacket * pPacket)
+{
+	// Does the data still belong to RakNet?
+	if(pPacket->pRakPacket)
+	{
+		// Delete the RakNet packet
+		m_pNetPeer->DeallocatePacket(pPacket->pRakPacket);
+		pPacket->pRakPacket = NULL;
+		pPacket->data = NULL;
+	}
+	else
+	{
+		// Delete our own copy
+		SAFE_DELETE_ARRAY(pPacket->data);
 	}
 
-	SAFE_FREE(pPacket->data);
-	SAFE_DELETE(pPacket);
+	// Put the packet back into the pool
+	m_packetPool.push_back(pPacket);
 }
 
 // Network server pulse
@@ -185,9 +241,14 @@ void CNetworkServer::Process()
 	// Loop until we have processed all packets in the packet queue (if any)
 	while(pPacket = Receive())
 	{
+		m_pProcessingPacket = pPacket;
+
+		// The handler reads the data through a bit stream view, nothing gets copied
 		if(m_pRpcHandler)
 			m_pRpcHandler->HandlePacket(pPacket);
 
+		m_pProcessingPacket = NULL;
+
 		// Deallocate the packet memory used
 		DeallocatePacket(pPacket);
 	}
@@ -231,18 +292,52 @@ void CNetworkServer::DisconnectPlayer(EntityId playerId, bool bSendDisconnection
 
 
 
+// Creates the socket for a newly connected player
+CNetPlayerSocket * CNetworkServer::AddPlayerSocket(RakNet::SystemAddress systemAddress)
+{
+	// Get the player id
+	EntityId playerId = (EntityId)systemAddress.systemIndex;
+
+	// Is the player id out of range?
+	if(playerId >= MAX_PLAYERS)
+		return NULL;
+
+	// Do we already have a socket for this player?
+	if(m_pPlayerSockets[playerId])
+		return m_pPlayerSockets[playerId];
+
+	// Create the player socket
+	CNetPlayerSocket * pPlayerSocket = new CNetPlayerSocket;
+	pPlayerSocket->playerId = playerId;
+	pPlayerSocket->ulBinaryAddress = systemAddress.address.addr4.sin_addr.s_addr;
+	pPlayerSocket->usPort = systemAddress.GetPort();
+
+	// Store it in the player socket table
+	m_pPlayerSockets[playerId] = pPlayerSocket;
+	m_uiPlayerSocketCount++;
+	return pPlayerSocket;
+}
+
+// Deletes the socket of a player
+void CNetworkServer::RemovePlayerSocket(EntityId playerId)
+{
+	// Is there a socket for this player?
+	if(playerId >= MAX_PLAYERS || !m_pPlayerSockets[playerId])
+		return;
+
+	// Delete the player socket and free the slot
+	SAFE_DELETE(m_pPlayerSockets[playerId]);
+	m_uiPlayerSocketCount--;
+}
+
 // Returns socket for specified player
 CNetPlayerSocket * CNetworkServer::GetPlayerSocket(EntityId playerId)
 {
-	// Loop through the player socket list
-	for(std::list<CNetPlayerSocket *>::iterator iter = m_playerSocketsList.begin(); iter != m_playerSocketsList.end(); iter++)
-	{
-		// Is this the player socket we are looking for?
-		if((*iter)->playerId == playerId)
-			return (*iter);
-	}
+	// Is the player id out of range?
+	if(playerId >= MAX_PLAYERS)
+		return NULL;
 
-	return NULL;
+	return m_pPlayerSockets[playerId];
 }
 
 // Returns true if specified playerId is not invalid and player is connected
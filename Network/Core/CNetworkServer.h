@@ -13,18 +13,25 @@
 #include "CRakNetInterface.h"
 #include "NetCommon.h"
 #include <list>
+#include <vector>
 #include "CRPCHandler.hpp"
 
 class CNetworkServer : CRakNetInterface {
 
 private:
 	RakNet::RakPeer * m_pNetPeer;
-	std::list< CNetPlayerSocket* > m_playerSocketsList;
+	CNetPlayerSocket * m_pPlayerSockets[MAX_PLAYERS];
+	unsigned int m_uiPlayerSocketCount;
+	std::vector< NetPacket* > m_packetPool;
+	NetPacket * m_pProcessingPacket;
 	CRPCHandler * m_pRpcHandler;
 
+	NetPacket * AcquirePacket();
 	NetPacket * Receive();
 	PacketId ProcessPacket(RakNet::SystemAddress systemAddress, PacketId packetId, unsigned char * ucData, int iLength);
 	void DeallocatePacket(NetPacket * pPacket);
+	CNetPlayerSocket * AddPlayerSocket(RakNet::SystemAddress systemAddress);
+	void RemovePlayerSocket(EntityId playerId);
 	inline unsigned int Send(CBitStream * pBitStream, ePacketPriority priority, ePacketReliability reliability, EntityId playerId, bool bBroadcast, char cOrderingChannel = PACKET_CHANNEL_DEFAULT);
 
 public:
@@ -38,6 +45,13 @@ public:
 
 	CNetPlayerSocket * GetPlayerSocket(EntityId playerId);
 	bool IsPlayerConnected(EntityId playerId);
+	unsigned int GetPlayerCount() { return m_uiPlayerSocketCount; }
+
+	// Packet which is currently being dispatched, its data is only valid until the handler returns
+	NetPacket * GetProcessingPacket() { return m_pProcessingPacket; }
+	// Copies a packet so it stays valid after its handler returned, free it with ReleasePacket
+	NetPacket * CopyPacket(NetPacket * pPacket);
+	void ReleasePacket(NetPacket * pPacket);
 	void BanIp(string strIpAddress, unsigned int uiTimeMilliseconds);
 	void UnbanIp(string strIpAddress);
 	int GetPlayerLastPing(EntityId playerId);
@@ -46,6 +60,9 @@ public:
 
 	CRPCHandler * GetRpcHandler() { return m_pRpcHandler; }
 	void SetRpcHandler(CRPCHandler * pRpcHandler) { m_pRpcHandler = pRpcHandler; }
+
+	// Event which gets signaled from the RakNet update thread as soon as a packet was queued
+	void SetWakeEvent(RakNet::SignaledEvent * pWakeEvent) { m_pNetPeer->SetIncomingPacketEvent(pWakeEvent); }
 };
 
 #endif // CNetworkServer_h
\ No newline at end of file
@@ -11,7 +11,6 @@
 #define CRPCHandler_hpp
 
 #include "NetCommon.h"
-#include <list>
 
 typedef void (* RPCFunction_t)(CBitStream * pBitStream, CNetPlayerSocket * pSenderSocket);
 
@@ -25,66 +24,48 @@ struct RPCFunction
 class CRPCHandler
 {
 private:
-	std::list<RPCFunction *> m_rpcFunctionList;
+	// Indexed by the rpc id, rpcFunction is NULL for unused slots
+	RPCFunction m_rpcFunctions[RPC_MAX];
 
 public:
-	~CRPCHandler()
+	CRPCHandler()
 	{
-		// Remove any iters in list
-
-		for(std::list<RPCFunction *>::iterator i = m_rpcFunctionList.begin(); i != m_rpcFunctionList.end(); i++)
-			delete (*i);
+		// Reset the rpc function table
+		memset(m_rpcFunctions, 0, sizeof(m_rpcFunctions));
 	}
 
 	bool AddFunction(eRPCIdentifier rpcId, RPCFunction_t rpcFunction)
 	{
-		// Make sure it isn't already added
-		RPCFunction * pFunction = GetFunctionFromIdentifier(rpcId);
+		// Is the id out of range?
+		if(rpcId >= RPC_MAX)
+			return false;
 
 		// We do not allow several functions per rpc
-		if(pFunction)
+		if(m_rpcFunctions[rpcId].rpcFunction)
 			return false;
 
-		// Create the rpc function
-		pFunction = new RPCFunction;
-		pFunction->rpcId = rpcId;
-		pFunction->rpcFunction = rpcFunction;
-	
-		// Add it to the rpc function list
-		m_rpcFunctionList.push_back(pFunction);
+		// Store the rpc function
+		m_rpcFunctions[rpcId].rpcId = rpcId;
+		m_rpcFunctions[rpcId].rpcFunction = rpcFunction;
 		return true;
 	}
 
 	// Remove function
 	void RemoveFunction(RPCIdentifier rpcId)
 	{
-		// Get the function
-		RPCFunction * pFunction = GetFunctionFromIdentifier(rpcId);
-
-		// Remove it from the rpc function list
-		while(pFunction)
-		{
-			m_rpcFunctionList.remove(pFunction);
-			delete pFunction;
-
-			pFunction = GetFunctionFromIdentifier(rpcId);
-		}
+		// Clear the slot
+		if(rpcId < RPC_MAX)
+			m_rpcFunctions[rpcId].rpcFunction = NULL;
 	}
 
 	// Get function pointer from specified RPC
 	RPCFunction * GetFunctionFromIdentifier(RPCIdentifier rpcId)
 	{
-		// Iterate through all rpc functions
-		std::list<RPCFunction *>::iterator iter;
-		for(iter = m_rpcFunctionList.begin(); iter != m_rpcFunctionList.end(); iter++)
-		{
-			// Is this the function we're after?
-			if((*iter)->rpcId == rpcId)
-				return (*iter);
-		}
+		// Is the id out of range or the slot unused?
+		if(rpcId >= RPC_MAX || !m_rpcFunctions[rpcId].rpcFunction)
+			return NULL;
 
-		// Function not found
-		return NULL;
+		return &m_rpcFunctions[rpcId];
 	}
 
 	// Handle packet with this RPC handler
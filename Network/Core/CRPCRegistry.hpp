@@ -0,0 +1,154 @@
+//================ IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ================
+//
+// File: CRPCRegistry.hpp
+// Project: Network.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CRPCRegistry_hpp
+#define CRPCRegistry_hpp
+
+#include "NetCommon.h"
+#include <stdio.h>
+
+// Message id used for rpcs which are sent with their numeric id
+#define ID_NUMERIC_RPC (ID_USER_PACKET_ENUM + 10)
+
+typedef void (* RPC4Function_t)(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket);
+
+// Statistics slot used for rpcs with an out of range or unregistered id
+#define RPC_STATISTICS_UNKNOWN RPC_MAX
+
+// Traffic counters of a single rpc
+struct RPCStatistics
+{
+	unsigned long ulCalls;
+	unsigned long ulBytes;
+};
+
+class CRPCRegistry
+{
+private:
+	RakNet::RPC4 * m_pRPC;
+	RPC4Function_t m_rpcFunctions[RPC_MAX];
+	char m_szNames[RPC_MAX][16];
+	RPCStatistics m_rpcStatistics[RPC_MAX + 1];
+	bool m_bStatisticsEnabled;
+
+public:
+	CRPCRegistry(RakNet::RPC4 * pRPC)
+	{
+		m_pRPC = pRPC;
+		memset(m_rpcFunctions, 0, sizeof(m_rpcFunctions));
+
+		// Format the RPC4 names once
+		for(int i = 0; i < RPC_MAX; i++)
+			sprintf(m_szNames[i], "IVMP0xF%dF", i);
+
+		m_bStatisticsEnabled = false;
+		ResetStatistics();
+	}
+
+	// Returns the RPC4 name of an rpc
+	const char * GetName(RPCIdentifier rpcId)
+	{
+		if(rpcId >= RPC_MAX)
+			return "";
+
+		return m_szNames[rpcId];
+	}
+
+	// Registers a function for the numeric id, and under its RPC4 name for peers which still call by name
+	bool Register(eRPCIdentifier rpcId, RPC4Function_t rpcFunction)
+	{
+		// Is the id out of range or already in use?
+		if(rpcId >= RPC_MAX || m_rpcFunctions[rpcId])
+			return false;
+
+		m_rpcFunctions[rpcId] = rpcFunction;
+		m_pRPC->RegisterFunction(GetName(rpcId), rpcFunction);
+		return true;
+	}
+
+	void Unregister(eRPCIdentifier rpcId)
+	{
+		// Is the id out of range or not in use?
+		if(rpcId >= RPC_MAX || !m_rpcFunctions[rpcId])
+			return;
+
+		m_rpcFunctions[rpcId] = NULL;
+		m_pRPC->UnregisterFunction(GetName(rpcId));
+	}
+
+	// Handles a numeric rpc packet, returns false if the packet isn't one
+	bool Process(RakNet::Packet * pPacket)
+	{
+		// Is this a numeric rpc?
+		if(pPacket->length < (sizeof(RakNet::MessageID) + sizeof(RPCIdentifier)) || pPacket->data[0] != ID_NUMERIC_RPC)
+			return false;
+
+		// Construct a bit stream on the packet data
+		RakNet::BitStream bitStream(pPacket->data, pPacket->length, false);
+		bitStream.IgnoreBytes(sizeof(RakNet::MessageID));
+
+		// Read the rpc id
+		RPCIdentifier rpcId;
+		bitStream.Read(rpcId);
+
+		// Is the id out of range or not in use?
+		bool bKnown = (rpcId < RPC_MAX && m_rpcFunctions[rpcId]);
+
+		// Count the traffic
+		if(m_bStatisticsEnabled)
+		{
+			RPCStatistics * pStatistics = &m_rpcStatistics[bKnown ? rpcId : RPC_STATISTICS_UNKNOWN];
+			pStatistics->ulCalls++;
+			pStatistics->ulBytes += pPacket->length;
+		}
+
+		// Call the function
+		if(bKnown)
+			m_rpcFunctions[rpcId](&bitStream, pPacket);
+
+		return true;
+	}
+
+	void SetStatisticsEnabled(bool bEnabled) { m_bStatisticsEnabled = bEnabled; }
+	bool GetStatisticsEnabled() { return m_bStatisticsEnabled; }
+
+	// Returns the statistics of an rpc, RPC_STATISTICS_UNKNOWN returns the ones of unknown rpcs
+	RPCStatistics * GetStatistics(RPCIdentifier rpcId)
+	{
+		if(rpcId > RPC_STATISTICS_UNKNOWN)
+			return NULL;
+
+		return &m_rpcStatistics[rpcId];
+	}
+
+	void ResetStatistics()
+	{
+		memset(m_rpcStatistics, 0, sizeof(m_rpcStatistics));
+	}
+
+	// Sends an rpc with its numeric id
+	static uint32_t Call(RakNet::RakPeerInterface * pRakPeer, eRPCIdentifier rpcId, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, char cOrderingChannel, const RakNet::AddressOrGUID systemIdentifier, bool bBroadcast)
+	{
+		// Write the header
+		RakNet::BitStream bitStream;
+		bitStream.Write((RakNet::MessageID)ID_NUMERIC_RPC);
+		bitStream.Write((RPCIdentifier)rpcId);
+
+		// Append the data
+		if(pBitStream)
+		{
+			pBitStream->ResetReadPointer();
+			bitStream.Write(pBitStream);
+		}
+
+		return pRakPeer->Send(&bitStream, priority, reliability, cOrderingChannel, systemIdentifier, bBroadcast);
+	}
+};
+
+#endif // CRPCRegistry_hpp
@@ -105,6 +105,7 @@ struct NetPacket
 	unsigned char * data;
 
 	CNetPlayerSocket * pPlayerSocket; // used on server only
+	RakNet::Packet * pRakPacket; // used on server only, set while data points into the RakNet packet
 };
 
 // indicates in which step of connecting/joining some server we are now
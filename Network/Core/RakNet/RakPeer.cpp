@@ -208,6 +208,7 @@ RakPeer::RakPeer()
 	endThreads = true;
 	isMainLoopThreadActive = false;
 	incomingDatagramEventHandler=0;
+	incomingPacketEvent=0;
 
 
 
@@ -2948,6 +2949,11 @@ void RakPeer::SetIncomingDatagramEventHandler( bool (*_incomingDatagramEventHand
 	incomingDatagramEventHandler=_incomingDatagramEventHandler;
 }
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void RakPeer::SetIncomingPacketEvent( SignaledEvent *_incomingPacketEvent )
+{
+	incomingPacketEvent=_incomingPacketEvent;
+}
+// --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool RakPeer::SendOutOfBand(const char *host, unsigned short remotePort, const char *data, BitSize_t dataLength, unsigned connectionSocketIndex )
 {
 	if ( IsActive() == false )
@@ -4427,6 +4433,11 @@ inline void RakPeer::AddPacketToProducer(RakNet::Packet *p)
 	packetReturnMutex.Lock();
 	packetReturnQueue.Push(p,_FILE_AND_LINE_);
 	packetReturnMutex.Unlock();
+
+	// Signal after the push, so whoever waits on it finds the packet
+	SignaledEvent *event=incomingPacketEvent;
+	if (event)
+		event->SetEvent();
 }
 // --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 union Buff6AndBuff8
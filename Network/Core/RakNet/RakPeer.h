@@ -569,6 +569,10 @@ public:
 	/// RNS2RecvStruct will only remain valid for the duration of the call
 	virtual void SetIncomingDatagramEventHandler( bool (*_incomingDatagramEventHandler)(RNS2RecvStruct *) );
 
+	/// Set an event to be signaled from the update thread whenever a packet was queued for Receive()
+	/// \param[in] _incomingPacketEvent The event to signal, or 0 to stop signaling
+	virtual void SetIncomingPacketEvent( SignaledEvent *_incomingPacketEvent );
+
 	// --------------------------------------------------------------------------------------------Network Simulator Functions--------------------------------------------------------------------------------------------
 	/// Adds simulated ping and packet loss to the outgoing data flow.
 	/// To simulate bi-directional ping and packet loss, you should call this on both the sender and the recipient, with half the total ping and packetloss value on each.
@@ -960,6 +964,7 @@ protected:
 	RakNet::TimeMS unreliableTimeout;
 
 	bool (*incomingDatagramEventHandler)(RNS2RecvStruct *);
+	SignaledEvent *volatile incomingPacketEvent;
 
 	// Systems in this list will not go through the secure connection process, even when secure connections are turned on. Wildcards are accepted.
 	DataStructures::List<RakNet::RakString> securityExceptionList;
@@ -27,6 +27,7 @@ struct RakNetStatistics;
 struct RakNetBandwidth;
 class RouterInterface;
 class NetworkIDManager;
+class SignaledEvent;
 
 /// The primary interface for RakNet, RakPeer contains all major functions for the library.
 /// See the individual functions for what the class can do.
@@ -533,6 +534,11 @@ public:
 	/// For RakNet connected systems, the first bit is always 1. So for your own game packets, make sure the first bit is always 0.
 	virtual void SetIncomingDatagramEventHandler( bool (*_incomingDatagramEventHandler)(RNS2RecvStruct *) )=0;
 
+	/// Set an event to be signaled from the update thread whenever a packet was queued for Receive()
+	/// Unlike the incoming datagram handler, the packet can already be read by the time the event is set
+	/// \param[in] _incomingPacketEvent The event to signal, or 0 to stop signaling
+	virtual void SetIncomingPacketEvent( SignaledEvent *_incomingPacketEvent )=0;
+
 	// --------------------------------------------------------------------------------------------Network Simulator Functions--------------------------------------------------------------------------------------------
 	/// Adds simulated ping and packet loss to the outgoing data flow.
 	/// To simulate bi-directional ping and packet loss, you should call this on both the sender and the recipient, with half the total ping and packetloss value on each.
@@ -0,0 +1,143 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: ArgumentsBenchmark.cpp
+// Project: Server.Benchmarks
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "Benchmark.h"
+#include <stdlib.h>
+#include <new>
+#include <Scripting/CScriptArguments.h>
+
+// Calls per measurement, both runs use the same digit count so the scripts compile the same way
+#define BENCHMARK_CALLS 100000
+
+// Every operator new in the process goes through here, the vms allocate with malloc and aren't counted
+static unsigned long g_ulAllocations = 0;
+
+void * operator new(size_t sSize)
+{
+	g_ulAllocations++;
+
+	void * pMemory = malloc(sSize ? sSize : 1);
+
+	if(!pMemory)
+		throw std::bad_alloc();
+
+	return pMemory;
+}
+
+void * operator new[](size_t sSize)
+{
+	return operator new(sSize);
+}
+
+void operator delete(void * pMemory) throw()
+{
+	free(pMemory);
+}
+
+void operator delete[](void * pMemory) throw()
+{
+	free(pMemory);
+}
+
+// getVector(), returns a vector the way the entity natives did before the binding layer
+static int GetVector(int * VM)
+{
+	CScriptArguments args;
+	args.pushVector3(CVector3(1.0f, 2.0f, 3.0f));
+	g_pVM->PushArray(args);
+	return 1;
+}
+
+// getFloat()
+static int GetFloat(int * VM)
+{
+	g_pVM->Push(1.5f);
+	return 1;
+}
+
+// getInteger()
+static int GetInteger(int * VM)
+{
+	g_pVM->Push(42);
+	return 1;
+}
+
+// getString(), pushed as a const char * without creating a CString
+static int GetString(int * VM)
+{
+	g_pVM->Push("benchmark");
+	return 1;
+}
+
+static const struct
+{
+	const char * szName;
+	CScriptVM::scriptFunction pfnFunction;
+} g_natives[] = {
+	{ "getVector", GetVector },
+	{ "getFloat", GetFloat },
+	{ "getInteger", GetInteger },
+	{ "getString", GetString },
+};
+
+// Returns the operator new calls per native call, or -1 if the script failed
+static double Measure(CScriptVM * pVM, const char * szNative)
+{
+	// Run it twice and only count the difference, this leaves out compiling the loop
+	unsigned long ulStart = g_ulAllocations;
+
+	if(!CallNative(pVM, szNative, "", BENCHMARK_CALLS))
+		return -1;
+
+	unsigned long ulSingle = (g_ulAllocations - ulStart);
+	ulStart = g_ulAllocations;
+
+	if(!CallNative(pVM, szNative, "", (BENCHMARK_CALLS * 2)))
+		return -1;
+
+	unsigned long ulDouble = (g_ulAllocations - ulStart);
+	return ((double)(ulDouble - ulSingle) / BENCHMARK_CALLS);
+}
+
+int main(int argc, char ** argv)
+{
+	CScriptVM * pVMs[] = { new CLuaVM(NULL), new CSquirrelVM(NULL) };
+	const char * szVMNames[] = { "Lua", "Squirrel" };
+	bool bAllocated = false;
+
+	printf("%-10s %-14s %s\n", "VM", "Native", "Allocations per call");
+
+	for(int i = 0; i < 2; i++)
+	{
+		for(int j = 0; j < (sizeof(g_natives) / sizeof(g_natives[0])); j++)
+			pVMs[i]->RegisterFunction(g_natives[j].szName, g_natives[j].pfnFunction);
+
+		for(int j = 0; j < (sizeof(g_natives) / sizeof(g_natives[0])); j++)
+		{
+			double dAllocations = Measure(pVMs[i], g_natives[j].szName);
+
+			if(dAllocations < 0)
+			{
+				printf("%-10s %-14s failed\n", szVMNames[i], g_natives[j].szName);
+				bAllocated = true;
+				continue;
+			}
+
+			printf("%-10s %-14s %.2f\n", szVMNames[i], g_natives[j].szName, dAllocations);
+
+			if(dAllocations > 0)
+				bAllocated = true;
+		}
+
+		delete pVMs[i];
+	}
+
+	// Fail if anything allocated, so the benchmark can be used as a check as well
+	return (bAllocated ? 1 : 0);
+}
@@ -0,0 +1,64 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: Benchmark.h
+// Project: Server.Benchmarks
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include <stdio.h>
+#include <Common.h>
+#include <Scripting/CLuaVM.h>
+#include <Scripting/CSquirrelVM.h>
+
+// The natives of the benchmarks use this instead of GET_SCRIPT_VM_SAFE, there is no resource manager
+static CScriptVM * g_pVM = NULL;
+
+// Runs a chunk of lua code on the vm, returns false if it failed
+static bool RunLua(CLuaVM * pVM, const char * szSource)
+{
+	lua_State * pState = pVM->GetVM();
+
+	if(luaL_dostring(pState, szSource) != 0)
+	{
+		printf("Lua error: %s\n", lua_tostring(pState, -1));
+		lua_pop(pState, 1);
+		return false;
+	}
+
+	return true;
+}
+
+// Runs a chunk of squirrel code on the vm, returns false if it failed
+static bool RunSquirrel(CSquirrelVM * pVM, const char * szSource)
+{
+	SQVM * pState = pVM->GetVM();
+
+	if(SQ_FAILED(sq_compilebuffer(pState, szSource, (SQInteger)strlen(szSource), "benchmark", SQTrue)))
+		return false;
+
+	// Call it with the root table as this
+	sq_pushroottable(pState);
+	bool bSucceeded = SQ_SUCCEEDED(sq_call(pState, 1, SQFalse, SQTrue));
+
+	// Pop the closure
+	sq_pop(pState, 1);
+	return bSucceeded;
+}
+
+// Calls a native iCalls times from a script loop, szArguments is pasted into the call as is
+static bool CallNative(CScriptVM * pVM, const char * szNative, const char * szArguments, int iCalls)
+{
+	g_pVM = pVM;
+
+	if(pVM->GetVMType() == LUA_VM)
+		return RunLua((CLuaVM *)pVM, CString("for i = 1, %d do %s(%s) end", iCalls, szNative, szArguments).Get());
+
+	return RunSquirrel((CSquirrelVM *)pVM, CString("for(local i = 0; i < %d; i++) %s(%s);", iCalls, szNative, szArguments).Get());
+}
+
+#endif // Benchmark_h
@@ -0,0 +1,127 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: BindingBenchmark.cpp
+// Project: Server.Benchmarks
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "Benchmark.h"
+#include <math.h>
+#include <limits.h>
+#include <SharedUtility.h>
+#include <Scripting/CScriptArguments.h>
+#include <Scripting/CScriptBinding.h>
+
+// Calls per round, the fastest of all rounds is reported
+#define BENCHMARK_CALLS 1000000
+#define BENCHMARK_ROUNDS 5
+
+static float GetDistance(float x, float y, float xx, float yy)
+{
+	return sqrt(((xx - x) * (xx - x)) + ((yy - y) * (yy - y)));
+}
+
+static CVector3 GetOffset(const CVector3& vecPosition)
+{
+	return CVector3(vecPosition.fX + 1.0f, vecPosition.fY + 1.0f, vecPosition.fZ + 1.0f);
+}
+
+// getDistance(x, y, xx, yy) through the virtual Pop/Push calls
+static int GetDistanceNative(int * VM)
+{
+	float x, y, xx, yy;
+	g_pVM->Pop(x);
+	g_pVM->Pop(y);
+	g_pVM->Pop(xx);
+	g_pVM->Pop(yy);
+	g_pVM->ResetStackIndex();
+
+	g_pVM->Push(GetDistance(x, y, xx, yy));
+	return 1;
+}
+
+// getOffset(x, y, z) through the virtual Pop/Push calls
+static int GetOffsetNative(int * VM)
+{
+	CVector3 vecPosition;
+	g_pVM->Pop(vecPosition);
+	g_pVM->ResetStackIndex();
+
+	CScriptArguments args;
+	args.pushVector3(GetOffset(vecPosition));
+	g_pVM->PushArray(args);
+	return 1;
+}
+
+static const struct
+{
+	const char * szName;
+	const char * szArguments;
+} g_natives[] = {
+	{ "getDistance", "1.0, 2.0, 3.0, 4.0" },
+	{ "getOffset", "1.0, 2.0, 3.0" },
+};
+
+// Returns the calls per second of the fastest round, or -1 if the script failed
+static double Measure(CScriptVM * pVM, const char * szNative, const char * szArguments)
+{
+	unsigned long ulBestTime = ULONG_MAX;
+
+	for(int i = 0; i < BENCHMARK_ROUNDS; i++)
+	{
+		unsigned long ulStartTime = SharedUtility::GetTime();
+
+		if(!CallNative(pVM, szNative, szArguments, BENCHMARK_CALLS))
+			return -1;
+
+		unsigned long ulTime = (SharedUtility::GetTime() - ulStartTime);
+
+		if(ulTime < ulBestTime)
+			ulBestTime = ulTime;
+	}
+
+	return ((double)BENCHMARK_CALLS * 1000 / (ulBestTime ? ulBestTime : 1));
+}
+
+int main(int argc, char ** argv)
+{
+	const char * szVMNames[] = { "Lua", "Squirrel" };
+	bool bFailed = false;
+
+	printf("%-10s %-14s %16s %16s %8s\n", "VM", "Native", "Pop/Push", "BIND_NATIVE", "Speedup");
+
+	for(int i = 0; i < 2; i++)
+	{
+		// One vm per path, both register the natives under the same names
+		CScriptVM * pVirtualVM = (i == 0 ? (CScriptVM *)new CLuaVM(NULL) : (CScriptVM *)new CSquirrelVM(NULL));
+		CScriptVM * pBoundVM = (i == 0 ? (CScriptVM *)new CLuaVM(NULL) : (CScriptVM *)new CSquirrelVM(NULL));
+
+		pVirtualVM->RegisterFunction("getDistance", GetDistanceNative);
+		pVirtualVM->RegisterFunction("getOffset", GetOffsetNative);
+
+		pBoundVM->RegisterFunction("getDistance", BIND_NATIVE(pBoundVM, GetDistance));
+		pBoundVM->RegisterFunction("getOffset", BIND_NATIVE(pBoundVM, GetOffset));
+
+		for(int j = 0; j < (sizeof(g_natives) / sizeof(g_natives[0])); j++)
+		{
+			double dVirtual = Measure(pVirtualVM, g_natives[j].szName, g_natives[j].szArguments);
+			double dBound = Measure(pBoundVM, g_natives[j].szName, g_natives[j].szArguments);
+
+			if(dVirtual < 0 || dBound < 0)
+			{
+				printf("%-10s %-14s failed\n", szVMNames[i], g_natives[j].szName);
+				bFailed = true;
+				continue;
+			}
+
+			printf("%-10s %-14s %16.0f %16.0f %7.2fx\n", szVMNames[i], g_natives[j].szName, dVirtual, dBound, (dBound / dVirtual));
+		}
+
+		delete pVirtualVM;
+		delete pBoundVM;
+	}
+
+	return (bFailed ? 1 : 0);
+}
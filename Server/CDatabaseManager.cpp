@@ -0,0 +1,326 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CDatabaseManager.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CDatabaseManager.h"
+#include <Scripting/CEventHandler.h>
+#include <Scripting/ResourceSystem/CResource.h>
+#include <Scripting/CScriptProfiler.h>
+#include <RakNet/RakSleep.h>
+
+CDatabaseManager * CDatabaseManager::s_pInstance = NULL;
+
+CDatabaseManager::CDatabaseManager()
+{
+	s_pInstance = this;
+
+	m_pExecuting = NULL;
+	m_bStopping = false;
+
+	m_thread.SetUserData(this);
+	m_thread.Start(WorkerThread);
+}
+
+CDatabaseManager::~CDatabaseManager()
+{
+	// Let the worker finish the current request and exit
+	m_mutex.Lock();
+	m_bStopping = true;
+	m_mutex.Unlock();
+
+	while(m_thread.IsRunning())
+		RakSleep(1);
+
+	for(auto pRequest : m_requests)
+		Free(pRequest);
+
+	for(auto pRequest : m_completed)
+		Free(pRequest);
+
+	for(auto pConnection : m_connections)
+		SAFE_DELETE(pConnection);
+
+	s_pInstance = NULL;
+}
+
+void CDatabaseManager::WorkerThread(CThread * pThread)
+{
+	CDatabaseManager * pManager = pThread->GetUserData<CDatabaseManager *>();
+
+	while(true)
+	{
+		// Take the next request
+		pManager->m_mutex.Lock();
+
+		if(pManager->m_bStopping)
+		{
+			pManager->m_mutex.Unlock();
+			break;
+		}
+
+		Request * pRequest = NULL;
+
+		if(!pManager->m_requests.empty())
+		{
+			pRequest = pManager->m_requests.front();
+			pManager->m_requests.pop_front();
+		}
+
+		pManager->m_pExecuting = pRequest;
+		pManager->m_mutex.Unlock();
+
+		if(!pRequest)
+		{
+			RakSleep(DATABASE_WORKER_IDLE_TIME);
+			continue;
+		}
+
+		pManager->Execute(pRequest);
+
+		// Hand it back to the main thread
+		pManager->m_mutex.Lock();
+		pManager->m_pExecuting = NULL;
+		pManager->m_completed.push_back(pRequest);
+		pManager->m_mutex.Unlock();
+	}
+}
+
+void CDatabaseManager::Execute(Request * pRequest)
+{
+	if(pRequest->databaseId >= (DatabaseId)m_connections.size())
+		m_connections.resize(pRequest->databaseId + 1, NULL);
+
+	CSQLite *& pConnection = m_connections[pRequest->databaseId];
+
+	switch(pRequest->type)
+	{
+	case REQUEST_OPEN:
+		{
+			pConnection = new CSQLite();
+			pRequest->bSuccess = pConnection->Open(pRequest->strQuery.Get(), pRequest->strError);
+		}
+		break;
+	case REQUEST_QUERY:
+		{
+			if(pConnection)
+				pRequest->bSuccess = pConnection->Query(pRequest->strQuery.Get(), pRequest->parameters, pRequest->result, pRequest->strError);
+			else
+				pRequest->strError = "database is not open";
+		}
+		break;
+	case REQUEST_CLOSE:
+		{
+			SAFE_DELETE(pConnection);
+			pRequest->bSuccess = true;
+		}
+		break;
+	}
+}
+
+void CDatabaseManager::Queue(Request * pRequest)
+{
+	pRequest->bSuccess = false;
+
+	m_mutex.Lock();
+	m_requests.push_back(pRequest);
+	m_mutex.Unlock();
+}
+
+void CDatabaseManager::FreeHandler(Request * pRequest)
+{
+	if(!pRequest->pHandler)
+		return;
+
+	// Release the function reference, this has to happen while the vm is still alive
+	CScriptVM * pVM = pRequest->pHandler->GetVM();
+
+	if(pVM && pVM->GetVMType() == LUA_VM && pRequest->pHandler->GetRef() != -1)
+		luaL_unref(((CLuaVM*)pVM)->GetVM(), LUA_REGISTRYINDEX, pRequest->pHandler->GetRef());
+
+	SAFE_DELETE(pRequest->pHandler);
+}
+
+void CDatabaseManager::Free(Request * pRequest)
+{
+	FreeHandler(pRequest);
+	delete pRequest;
+}
+
+DatabaseId CDatabaseManager::Open(CResource * pResource, const CString& strFileName)
+{
+	DatabaseId databaseId = (DatabaseId)m_owners.size();
+	m_owners.push_back(pResource);
+
+	Request * pRequest = new Request();
+	pRequest->type = REQUEST_OPEN;
+	pRequest->databaseId = databaseId;
+	pRequest->pResource = pResource;
+	pRequest->pHandler = NULL;
+	pRequest->strQuery = strFileName;
+	Queue(pRequest);
+
+	return databaseId;
+}
+
+bool CDatabaseManager::Close(CResource * pResource, DatabaseId databaseId)
+{
+	// Is it a database of this resource?
+	if(databaseId < 0 || databaseId >= (DatabaseId)m_owners.size() || m_owners[databaseId] != pResource)
+		return false;
+
+	m_owners[databaseId] = NULL;
+
+	Request * pRequest = new Request();
+	pRequest->type = REQUEST_CLOSE;
+	pRequest->databaseId = databaseId;
+	pRequest->pResource = pResource;
+	pRequest->pHandler = NULL;
+	Queue(pRequest);
+
+	return true;
+}
+
+bool CDatabaseManager::Query(CResource * pResource, DatabaseId databaseId, CEventHandler * pHandler, const CString& strQuery, const CScriptArguments& parameters)
+{
+	// Is it a database of this resource?
+	if(databaseId < 0 || databaseId >= (DatabaseId)m_owners.size() || m_owners[databaseId] != pResource)
+	{
+		SAFE_DELETE(pHandler);
+		return false;
+	}
+
+	Request * pRequest = new Request();
+	pRequest->type = REQUEST_QUERY;
+	pRequest->databaseId = databaseId;
+	pRequest->pResource = pResource;
+	pRequest->pHandler = pHandler;
+	pRequest->strQuery = strQuery;
+	pRequest->parameters = parameters;
+	Queue(pRequest);
+
+	return true;
+}
+
+void CDatabaseManager::RemoveResource(CResource * pResource)
+{
+	// Free the callbacks now, the vm of the resource is about to go away.
+	// The worker never touches the handlers, so this is fine for the executing request too
+	m_mutex.Lock();
+
+	for(auto pRequest : m_requests)
+	{
+		if(pRequest->pResource == pResource)
+		{
+			FreeHandler(pRequest);
+			pRequest->pResource = NULL;
+		}
+	}
+
+	for(auto pRequest : m_completed)
+	{
+		if(pRequest->pResource == pResource)
+		{
+			FreeHandler(pRequest);
+			pRequest->pResource = NULL;
+		}
+	}
+
+	if(m_pExecuting && m_pExecuting->pResource == pResource)
+	{
+		FreeHandler(m_pExecuting);
+		m_pExecuting->pResource = NULL;
+	}
+
+	m_mutex.Unlock();
+
+	// Close its databases after the queued requests
+	for(size_t i = 0; i < m_owners.size(); i++)
+	{
+		if(m_owners[i] == pResource)
+			Close(pResource, (DatabaseId)i);
+	}
+}
+
+void CDatabaseManager::Process()
+{
+	// Take all finished requests at once so the worker isn't blocked by the callbacks
+	std::deque<Request *> completed;
+
+	m_mutex.Lock();
+	completed.swap(m_completed);
+	m_mutex.Unlock();
+
+	for(auto pRequest : completed)
+	{
+		if(pRequest->type == REQUEST_OPEN && !pRequest->bSuccess)
+			CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "Failed to open database %s: %s", pRequest->strQuery.Get(), pRequest->strError.Get());
+
+		if(pRequest->pResource && pRequest->pHandler)
+		{
+			CScriptArguments arguments;
+
+			if(pRequest->bSuccess)
+			{
+				const CSQLResult& result = pRequest->result;
+
+				// Rows as an array of tables, NULL columns are left out.
+				// Everything is filled in place to avoid copying the nested arguments
+				CScriptArguments empty;
+				arguments.push(empty, true);
+				CScriptArguments * pRows = arguments[0].GetArray();
+
+				for(unsigned int uiRow = 0; uiRow < result.GetRowCount(); uiRow++)
+				{
+					pRows->push(empty, false);
+					CScriptArguments * pRow = (*pRows)[uiRow].GetTable();
+
+					for(unsigned int uiColumn = 0; uiColumn < result.GetColumnCount(); uiColumn++)
+					{
+						switch(result.GetType(uiColumn, uiRow))
+						{
+						case CSQLResult::SQL_INTEGER:
+							pRow->push(result.GetColumnName(uiColumn));
+							pRow->push((int)result.GetInteger(uiColumn, uiRow));
+							break;
+						case CSQLResult::SQL_FLOAT:
+							pRow->push(result.GetColumnName(uiColumn));
+							pRow->push((float)result.GetFloat(uiColumn, uiRow));
+							break;
+						case CSQLResult::SQL_TEXT:
+							pRow->push(result.GetColumnName(uiColumn));
+							pRow->push(result.GetText(uiColumn, uiRow));
+							break;
+						default:
+							break;
+						}
+					}
+				}
+
+				// Followed by the number of changed rows and the rowid of the last insert
+				arguments.push(result.GetChanges());
+				arguments.push((int)result.GetLastInsertId());
+			}
+			else
+			{
+				arguments.push(false);
+				arguments.push(pRequest->strError);
+			}
+
+			size_t sDepth = CScriptProfiler::EnterHandler(pRequest->pResource, "database");
+			pRequest->pHandler->Call(&arguments);
+			CScriptProfiler::LeaveHandler(sDepth);
+		}
+		else if(pRequest->type == REQUEST_QUERY && !pRequest->bSuccess && pRequest->pResource)
+		{
+			// Nobody waits for the result, don't lose the error
+			CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "Database query failed: %s", pRequest->strError.Get());
+		}
+
+		Free(pRequest);
+	}
+}
@@ -0,0 +1,101 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CDatabaseManager.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CDatabaseManager_h
+#define CDatabaseManager_h
+
+#include <Common.h>
+#include <deque>
+#include <vector>
+#include <Threading/CThread.h>
+#include <Scripting/CScriptArguments.h>
+#include <Scripting/CSQLDatabase.h/CSQLite.h>
+
+class CResource;
+class CEventHandler;
+
+// How long the worker sleeps when there is nothing to do (ms)
+#define DATABASE_WORKER_IDLE_TIME		1
+
+typedef int DatabaseId;
+
+#define INVALID_DATABASE_ID				-1
+
+// Runs all database access of the scripts on one worker thread,
+// the callbacks are called on the main thread by Process
+class CDatabaseManager {
+
+private:
+	enum eRequestType
+	{
+		REQUEST_OPEN,
+		REQUEST_QUERY,
+		REQUEST_CLOSE,
+	};
+
+	struct Request
+	{
+		eRequestType		type;
+		DatabaseId			databaseId;
+		CResource			* pResource;	// NULL once the resource is gone
+		CEventHandler		* pHandler;		// Freed together with the resource, it holds a function of its vm
+		CString				strQuery;		// The file name for REQUEST_OPEN
+		CScriptArguments	parameters;
+
+		// Filled by the worker
+		bool				bSuccess;
+		CString				strError;
+		CSQLResult			result;
+	};
+
+	static CDatabaseManager	* s_pInstance;
+
+	CThread					m_thread;
+
+	// Shared with the worker
+	CMutex					m_mutex;
+	std::deque<Request *>	m_requests;
+	std::deque<Request *>	m_completed;
+	Request					* m_pExecuting;
+	bool					m_bStopping;
+
+	// Only touched by the worker (or the destructor once it stopped)
+	std::vector<CSQLite *>	m_connections;
+
+	// Only touched by the main thread, the owner of every id ever opened
+	std::vector<CResource *>	m_owners;
+
+	static void				WorkerThread(CThread * pThread);
+	void					Execute(Request * pRequest);
+
+	void					Queue(Request * pRequest);
+	void					FreeHandler(Request * pRequest);
+	void					Free(Request * pRequest);
+
+public:
+	CDatabaseManager();
+	~CDatabaseManager();
+
+	static CDatabaseManager	*GetInstance() { return s_pInstance; }
+
+	// Opens the file on the worker, failures show up in the query callbacks
+	DatabaseId				Open(CResource * pResource, const CString& strFileName);
+	bool					Close(CResource * pResource, DatabaseId databaseId);
+
+	// Takes ownership of the handler, which may be NULL if the result isn't needed
+	bool					Query(CResource * pResource, DatabaseId databaseId, CEventHandler * pHandler, const CString& strQuery, const CScriptArguments& parameters);
+
+	// Closes every database of a resource and drops its pending callbacks
+	void					RemoveResource(CResource * pResource);
+
+	// Calls the handlers of the finished queries
+	void					Process();
+};
+
+#endif // CDatabaseManager_h
@@ -0,0 +1,930 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CHttpServer.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CHttpServer.h"
+#include <CLogFile.h>
+#include <CSettings.h>
+#include <CZlib.h>
+#include <CRC.h>
+#include <SharedUtility.h>
+#include <RakNet/RakSleep.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define poll					WSAPoll
+#define CLOSE_SOCKET			closesocket
+#define INVALID_HTTP_SOCKET		INVALID_SOCKET
+#define SOCKET_WOULD_BLOCK		(WSAGetLastError() == WSAEWOULDBLOCK)
+#define SEND_FLAGS				0
+#define strcasecmp				_stricmp
+#define strncasecmp				_strnicmp
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <strings.h>
+#define CLOSE_SOCKET			close
+#define INVALID_HTTP_SOCKET		-1
+#define SOCKET_WOULD_BLOCK		(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+#define SEND_FLAGS				MSG_NOSIGNAL
+#endif
+
+struct ContentType
+{
+	const char		* szExtension;
+	const char		* szContentType;
+	bool			bCompress;		// Already compressed formats don't get smaller
+};
+
+static const ContentType g_contentTypes[] =
+{
+	{ ".lua", "text/plain", true },
+	{ ".nut", "text/plain", true },
+	{ ".sq", "text/plain", true },
+	{ ".txt", "text/plain", true },
+	{ ".xml", "text/xml", true },
+	{ ".html", "text/html", true },
+	{ ".htm", "text/html", true },
+	{ ".css", "text/css", true },
+	{ ".js", "application/javascript", true },
+	{ ".json", "application/json", true },
+	{ ".bmp", "image/bmp", true },
+	{ ".dds", "image/vnd-ms.dds", true },
+	{ ".png", "image/png", false },
+	{ ".jpg", "image/jpeg", false },
+	{ ".jpeg", "image/jpeg", false },
+	{ ".gif", "image/gif", false },
+	{ ".wav", "audio/wav", true },
+	{ ".mp3", "audio/mpeg", false },
+	{ ".ogg", "audio/ogg", false },
+};
+
+static const ContentType * GetContentType(CString strName)
+{
+	strName.ToLower();
+
+	for(size_t i = 0; i < (sizeof(g_contentTypes) / sizeof(ContentType)); i++)
+	{
+		if(strName.EndsWith(g_contentTypes[i].szExtension))
+			return &g_contentTypes[i];
+	}
+
+	return NULL;
+}
+
+static void SetNonBlocking(HttpSocket socket)
+{
+#ifdef _WIN32
+	u_long ulNonBlocking = 1;
+	ioctlsocket(socket, FIONBIO, &ulNonBlocking);
+#else
+	fcntl(socket, F_SETFL, (fcntl(socket, F_GETFL, 0) | O_NONBLOCK));
+#endif
+}
+
+// Decodes %xx escapes, returns false for malformed or NUL escapes
+static bool DecodeUrl(const std::string& strUrl, std::string& strDecoded)
+{
+	strDecoded.clear();
+
+	for(size_t i = 0; i < strUrl.size(); i++)
+	{
+		if(strUrl[i] != '%')
+		{
+			strDecoded += strUrl[i];
+			continue;
+		}
+
+		if((i + 2) >= strUrl.size() || !isxdigit((unsigned char)strUrl[i + 1]) || !isxdigit((unsigned char)strUrl[i + 2]))
+			return false;
+
+		char c = (char)strtol(strUrl.substr((i + 1), 2).c_str(), NULL, 16);
+
+		if(c == '\0')
+			return false;
+
+		strDecoded += c;
+		i += 2;
+	}
+
+	return true;
+}
+
+// Checks if a header value lists the given token (e.g. "gzip" in "gzip, deflate"), tokens with q=0 don't count
+static bool HasToken(const std::string& strValue, const char * szToken)
+{
+	size_t sTokenLength = strlen(szToken);
+	size_t sPos = 0;
+
+	while(sPos < strValue.size())
+	{
+		size_t sEnd = strValue.find(',', sPos);
+
+		if(sEnd == std::string::npos)
+			sEnd = strValue.size();
+
+		// Trim the leading spaces
+		while(sPos < sEnd && isspace((unsigned char)strValue[sPos]))
+			sPos++;
+
+		if((sEnd - sPos) >= sTokenLength && !strncasecmp(strValue.c_str() + sPos, szToken, sTokenLength))
+		{
+			std::string strRest = strValue.substr((sPos + sTokenLength), (sEnd - sPos - sTokenLength));
+			size_t sQuality = strRest.find("q=");
+
+			if(strRest.empty() || isspace((unsigned char)strRest[0]) || strRest[0] == ';')
+				return (sQuality == std::string::npos || atof(strRest.c_str() + sQuality + 2) > 0.0);
+		}
+
+		sPos = (sEnd + 1);
+	}
+
+	return false;
+}
+
+// Parses a single "bytes=first-last" range, returns false if the header has to be ignored (other units, several ranges).
+// Resumed downloads send "bytes=first-", the last byte is inclusive
+static bool ParseRange(const std::string& strValue, long long llSize, long long& llFirst, long long& llLast, bool& bSatisfiable)
+{
+	if(strncasecmp(strValue.c_str(), "bytes=", 6) || strValue.find(',') != std::string::npos)
+		return false;
+
+	std::string strRange = strValue.substr(6);
+	size_t sDash = strRange.find('-');
+
+	if(sDash == std::string::npos)
+		return false;
+
+	std::string strFirst = strRange.substr(0, sDash);
+	std::string strLast = strRange.substr(sDash + 1);
+
+	if(strspn(strFirst.c_str(), "0123456789") != strFirst.size() || strspn(strLast.c_str(), "0123456789") != strLast.size() || (strFirst.empty() && strLast.empty()))
+		return false;
+
+	if(strFirst.empty())
+	{
+		// The last n bytes
+		long long llSuffix = atoll(strLast.c_str());
+		llFirst = ((llSuffix < llSize) ? (llSize - llSuffix) : 0);
+		llLast = (llSize - 1);
+		bSatisfiable = (llSuffix > 0 && llSize > 0);
+		return true;
+	}
+
+	llFirst = atoll(strFirst.c_str());
+	llLast = (strLast.empty() ? llFirst : atoll(strLast.c_str()));
+
+	// Invalid ranges get ignored, ranges past the end are unsatisfiable
+	if(llLast < llFirst)
+		return false;
+
+	if(strLast.empty() || llLast >= llSize)
+		llLast = (llSize - 1);
+
+	bSatisfiable = (llFirst < llSize);
+	return true;
+}
+
+CHttpServer * CHttpServer::s_pInstance = NULL;
+
+CHttpServer::CHttpServer()
+{
+	s_pInstance = this;
+
+	m_bRunning = false;
+	m_bStopping = false;
+	m_uiBandwidth = 0;
+	m_listenSocket = INVALID_HTTP_SOCKET;
+	m_buffer.resize(HTTP_SEND_CHUNK_SIZE);
+}
+
+CHttpServer::~CHttpServer()
+{
+	Stop();
+
+	s_pInstance = NULL;
+}
+
+bool CHttpServer::Start(unsigned short usPort, const CString& strHostAddress)
+{
+	if(m_bRunning)
+		return false;
+
+#ifndef _WIN32
+	// sendfile raises SIGPIPE if a client goes away in the middle of a transfer
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	// Create the listen socket
+	m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if(m_listenSocket == INVALID_HTTP_SOCKET)
+	{
+		CLogFile::Printf("Failed to create the HTTP server socket.");
+		return false;
+	}
+
+	// Don't fail to bind because of connections of the last run which are still in TIME_WAIT
+	int iReuseAddress = 1;
+	setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char *)&iReuseAddress, sizeof(iReuseAddress));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(usPort);
+	address.sin_addr.s_addr = (strHostAddress.IsEmpty() ? htonl(INADDR_ANY) : inet_addr(strHostAddress.Get()));
+
+	if(bind(m_listenSocket, (sockaddr *)&address, sizeof(address)) != 0 || listen(m_listenSocket, SOMAXCONN) != 0)
+	{
+		CLogFile::Printf("Failed to bind the HTTP server to port %d.", usPort);
+		CLOSE_SOCKET(m_listenSocket);
+		m_listenSocket = INVALID_HTTP_SOCKET;
+		return false;
+	}
+
+	SetNonBlocking(m_listenSocket);
+
+	// Get the bandwidth limit and follow changes of it
+	BandwidthChanged("httpbandwidth", this);
+	CSettings::AddChangeHandler("httpbandwidth", BandwidthChanged, this);
+
+	// Start the worker
+	m_bStopping = false;
+	m_bRunning = true;
+	m_thread.SetUserData(this);
+	m_thread.Start(WorkerThread);
+	return true;
+}
+
+void CHttpServer::Stop()
+{
+	if(!m_bRunning)
+		return;
+
+	CSettings::RemoveChangeHandler("httpbandwidth", BandwidthChanged, this);
+
+	// Let the worker exit
+	m_bStopping = true;
+
+	while(m_thread.IsRunning())
+		RakSleep(1);
+
+	// Close all connections
+	for(auto pConnection : m_connections)
+		Close(pConnection);
+
+	m_connections.clear();
+
+	CLOSE_SOCKET(m_listenSocket);
+	m_listenSocket = INVALID_HTTP_SOCKET;
+
+	m_files.clear();
+	m_changes.clear();
+	m_bRunning = false;
+}
+
+void CHttpServer::BandwidthChanged(const CString& strSetting, void * pUserData)
+{
+	// The setting is in KiB/s
+	((CHttpServer *)pUserData)->m_uiBandwidth = (CVAR_GET_INTEGER(strSetting) * 1024);
+}
+
+void CHttpServer::AddFile(const CString& strResource, const CString& strName, const CString& strPath)
+{
+	if(!m_bRunning)
+		return;
+
+	FileChange change;
+	change.type = FILE_CHANGE_ADD;
+	change.strUrl.Format("%s/%s", strResource.Get(), strName.Get());
+	change.strPath = strPath;
+
+	m_mutex.Lock();
+	m_changes.push_back(change);
+	m_mutex.Unlock();
+}
+
+void CHttpServer::RemoveFile(const CString& strResource, const CString& strName)
+{
+	if(!m_bRunning)
+		return;
+
+	FileChange change;
+	change.type = FILE_CHANGE_REMOVE;
+	change.strUrl.Format("%s/%s", strResource.Get(), strName.Get());
+
+	m_mutex.Lock();
+	m_changes.push_back(change);
+	m_mutex.Unlock();
+}
+
+void CHttpServer::RemoveResource(const CString& strResource)
+{
+	if(!m_bRunning)
+		return;
+
+	FileChange change;
+	change.type = FILE_CHANGE_REMOVE_RESOURCE;
+	change.strUrl.Format("%s/", strResource.Get());
+
+	m_mutex.Lock();
+	m_changes.push_back(change);
+	m_mutex.Unlock();
+}
+
+void CHttpServer::ApplyChanges()
+{
+	std::vector<FileChange> changes;
+
+	m_mutex.Lock();
+	changes.swap(m_changes);
+	m_mutex.Unlock();
+
+	for(auto& change : changes)
+	{
+		switch(change.type)
+		{
+		case FILE_CHANGE_ADD:
+			{
+				const ContentType * pContentType = GetContentType(change.strUrl);
+
+				std::shared_ptr<File> pFile = std::make_shared<File>();
+				pFile->strPath = change.strPath;
+				pFile->szContentType = (pContentType ? pContentType->szContentType : "application/octet-stream");
+				pFile->bPrepared = false;
+				m_files[change.strUrl] = pFile;
+			}
+			break;
+		case FILE_CHANGE_REMOVE:
+			{
+				m_files.erase(change.strUrl);
+			}
+			break;
+		case FILE_CHANGE_REMOVE_RESOURCE:
+			{
+				// All urls of the resource share the "<resource>/" prefix and are next to each other in the map
+				auto iter = m_files.lower_bound(change.strUrl);
+
+				while(iter != m_files.end() && !strncmp(iter->first.Get(), change.strUrl.Get(), change.strUrl.GetLength()))
+					iter = m_files.erase(iter);
+			}
+			break;
+		}
+	}
+}
+
+// Makes sure the size and checksum describe pStream, the opened file the body will be sent from
+bool CHttpServer::Prepare(std::shared_ptr<File>& pFile, FILE * pStream)
+{
+	struct stat fileStat;
+
+	if(fstat(fileno(pStream), &fileStat) != 0 || (fileStat.st_mode & S_IFMT) != S_IFREG)
+		return false;
+
+	// Is the cached state still up to date?
+	if(pFile->bPrepared && pFile->llSize == (long long)fileStat.st_size && pFile->modificationTime == fileStat.st_mtime)
+		return true;
+
+	// Replace a changed file instead of updating it, running gzip transfers keep the old compressed data.
+	// Uncompressed transfers read from their own handle, which still is the old file if it got replaced
+	if(pFile->bPrepared)
+	{
+		std::shared_ptr<File> pNewFile = std::make_shared<File>();
+		pNewFile->strPath = pFile->strPath;
+		pNewFile->szContentType = pFile->szContentType;
+		pNewFile->bPrepared = false;
+		pFile = pNewFile;
+	}
+
+	const ContentType * pContentType = GetContentType(pFile->strPath);
+	bool bCompress = (pContentType && pContentType->bCompress && fileStat.st_size >= HTTP_GZIP_MIN_SIZE);
+
+	// Calculate the checksum, keep the data if we want to compress it
+	CChecksum checksum;
+	std::string strData;
+	size_t sRead;
+
+	while((sRead = fread(&m_buffer[0], 1, m_buffer.size(), pStream)) > 0)
+	{
+		checksum.Add((unsigned char *)&m_buffer[0], (unsigned int)sRead);
+
+		if(bCompress)
+			strData.append(&m_buffer[0], sRead);
+	}
+
+	// The body is sent from the same handle
+	rewind(pStream);
+
+	pFile->uiChecksum = checksum.GetChecksum();
+	pFile->llSize = (long long)fileStat.st_size;
+	pFile->modificationTime = fileStat.st_mtime;
+	pFile->strGzip.clear();
+
+	// Only keep the compressed version if it saves at least a tenth
+	if(bCompress && CZlib::Compress((const unsigned char *)strData.data(), (unsigned int)strData.size(), pFile->strGzip, true))
+	{
+		if(pFile->strGzip.size() > (strData.size() - (strData.size() / 10)))
+			pFile->strGzip.clear();
+	}
+
+	std::string(pFile->strGzip).swap(pFile->strGzip);
+	pFile->bPrepared = true;
+	return true;
+}
+
+void CHttpServer::WorkerThread(CThread * pThread)
+{
+	CHttpServer * pServer = pThread->GetUserData<CHttpServer *>();
+	std::vector<pollfd> pollDescriptors;
+
+	while(!pServer->m_bStopping)
+	{
+		pServer->ApplyChanges();
+
+		unsigned long ulTime = SharedUtility::GetTime();
+		unsigned int uiBandwidth = pServer->m_uiBandwidth;
+		bool bThrottled = false;
+
+		// Watch the listen socket and all connections
+		pollDescriptors.resize(pServer->m_connections.size() + 1);
+		pollDescriptors[0].fd = pServer->m_listenSocket;
+		pollDescriptors[0].events = POLLIN;
+		pollDescriptors[0].revents = 0;
+
+		for(size_t i = 0; i < pServer->m_connections.size(); i++)
+		{
+			Connection * pConnection = pServer->m_connections[i];
+
+			// Top up the bandwidth budget, bursts are limited to a tenth of a second
+			if(uiBandwidth > 0)
+			{
+				unsigned long ulElapsed = (ulTime - pConnection->ulLastRefill);
+
+				if((long)ulElapsed >= HTTP_THROTTLE_TIME)
+				{
+					pConnection->llAllowance += (((long long)uiBandwidth * ulElapsed) / 1000);
+
+					if(pConnection->llAllowance > (long long)(uiBandwidth / 10))
+						pConnection->llAllowance = (uiBandwidth / 10);
+
+					pConnection->ulLastRefill = ulTime;
+				}
+			}
+
+			pollDescriptors[i + 1].fd = pConnection->socket;
+			pollDescriptors[i + 1].revents = 0;
+
+			// Only read the next request once the current response is out
+			if(pConnection->strHeader.empty())
+			{
+				pollDescriptors[i + 1].events = POLLIN;
+			}
+			else if(uiBandwidth > 0 && pConnection->llAllowance <= 0 && pConnection->sHeaderSent == pConnection->strHeader.size())
+			{
+				pollDescriptors[i + 1].events = 0;
+				bThrottled = true;
+			}
+			else
+			{
+				pollDescriptors[i + 1].events = POLLOUT;
+			}
+		}
+
+		if(poll(&pollDescriptors[0], pollDescriptors.size(), (bThrottled ? HTTP_THROTTLE_TIME : HTTP_POLL_TIME)) < 0)
+		{
+			RakSleep(HTTP_THROTTLE_TIME);
+			continue;
+		}
+
+		ulTime = SharedUtility::GetTime();
+
+		// Handle the connections, the new ones get polled in the next round
+		size_t sConnections = pServer->m_connections.size();
+		size_t sKept = 0;
+
+		for(size_t i = 0; i < sConnections; i++)
+		{
+			Connection * pConnection = pServer->m_connections[i];
+			short sEvents = pollDescriptors[i + 1].revents;
+			bool bKeep = true;
+
+			if(sEvents & POLLIN)
+			{
+				bKeep = pServer->Receive(pConnection);
+
+				if(bKeep && pConnection->strHeader.empty())
+					pServer->HandleRequest(pConnection);
+			}
+			else if(sEvents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				bKeep = false;
+			}
+
+			// Sending doesn't block, so try it right away for new responses too
+			if(bKeep && !pConnection->strHeader.empty())
+				bKeep = pServer->Send(pConnection);
+
+			// Close idle connections and the ones which stopped reading
+			if(bKeep && (long)(ulTime - pConnection->ulLastActivity) > HTTP_IDLE_TIMEOUT)
+				bKeep = false;
+
+			if(bKeep)
+			{
+				pServer->m_connections[sKept++] = pConnection;
+			}
+			else
+			{
+				pServer->Close(pConnection);
+			}
+		}
+
+		// Move the connections which were accepted meanwhile up and drop the closed ones
+		pServer->m_connections.erase((pServer->m_connections.begin() + sKept), (pServer->m_connections.begin() + sConnections));
+
+		if(pollDescriptors[0].revents & POLLIN)
+			pServer->Accept();
+	}
+}
+
+void CHttpServer::Accept()
+{
+	while(true)
+	{
+		sockaddr_in address;
+		socklen_t addressLength = sizeof(address);
+		HttpSocket socket = accept(m_listenSocket, (sockaddr *)&address, &addressLength);
+
+		if(socket == INVALID_HTTP_SOCKET)
+			break;
+
+		if(m_connections.size() >= HTTP_MAX_CONNECTIONS)
+		{
+			CLOSE_SOCKET(socket);
+			continue;
+		}
+
+		SetNonBlocking(socket);
+
+		Connection * pConnection = new Connection();
+		pConnection->socket = socket;
+		pConnection->ulLastActivity = SharedUtility::GetTime();
+		pConnection->sHeaderSent = 0;
+		pConnection->bGzip = false;
+		pConnection->pBody = NULL;
+		pConnection->llBodyPosition = 0;
+		pConnection->llBodyEnd = 0;
+		pConnection->bKeepAlive = false;
+		pConnection->llAllowance = (m_uiBandwidth / 10);
+		pConnection->ulLastRefill = pConnection->ulLastActivity;
+		m_connections.push_back(pConnection);
+	}
+}
+
+bool CHttpServer::Receive(Connection * pConnection)
+{
+	int iReceived = recv(pConnection->socket, &m_buffer[0], (int)m_buffer.size(), 0);
+
+	// Did the client close the connection?
+	if(iReceived == 0)
+		return false;
+
+	if(iReceived < 0)
+		return SOCKET_WOULD_BLOCK;
+
+	pConnection->strRequest.append(&m_buffer[0], iReceived);
+	pConnection->ulLastActivity = SharedUtility::GetTime();
+	return true;
+}
+
+bool CHttpServer::Send(Connection * pConnection)
+{
+	// Send the header first
+	while(pConnection->sHeaderSent < pConnection->strHeader.size())
+	{
+		int iSent = send(pConnection->socket, (pConnection->strHeader.data() + pConnection->sHeaderSent), (int)(pConnection->strHeader.size() - pConnection->sHeaderSent), SEND_FLAGS);
+
+		if(iSent <= 0)
+			return (iSent < 0 && SOCKET_WOULD_BLOCK);
+
+		pConnection->sHeaderSent += iSent;
+		pConnection->ulLastActivity = SharedUtility::GetTime();
+	}
+
+	// Send the next part of the body
+	if(pConnection->llBodyPosition < pConnection->llBodyEnd)
+	{
+		unsigned int uiBandwidth = m_uiBandwidth;
+		long long llChunk = (pConnection->llBodyEnd - pConnection->llBodyPosition);
+
+		if(llChunk > HTTP_SEND_CHUNK_SIZE)
+			llChunk = HTTP_SEND_CHUNK_SIZE;
+
+		if(uiBandwidth > 0)
+		{
+			if(pConnection->llAllowance <= 0)
+				return true;
+
+			if(llChunk > pConnection->llAllowance)
+				llChunk = pConnection->llAllowance;
+		}
+
+		long long llSent;
+
+		if(pConnection->bGzip)
+		{
+			llSent = send(pConnection->socket, (pConnection->pFile->strGzip.data() + pConnection->llBodyPosition), (int)llChunk, SEND_FLAGS);
+		}
+		else
+		{
+#ifdef _WIN32
+			_fseeki64(pConnection->pBody, pConnection->llBodyPosition, SEEK_SET);
+			size_t sRead = fread(&m_buffer[0], 1, (size_t)llChunk, pConnection->pBody);
+
+			// Did the file get shorter?
+			if(sRead == 0)
+				return false;
+
+			llSent = send(pConnection->socket, &m_buffer[0], (int)sRead, SEND_FLAGS);
+#else
+			// Let the kernel copy the file to the socket
+			off_t offset = (off_t)pConnection->llBodyPosition;
+			llSent = sendfile(pConnection->socket, fileno(pConnection->pBody), &offset, (size_t)llChunk);
+
+			// Did the file get shorter?
+			if(llSent == 0)
+				return false;
+#endif
+		}
+
+		if(llSent < 0)
+			return SOCKET_WOULD_BLOCK;
+
+		pConnection->llBodyPosition += llSent;
+		pConnection->llAllowance -= llSent;
+		pConnection->ulLastActivity = SharedUtility::GetTime();
+
+		if(pConnection->llBodyPosition < pConnection->llBodyEnd)
+			return true;
+	}
+
+	// The response is out
+	if(pConnection->pBody)
+	{
+		fclose(pConnection->pBody);
+		pConnection->pBody = NULL;
+	}
+
+	pConnection->pFile.reset();
+	pConnection->strHeader.clear();
+	pConnection->sHeaderSent = 0;
+	pConnection->llBodyPosition = 0;
+	pConnection->llBodyEnd = 0;
+
+	if(!pConnection->bKeepAlive)
+		return false;
+
+	// The client might have sent the next request already
+	HandleRequest(pConnection);
+	return true;
+}
+
+void CHttpServer::Respond(Connection * pConnection, const char * szStatus, const char * szHeaders, const char * szBody)
+{
+	CString strHeader("HTTP/1.1 %s\r\nServer: " VERSION_IDENTIFIER_2 "\r\n%sConnection: %s\r\n", szStatus, szHeaders, (pConnection->bKeepAlive ? "keep-alive" : "close"));
+
+	if(szBody)
+		strHeader.AppendF("Content-Type: text/plain\r\nContent-Length: %d\r\n\r\n%s", (int)strlen(szBody), szBody);
+	else
+		strHeader.Append("\r\n");
+
+	pConnection->strHeader = strHeader.Get();
+	pConnection->sHeaderSent = 0;
+}
+
+void CHttpServer::HandleRequest(Connection * pConnection)
+{
+	// Do we have the whole request head?
+	size_t sHeadEnd = pConnection->strRequest.find("\r\n\r\n");
+
+	if(sHeadEnd == std::string::npos || sHeadEnd > HTTP_MAX_REQUEST_SIZE)
+	{
+		if(pConnection->strRequest.size() > HTTP_MAX_REQUEST_SIZE)
+		{
+			pConnection->bKeepAlive = false;
+			Respond(pConnection, "431 Request Header Fields Too Large", "", "Request header fields too large");
+		}
+
+		return;
+	}
+
+	std::string strHead = pConnection->strRequest.substr(0, sHeadEnd);
+	pConnection->strRequest.erase(0, (sHeadEnd + 4));
+
+	// Parse the request line
+	size_t sLineEnd = strHead.find("\r\n");
+	std::string strLine = strHead.substr(0, sLineEnd);
+	size_t sMethodEnd = strLine.find(' ');
+	size_t sTargetEnd = ((sMethodEnd != std::string::npos) ? strLine.find(' ', (sMethodEnd + 1)) : std::string::npos);
+
+	if(sTargetEnd == std::string::npos || strLine.compare((sTargetEnd + 1), 7, "HTTP/1.") != 0)
+	{
+		pConnection->bKeepAlive = false;
+		Respond(pConnection, "400 Bad Request", "", "Bad request");
+		return;
+	}
+
+	std::string strMethod = strLine.substr(0, sMethodEnd);
+	std::string strTarget = strLine.substr((sMethodEnd + 1), (sTargetEnd - sMethodEnd - 1));
+
+	// HTTP/1.1 keeps the connection open by default, HTTP/1.0 only if asked for
+	pConnection->bKeepAlive = (strLine.compare((sTargetEnd + 1), std::string::npos, "HTTP/1.1") == 0);
+
+	// Parse the headers we care about
+	bool bAcceptsGzip = false;
+	bool bHasBody = false;
+	std::string strIfNoneMatch;
+	std::string strRange;
+	std::string strIfRange;
+	size_t sPos = ((sLineEnd != std::string::npos) ? (sLineEnd + 2) : strHead.size());
+
+	while(sPos < strHead.size())
+	{
+		size_t sEnd = strHead.find("\r\n", sPos);
+
+		if(sEnd == std::string::npos)
+			sEnd = strHead.size();
+
+		size_t sColon = strHead.find(':', sPos);
+
+		if(sColon != std::string::npos && sColon < sEnd)
+		{
+			std::string strName = strHead.substr(sPos, (sColon - sPos));
+			size_t sValueStart = (sColon + 1);
+
+			while(sValueStart < sEnd && isspace((unsigned char)strHead[sValueStart]))
+				sValueStart++;
+
+			std::string strValue = strHead.substr(sValueStart, (sEnd - sValueStart));
+
+			if(!strcasecmp(strName.c_str(), "Connection"))
+			{
+				if(HasToken(strValue, "close"))
+					pConnection->bKeepAlive = false;
+				else if(HasToken(strValue, "keep-alive"))
+					pConnection->bKeepAlive = true;
+			}
+			else if(!strcasecmp(strName.c_str(), "Accept-Encoding"))
+			{
+				bAcceptsGzip = HasToken(strValue, "gzip");
+			}
+			else if(!strcasecmp(strName.c_str(), "If-None-Match"))
+			{
+				strIfNoneMatch = strValue;
+			}
+			else if(!strcasecmp(strName.c_str(), "Range"))
+			{
+				strRange = strValue;
+			}
+			else if(!strcasecmp(strName.c_str(), "If-Range"))
+			{
+				strIfRange = strValue;
+			}
+			else if(!strcasecmp(strName.c_str(), "Content-Length"))
+			{
+				bHasBody = (atoll(strValue.c_str()) != 0);
+			}
+			else if(!strcasecmp(strName.c_str(), "Transfer-Encoding"))
+			{
+				bHasBody = true;
+			}
+		}
+
+		sPos = (sEnd + 2);
+	}
+
+	// We don't take request bodies, we couldn't tell where the next request starts
+	if(bHasBody)
+	{
+		pConnection->bKeepAlive = false;
+		Respond(pConnection, "400 Bad Request", "", "Request bodies are not supported");
+		return;
+	}
+
+	bool bHead = (strMethod == "HEAD");
+
+	if(!bHead && strMethod != "GET")
+	{
+		Respond(pConnection, "405 Method Not Allowed", "Allow: GET, HEAD\r\n", "Method not allowed");
+		return;
+	}
+
+	// Strip the query and the leading slash
+	size_t sQuery = strTarget.find('?');
+
+	if(sQuery != std::string::npos)
+		strTarget.erase(sQuery);
+
+	std::string strUrl;
+
+	if(strTarget.empty() || strTarget[0] != '/' || !DecodeUrl(strTarget.substr(1), strUrl))
+	{
+		pConnection->bKeepAlive = false;
+		Respond(pConnection, "400 Bad Request", "", "Bad request");
+		return;
+	}
+
+	// Only files registered by the resources can be downloaded
+	auto iter = m_files.find(CString(strUrl.c_str()));
+	FILE * pStream = NULL;
+
+	// Open it first and answer from the opened file, so the headers match the body even if the file gets changed
+	if(iter == m_files.end() || !(pStream = fopen(iter->second->strPath.Get(), "rb")) || !Prepare(iter->second, pStream))
+	{
+		if(pStream)
+			fclose(pStream);
+
+		Respond(pConnection, "404 Not Found", "", (bHead ? NULL : "Not found"));
+		return;
+	}
+
+	std::shared_ptr<File> pFile = iter->second;
+
+	// The compressed version is another representation, so it needs its own tag
+	CString strETag("\"%08x\"", pFile->uiChecksum);
+	CString strGzipETag("\"%08x-gz\"", pFile->uiChecksum);
+
+	// Resumed downloads ask for the rest of the uncompressed file, unless it changed since (If-Range)
+	long long llFirst = 0;
+	long long llLast = (pFile->llSize - 1);
+	bool bSatisfiable = true;
+	bool bRange = (!strRange.empty() && (strIfRange.empty() || strIfRange == strETag.Get()) && ParseRange(strRange, pFile->llSize, llFirst, llLast, bSatisfiable));
+
+	bool bGzip = (!bRange && bAcceptsGzip && !pFile->strGzip.empty());
+
+	// Does the client have the file already?
+	if(!strIfNoneMatch.empty() && (strIfNoneMatch == "*" || strIfNoneMatch.find(strETag.Get()) != std::string::npos || strIfNoneMatch.find(strGzipETag.Get()) != std::string::npos))
+	{
+		fclose(pStream);
+
+		CString strHeaders("ETag: %s\r\nCache-Control: no-cache\r\nVary: Accept-Encoding\r\n", (bGzip ? strGzipETag : strETag).Get());
+		Respond(pConnection, "304 Not Modified", strHeaders.Get(), NULL);
+		return;
+	}
+
+	if(bRange && !bSatisfiable)
+	{
+		fclose(pStream);
+
+		CString strHeaders("Content-Range: bytes */%lld\r\n", pFile->llSize);
+		Respond(pConnection, "416 Range Not Satisfiable", strHeaders.Get(), (bHead ? NULL : "Range not satisfiable"));
+		return;
+	}
+
+	long long llSize = (bGzip ? (long long)pFile->strGzip.size() : pFile->llSize);
+
+	// Keep the file open for the uncompressed body
+	if(!bHead && !bGzip)
+		pConnection->pBody = pStream;
+	else
+		fclose(pStream);
+
+	CString strHeader("HTTP/1.1 %s\r\nServer: " VERSION_IDENTIFIER_2 "\r\nContent-Type: %s\r\nContent-Length: %lld\r\nETag: %s\r\nCache-Control: no-cache\r\nVary: Accept-Encoding\r\nAccept-Ranges: bytes\r\n",
+		(bRange ? "206 Partial Content" : "200 OK"), pFile->szContentType, (bRange ? (llLast - llFirst + 1) : llSize), (bGzip ? strGzipETag : strETag).Get());
+
+	if(bRange)
+		strHeader.AppendF("Content-Range: bytes %lld-%lld/%lld\r\n", llFirst, llLast, pFile->llSize);
+	else if(bGzip)
+		strHeader.Append("Content-Encoding: gzip\r\n");
+
+	strHeader.AppendF("Connection: %s\r\n\r\n", (pConnection->bKeepAlive ? "keep-alive" : "close"));
+
+	pConnection->strHeader = strHeader.Get();
+	pConnection->sHeaderSent = 0;
+	pConnection->pFile = pFile;
+	pConnection->bGzip = bGzip;
+	pConnection->llBodyPosition = (bRange ? llFirst : 0);
+	pConnection->llBodyEnd = (bHead ? pConnection->llBodyPosition : (bRange ? (llLast + 1) : llSize));
+}
+
+void CHttpServer::Close(Connection * pConnection)
+{
+	if(pConnection->pBody)
+		fclose(pConnection->pBody);
+
+	CLOSE_SOCKET(pConnection->socket);
+	delete pConnection;
+}
@@ -0,0 +1,151 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CHttpServer.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CHttpServer_h
+#define CHttpServer_h
+
+#include <Common.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Threading/CThread.h>
+#include <Threading/CMutex.h>
+
+#ifdef _WIN32
+typedef SOCKET HttpSocket;
+#else
+typedef int HttpSocket;
+#endif
+
+// Connections above this get closed right after they were accepted
+#define HTTP_MAX_CONNECTIONS			128
+
+// Longest request head we accept (bytes)
+#define HTTP_MAX_REQUEST_SIZE			8192
+
+// Keep-alive connections without any traffic get closed after this (ms)
+#define HTTP_IDLE_TIMEOUT				30000
+
+// Most we hand to the socket at once (bytes)
+#define HTTP_SEND_CHUNK_SIZE			65536
+
+// Longest the worker waits for socket events (ms), also bounds how long Stop takes
+#define HTTP_POLL_TIME					50
+
+// How often throttled connections get new budget (ms)
+#define HTTP_THROTTLE_TIME				10
+
+// Files smaller than this are never compressed (bytes)
+#define HTTP_GZIP_MIN_SIZE				256
+
+// Serves the client files of the running resources as http://host:httpport/<resource>/<file>.
+// Everything but AddFile/RemoveFile/RemoveResource runs on its own thread
+class CHttpServer {
+
+private:
+	struct File
+	{
+		CString			strPath;
+		const char		* szContentType;
+
+		// Filled the first time the file gets requested, the entry gets replaced once the opened file differs
+		bool			bPrepared;
+		unsigned int	uiChecksum;
+		long long		llSize;
+		time_t			modificationTime;
+		std::string		strGzip;		// Empty if compressing didn't pay off
+	};
+
+	struct Connection
+	{
+		HttpSocket				socket;
+		unsigned long			ulLastActivity;
+
+		// Received data which wasn't handled yet
+		std::string				strRequest;
+
+		// The response which is being sent
+		std::string				strHeader;
+		size_t					sHeaderSent;
+		std::shared_ptr<File>	pFile;			// Keeps the file alive if it gets removed during the transfer
+		bool					bGzip;
+		FILE					* pBody;		// The file on disk for uncompressed bodies
+		long long				llBodyPosition;	// Offsets into the file, a range request doesn't start at 0
+		long long				llBodyEnd;
+		bool					bKeepAlive;
+
+		// Bandwidth budget (bytes)
+		long long				llAllowance;
+		unsigned long			ulLastRefill;
+	};
+
+	enum eFileChange
+	{
+		FILE_CHANGE_ADD,
+		FILE_CHANGE_REMOVE,
+		FILE_CHANGE_REMOVE_RESOURCE,
+	};
+
+	struct FileChange
+	{
+		eFileChange		type;
+		CString			strUrl;
+		CString			strPath;
+	};
+
+	static CHttpServer		* s_pInstance;
+
+	CThread					m_thread;
+	bool					m_bRunning;
+	std::atomic<bool>		m_bStopping;
+
+	// Bytes per second for every connection, 0 means unlimited
+	std::atomic<unsigned int>	m_uiBandwidth;
+
+	// Queued by the main thread, applied by the worker
+	CMutex					m_mutex;
+	std::vector<FileChange>	m_changes;
+
+	// Only touched by the worker
+	HttpSocket				m_listenSocket;
+	std::map<CString, std::shared_ptr<File>>	m_files;
+	std::vector<Connection *>	m_connections;
+	std::vector<char>		m_buffer;
+
+	static void				WorkerThread(CThread * pThread);
+	static void				BandwidthChanged(const CString& strSetting, void * pUserData);
+
+	void					ApplyChanges();
+	void					Accept();
+	bool					Receive(Connection * pConnection);
+	bool					Send(Connection * pConnection);
+	void					HandleRequest(Connection * pConnection);
+	void					Respond(Connection * pConnection, const char * szStatus, const char * szHeaders, const char * szBody);
+	void					Close(Connection * pConnection);
+	bool					Prepare(std::shared_ptr<File>& pFile, FILE * pStream);
+
+public:
+	CHttpServer();
+	~CHttpServer();
+
+	static CHttpServer		*GetInstance() { return s_pInstance; }
+
+	bool					Start(unsigned short usPort, const CString& strHostAddress);
+	void					Stop();
+	bool					IsRunning() { return m_bRunning; }
+
+	// Makes the file downloadable as /<resource>/<name>
+	void					AddFile(const CString& strResource, const CString& strName, const CString& strPath);
+	void					RemoveFile(const CString& strResource, const CString& strName);
+	void					RemoveResource(const CString& strResource);
+};
+
+#endif // CHttpServer_h
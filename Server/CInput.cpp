@@ -8,11 +8,109 @@
 //==============================================================================
 
 #include "CInput.h"
+#include <atomic>
+#include <vector>
+#include <Threading/CMutex.h>
 #include <CLogFile.h>
+#include <CSettings.h>
 #include <Scripting/CEvents.h>
+#include <Scripting/CScriptProfiler.h>
+#include "CServer.h"
 
 extern bool g_bClose;
 
+// Commands queued by the input thread for the main thread
+static CMutex					g_commandMutex;
+static std::vector<CString>		g_queuedCommands;
+static std::atomic<bool>		g_bCommandsQueued(false);
+
+static void RPCStatsCommand(const CString& strParameters)
+{
+	CRPCRegistry * pRPCRegistry = CNetworkModule::GetRPCRegistry();
+
+	if(strParameters == "on" || strParameters == "off") {
+		pRPCRegistry->SetStatisticsEnabled(strParameters == "on");
+		CLogFile::Printf("[Server] RPC statistics %s.", (strParameters == "on" ? "enabled" : "disabled"));
+		return;
+
+	} else if(strParameters == "reset") {
+		pRPCRegistry->ResetStatistics();
+		CLogFile::Print("[Server] RPC statistics reset.");
+		return;
+
+	}
+
+	if(!pRPCRegistry->GetStatisticsEnabled())
+		CLogFile::Print("[Server] RPC statistics are disabled, use 'rpcstats on' to enable them.");
+
+	// Print every rpc which was called at least once
+	for(RPCIdentifier rpcId = 0; rpcId < RPC_MAX; rpcId++) {
+		RPCStatistics * pStatistics = pRPCRegistry->GetStatistics(rpcId);
+
+		if(pStatistics->ulCalls > 0)
+			CLogFile::Printf("RPC %d: %lu calls, %lu bytes", rpcId, pStatistics->ulCalls, pStatistics->ulBytes);
+	}
+
+	// Rpcs with an out of range or unregistered id
+	RPCStatistics * pUnknown = pRPCRegistry->GetStatistics(RPC_STATISTICS_UNKNOWN);
+
+	if(pUnknown->ulCalls > 0)
+		CLogFile::Printf("Unknown RPCs: %lu calls, %lu bytes", pUnknown->ulCalls, pUnknown->ulBytes);
+}
+
+static void LogLevelCommand(const CString& strParameters)
+{
+	size_t sSplit = strParameters.Find(' ', 0);
+
+	// No level given, print the current ones
+	if(sSplit == std::string::npos) {
+		for(int i = 0; i < LOG_CATEGORY_MAX; i++)
+			CLogFile::Printf("Log level %s: %s", CLogFile::GetCategoryName((eLogCategory)i), CLogFile::GetLevelName(CLogFile::GetLevel((eLogCategory)i)));
+
+		return;
+	}
+
+	CString strCategory = strParameters.Substring(0, sSplit++);
+	CString strLevel = strParameters.Substring(sSplit);
+	eLogCategory category;
+	eLogLevel level;
+
+	if(!CLogFile::GetCategoryFromName(strCategory.Get(), category) || !CLogFile::GetLevelFromName(strLevel.Get(), level)) {
+		CLogFile::Print("Usage: loglevel [<general|network|script> <debug|info|warning|error|none>]");
+		return;
+	}
+
+	// The change handler applies it
+	CVAR_SET_STRING(CString("loglevel.%s", strCategory.Get()), strLevel);
+	CLogFile::Printf("[Server] Log level of %s set to %s.", strCategory.Get(), strLevel.Get());
+}
+
+void CInput::Process()
+{
+	// Nothing queued, don't bother with the lock
+	if(!g_bCommandsQueued)
+		return;
+
+	std::vector<CString> commands;
+
+	g_commandMutex.Lock();
+	commands.swap(g_queuedCommands);
+	g_bCommandsQueued = false;
+	g_commandMutex.Unlock();
+
+	for(auto& strInput : commands)
+	{
+		size_t sSplit = strInput.Find(' ', 0);
+		CString strCommand = strInput.Substring(0, sSplit++);
+		CString strParameters = strInput.Substring(sSplit, (strInput.GetLength() - sSplit));
+
+		if(strCommand == "rpcstats")
+			RPCStatsCommand(strParameters);
+		else if(strCommand == "loglevel")
+			LogLevelCommand(strParameters);
+	}
+}
+
 void CInput::InputThread(CThread* pThread)
 {
 	CString strInput = GetInput();
@@ -48,9 +146,40 @@ void CInput::ProcessInput(CString strInput)
 		printf("loadresource <name>\n");
 		printf("reloadresource <name>\n");
 		printf("unloadresource <name>\n");
+		printf("rpcstats [on|off|reset]\n");
+		printf("loglevel [<category> <level>]\n");
+		printf("profile <start [sample]|stop|dump [file]>\n");
 		printf("exit\n");
 		return;
 
+	} else if(strCommand == "rpcstats" || strCommand == "loglevel") {
+		// The main thread counts the rpcs and owns the settings, so it has to run these
+		g_commandMutex.Lock();
+		g_queuedCommands.push_back(strInput);
+		g_bCommandsQueued = true;
+		g_commandMutex.Unlock();
+		return;
+
+	} else if(strCommand == "profile") {
+		// The profiler runs the commands with the next server tick
+		if(strParameters == "start" || strParameters == "start sample") {
+			CScriptProfiler::RequestStart(strParameters == "start sample");
+			return;
+
+		} else if(strParameters == "stop") {
+			CScriptProfiler::RequestStop();
+			return;
+
+		} else if(strParameters.Substring(0, 4) == "dump") {
+			CString strFile = (strParameters.GetLength() > 5 ? strParameters.Substring(5, (strParameters.GetLength() - 5)) : CString("profile.folded"));
+			CScriptProfiler::RequestDump(strFile.Get());
+			return;
+
+		}
+
+		CLogFile::Print("Usage: profile <start [sample]|stop|dump [file]>");
+		return;
+
 	}
 }
 
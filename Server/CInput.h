@@ -23,6 +23,9 @@ public:
 	static CString	GetInput();
 	static void		ProcessInput(CString strInput);
 	static void		InputThread(CThread* pThread);
+
+	// Runs the queued commands which touch state of the main thread, called from the main loop
+	static void		Process();
 };
 
 #endif // CInput_h
\ No newline at end of file
@@ -0,0 +1,350 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CQueryServer.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CQueryServer.h"
+#include "CServer.h"
+#include <CLogFile.h>
+#include <CSettings.h>
+#include <SharedUtility.h>
+#include <RakNet/RakSleep.h>
+
+#ifdef _WIN32
+#define poll					WSAPoll
+#define CLOSE_SOCKET			closesocket
+#define INVALID_QUERY_SOCKET	INVALID_SOCKET
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#define CLOSE_SOCKET			close
+#define INVALID_QUERY_SOCKET	-1
+#endif
+
+// Settings which end up in the info response
+static const char * g_szInfoSettings[] =
+{
+	"hostname",
+	"maxplayers",
+	"password",
+};
+
+// Settings which get sent as rules
+static const char * g_szRuleSettings[] =
+{
+	"weather",
+	"wind",
+	"streamdistance",
+	"vehicledamage",
+	"vehiclewaterdeath",
+	"guinametags",
+	"headmovement",
+	"paynspray",
+	"autoaim",
+};
+
+// All numbers are little endian, strings are prefixed with their length
+static void WriteShort(std::string& strData, unsigned short usValue)
+{
+	strData += (char)(usValue & 0xFF);
+	strData += (char)(usValue >> 8);
+}
+
+static void WriteString(std::string& strData, const CString& strValue)
+{
+	WriteShort(strData, (unsigned short)strValue.GetLength());
+	strData.append(strValue.Get(), strValue.GetLength());
+}
+
+static void WriteHeader(std::string& strData, char cType)
+{
+	strData.append(QUERY_MAGIC, QUERY_MAGIC_LENGTH);
+	strData += cType;
+}
+
+static void SetNonBlocking(QuerySocket socket)
+{
+#ifdef _WIN32
+	u_long ulNonBlocking = 1;
+	ioctlsocket(socket, FIONBIO, &ulNonBlocking);
+#else
+	fcntl(socket, F_SETFL, (fcntl(socket, F_GETFL, 0) | O_NONBLOCK));
+#endif
+}
+
+CQueryServer * CQueryServer::s_pInstance = NULL;
+
+CQueryServer::CQueryServer()
+{
+	s_pInstance = this;
+
+	m_bRunning = false;
+	m_bStopping = false;
+	m_bDirty = false;
+	m_socket = INVALID_QUERY_SOCKET;
+	m_ulLastPrune = 0;
+}
+
+CQueryServer::~CQueryServer()
+{
+	Stop();
+
+	s_pInstance = NULL;
+}
+
+bool CQueryServer::Start(unsigned short usPort, const CString& strHostAddress)
+{
+	if(m_bRunning)
+		return false;
+
+	// Create the socket
+	m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	if(m_socket == INVALID_QUERY_SOCKET)
+	{
+		CLogFile::Printf("Failed to create the query server socket.");
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(usPort);
+	address.sin_addr.s_addr = (strHostAddress.IsEmpty() ? htonl(INADDR_ANY) : inet_addr(strHostAddress.Get()));
+
+	if(bind(m_socket, (sockaddr *)&address, sizeof(address)) != 0)
+	{
+		CLogFile::Printf("Failed to bind the query server to port %d.", usPort);
+		CLOSE_SOCKET(m_socket);
+		m_socket = INVALID_QUERY_SOCKET;
+		return false;
+	}
+
+	SetNonBlocking(m_socket);
+
+	// Build the first responses and rebuild them whenever one of the settings in them changes
+	Publish();
+
+	for(size_t i = 0; i < (sizeof(g_szInfoSettings) / sizeof(const char *)); i++)
+		CSettings::AddChangeHandler(g_szInfoSettings[i], SettingChanged, this);
+
+	for(size_t i = 0; i < (sizeof(g_szRuleSettings) / sizeof(const char *)); i++)
+		CSettings::AddChangeHandler(g_szRuleSettings[i], SettingChanged, this);
+
+	// Start the worker
+	m_bStopping = false;
+	m_bRunning = true;
+	m_ulLastPrune = SharedUtility::GetTime();
+	m_thread.SetUserData(this);
+	m_thread.Start(WorkerThread);
+	return true;
+}
+
+void CQueryServer::Stop()
+{
+	if(!m_bRunning)
+		return;
+
+	for(size_t i = 0; i < (sizeof(g_szInfoSettings) / sizeof(const char *)); i++)
+		CSettings::RemoveChangeHandler(g_szInfoSettings[i], SettingChanged, this);
+
+	for(size_t i = 0; i < (sizeof(g_szRuleSettings) / sizeof(const char *)); i++)
+		CSettings::RemoveChangeHandler(g_szRuleSettings[i], SettingChanged, this);
+
+	// Let the worker exit
+	m_bStopping = true;
+
+	while(m_thread.IsRunning())
+		RakSleep(1);
+
+	CLOSE_SOCKET(m_socket);
+	m_socket = INVALID_QUERY_SOCKET;
+
+	m_sources.clear();
+	std::atomic_store(&m_pResponses, std::shared_ptr<const Responses>());
+	m_bDirty = false;
+	m_bRunning = false;
+}
+
+void CQueryServer::SettingChanged(const CString& strSetting, void * pUserData)
+{
+	((CQueryServer *)pUserData)->Invalidate();
+}
+
+void CQueryServer::Process()
+{
+	// Nothing changed since the last publish, this is all a tick pays for queries
+	if(!m_bRunning || !m_bDirty)
+		return;
+
+	Publish();
+}
+
+void CQueryServer::Publish()
+{
+	std::shared_ptr<Responses> pResponses = std::make_shared<Responses>();
+	CPlayerManager * pPlayerManager = CServer::GetInstance()->GetPlayerManager();
+
+	// Info: hostname, players, max players, passworded and version
+	WriteHeader(pResponses->strInfo, QUERY_TYPE_INFO);
+	WriteString(pResponses->strInfo, CVAR_GET_STRING("hostname"));
+	WriteShort(pResponses->strInfo, (unsigned short)pPlayerManager->GetCount());
+	WriteShort(pResponses->strInfo, (unsigned short)CVAR_GET_INTEGER("maxplayers"));
+	pResponses->strInfo += (char)(CVAR_GET_STRING("password").IsNotEmpty() ? 1 : 0);
+	WriteString(pResponses->strInfo, MOD_VERSION_STRING);
+
+	// Rules: count followed by name/value pairs
+	WriteHeader(pResponses->strRules, QUERY_TYPE_RULES);
+	WriteShort(pResponses->strRules, (unsigned short)(sizeof(g_szRuleSettings) / sizeof(const char *)));
+
+	for(size_t i = 0; i < (sizeof(g_szRuleSettings) / sizeof(const char *)); i++)
+	{
+		WriteString(pResponses->strRules, g_szRuleSettings[i]);
+		WriteString(pResponses->strRules, CVAR_GET_EX(g_szRuleSettings[i]));
+	}
+
+	// Players: count followed by id/name pairs
+	WriteHeader(pResponses->strPlayers, QUERY_TYPE_PLAYERS);
+	WriteShort(pResponses->strPlayers, (unsigned short)pPlayerManager->GetCount());
+
+	for(EntityId i = 0; i < pPlayerManager->GetCount(); i++)
+	{
+		CPlayerEntity * pPlayer = pPlayerManager->GetActiveAt(i);
+
+		WriteShort(pResponses->strPlayers, (unsigned short)pPlayer->GetId());
+		WriteString(pResponses->strPlayers, pPlayer->GetName());
+	}
+
+	// Swap them in, the worker keeps the old ones alive until it's done with them
+	std::atomic_store(&m_pResponses, std::shared_ptr<const Responses>(pResponses));
+	m_bDirty = false;
+}
+
+void CQueryServer::WorkerThread(CThread * pThread)
+{
+	CQueryServer * pQueryServer = pThread->GetUserData<CQueryServer *>();
+
+	while(!pQueryServer->m_bStopping)
+	{
+		pollfd pollFd;
+		pollFd.fd = pQueryServer->m_socket;
+		pollFd.events = POLLIN;
+		pollFd.revents = 0;
+
+		if(poll(&pollFd, 1, QUERY_POLL_TIME) > 0)
+			pQueryServer->Receive();
+
+		// Forget sources which stopped asking
+		unsigned long ulTime = SharedUtility::GetTime();
+
+		if((long)(ulTime - pQueryServer->m_ulLastPrune) >= QUERY_SOURCE_TIMEOUT)
+		{
+			for(auto iter = pQueryServer->m_sources.begin(); iter != pQueryServer->m_sources.end();)
+			{
+				if((long)(ulTime - iter->second.ulLastRefill) >= QUERY_SOURCE_TIMEOUT)
+					iter = pQueryServer->m_sources.erase(iter);
+				else
+					++iter;
+			}
+
+			pQueryServer->m_ulLastPrune = ulTime;
+		}
+	}
+}
+
+void CQueryServer::Receive()
+{
+	char szRequest[64];
+	sockaddr_in address;
+
+	// Handle everything which arrived since the last poll
+	while(true)
+	{
+		socklen_t addressLength = sizeof(address);
+		int iLength = recvfrom(m_socket, szRequest, sizeof(szRequest), 0, (sockaddr *)&address, &addressLength);
+
+		if(iLength < 0)
+			break;
+
+		// Silently drop anything which isn't a query
+		if(iLength < (QUERY_MAGIC_LENGTH + 1) || memcmp(szRequest, QUERY_MAGIC, QUERY_MAGIC_LENGTH))
+			continue;
+
+		std::shared_ptr<const Responses> pResponses = std::atomic_load(&m_pResponses);
+
+		if(!pResponses)
+			continue;
+
+		const std::string * pResponse = NULL;
+
+		switch(szRequest[QUERY_MAGIC_LENGTH])
+		{
+		case QUERY_TYPE_INFO:
+			pResponse = &pResponses->strInfo;
+			break;
+		case QUERY_TYPE_RULES:
+			pResponse = &pResponses->strRules;
+			break;
+		case QUERY_TYPE_PLAYERS:
+			pResponse = &pResponses->strPlayers;
+			break;
+		}
+
+		if(!pResponse)
+			continue;
+
+		// Don't let spoofed requests turn us into a traffic amplifier
+		if(!Allow(address.sin_addr.s_addr, pResponse->size()))
+			continue;
+
+		sendto(m_socket, pResponse->data(), (int)pResponse->size(), 0, (sockaddr *)&address, addressLength);
+	}
+}
+
+bool CQueryServer::Allow(unsigned long ulAddress, size_t sSize)
+{
+	unsigned long ulTime = SharedUtility::GetTime();
+	auto iter = m_sources.find(ulAddress);
+
+	if(iter == m_sources.end())
+	{
+		// Everything beyond this is most likely a flood of spoofed addresses
+		if(m_sources.size() >= QUERY_MAX_SOURCES)
+			return false;
+
+		Source source;
+		source.llAllowance = QUERY_RATE_BURST;
+		source.ulLastRefill = ulTime;
+		iter = m_sources.insert(std::make_pair(ulAddress, source)).first;
+	}
+	else
+	{
+		// Give it the budget for the time since its last request
+		long lElapsed = (long)(ulTime - iter->second.ulLastRefill);
+
+		if(lElapsed > 0)
+		{
+			iter->second.llAllowance += (((long long)lElapsed * QUERY_RATE_LIMIT) / 1000);
+
+			if(iter->second.llAllowance > QUERY_RATE_BURST)
+				iter->second.llAllowance = QUERY_RATE_BURST;
+
+			iter->second.ulLastRefill = ulTime;
+		}
+	}
+
+	if(iter->second.llAllowance < (long long)sSize)
+		return false;
+
+	iter->second.llAllowance -= sSize;
+	return true;
+}
@@ -0,0 +1,109 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CQueryServer.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CQueryServer_h
+#define CQueryServer_h
+
+#include <Common.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <Threading/CThread.h>
+
+#ifdef _WIN32
+typedef SOCKET QuerySocket;
+#else
+typedef int QuerySocket;
+#endif
+
+// Every request and response starts with this, followed by the query type
+#define QUERY_MAGIC						"IVMP"
+#define QUERY_MAGIC_LENGTH				4
+
+// Query types
+#define QUERY_TYPE_INFO					'i'
+#define QUERY_TYPE_RULES				'r'
+#define QUERY_TYPE_PLAYERS				'p'
+
+// Longest the worker waits for a request (ms), also bounds how long Stop takes
+#define QUERY_POLL_TIME					50
+
+// Response bytes per second every source address gets, and how much it can save up
+#define QUERY_RATE_LIMIT				4096
+#define QUERY_RATE_BURST				8192
+
+// Source addresses we keep track of, requests from new ones get dropped once this is reached
+#define QUERY_MAX_SOURCES				4096
+
+// Sources without requests for this long get forgotten (ms)
+#define QUERY_SOURCE_TIMEOUT			10000
+
+// Answers the server browser queries on queryport. The responses are built by the main thread whenever
+// something they contain changed and get swapped in as a whole, so queries never touch the tick.
+// Everything but Invalidate/Process runs on its own thread
+class CQueryServer {
+
+private:
+	// Complete response packets, never changed after they were published
+	struct Responses
+	{
+		std::string		strInfo;
+		std::string		strRules;
+		std::string		strPlayers;
+	};
+
+	struct Source
+	{
+		long long		llAllowance;		// Bytes we can still send to it
+		unsigned long	ulLastRefill;
+	};
+
+	static CQueryServer		* s_pInstance;
+
+	CThread					m_thread;
+	bool					m_bRunning;
+	std::atomic<bool>		m_bStopping;
+
+	// Written by the main thread, read by the worker
+	std::shared_ptr<const Responses>	m_pResponses;
+
+	// Only touched by the main thread
+	bool					m_bDirty;
+
+	// Only touched by the worker
+	QuerySocket				m_socket;
+	std::map<unsigned long, Source>	m_sources;
+	unsigned long			m_ulLastPrune;
+
+	static void				WorkerThread(CThread * pThread);
+	static void				SettingChanged(const CString& strSetting, void * pUserData);
+
+	void					Publish();
+	void					Receive();
+	bool					Allow(unsigned long ulAddress, size_t sSize);
+
+public:
+	CQueryServer();
+	~CQueryServer();
+
+	static CQueryServer		*GetInstance() { return s_pInstance; }
+
+	bool					Start(unsigned short usPort, const CString& strHostAddress);
+	void					Stop();
+	bool					IsRunning() { return m_bRunning; }
+
+	// Marks the responses as outdated, e.g. when a player joined or left
+	void					Invalidate() { m_bDirty = true; }
+
+	// Republishes the responses if they are outdated, called every tick
+	void					Process();
+};
+
+#endif // CQueryServer_h
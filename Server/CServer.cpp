@@ -8,13 +8,41 @@
 //==============================================================================
 
 #include "CServer.h"
+#include "CHttpServer.h"
+#include "CQueryServer.h"
 #include <Common.h>
 #include <CSettings.h>
 #include <SharedUtility.h>
 #include <CLogFile.h>
+#include <Scripting/CScriptProfiler.h>
 
 CServer* CServer::s_pInstance = 0;
 
+static void LogLevelChanged(const CString& strSetting, void * pUserData)
+{
+	// loglevel.<category>
+	eLogCategory category;
+
+	if(!CLogFile::GetCategoryFromName(strSetting.Substring(9).Get(), category))
+		return;
+
+	// Empty keeps what we have
+	CString strLevel = CVAR_GET_STRING(strSetting);
+
+	if(strLevel.IsEmpty())
+		return;
+
+	eLogLevel level;
+
+	if(!CLogFile::GetLevelFromName(strLevel.Get(), level))
+	{
+		CLogFile::Printf("WARNING: Invalid log level %s for %s, use debug, info, warning, error or none.", strLevel.Get(), strSetting.Get());
+		return;
+	}
+
+	CLogFile::SetLevel(category, level);
+}
+
 CServer::CServer()
 {
 	s_pInstance = this;
@@ -24,12 +52,48 @@ CServer::CServer()
 	m_pRPCHandler = new CServerRPCHandler();
 
 	m_pNetworkModule = new CNetworkModule();
+
+	m_pTickScheduler = NULL;
+
+	m_pStreamer = NULL;
+
+	m_pSyncRelay = NULL;
+
+	m_pTimerWheel = new CTimerWheel(SharedUtility::GetTime());
+
+	m_pDatabaseManager = new CDatabaseManager();
+
+	m_pHttpServer = new CHttpServer();
+
+	m_pQueryServer = new CQueryServer();
 }
 
 CServer::~CServer()
 {
+	// Timers hold script functions, so they have to go before the vms
+	SAFE_DELETE(m_pTimerWheel);
+
+	// Same for the query callbacks, this also waits for the running query
+	SAFE_DELETE(m_pDatabaseManager);
+
+	SAFE_DELETE(m_pHttpServer);
+
+	SAFE_DELETE(m_pQueryServer);
+
+	// Free the profiler data of all natives
+	CScriptProfiler::Shutdown();
+
+	// Both peers signal the scheduler's wake event, so stop them first
 	SAFE_DELETE(m_pNetServer);
 
+	SAFE_DELETE(m_pNetworkModule);
+
+	SAFE_DELETE(m_pTickScheduler);
+
+	SAFE_DELETE(m_pStreamer);
+
+	SAFE_DELETE(m_pSyncRelay);
+
 	SAFE_DELETE(m_pPlayerManager);
 
 	SAFE_DELETE(m_pVehicleManager);
@@ -82,6 +146,14 @@ bool CServer::Startup()
 		return false;
 	}
 
+	// Apply the log levels and follow changes to them
+	for(int i = 0; i < LOG_CATEGORY_MAX; i++)
+	{
+		CString strSetting("loglevel.%s", CLogFile::GetCategoryName((eLogCategory)i));
+		LogLevelChanged(strSetting, NULL);
+		CSettings::AddChangeHandler(strSetting, LogLevelChanged);
+	}
+
 #ifdef _WIN32
 		 // Color stuff
         CONSOLE_SCREEN_BUFFER_INFO csbiScreen;
@@ -117,6 +189,7 @@ bool CServer::Startup()
 		CLogFile::Printf(" HTTP Server: %s", CVAR_GET_STRING("httpserver").Get());
 
 	CLogFile::Printf(" Max Players: %d", CVAR_GET_INTEGER("maxplayers"));
+	CLogFile::Printf(" Tick Rate: %d", CVAR_GET_INTEGER("tickrate"));
 
 #ifdef _WIN32
         SetConsoleTextAttribute((HANDLE)GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_GREEN | FOREGROUND_INTENSITY);
@@ -164,6 +237,20 @@ bool CServer::Startup()
 
 		CLogFile::Print("");
 	}
+	// Serve the client files ourselves unless an external http server is set
+	if(CVAR_GET_STRING("httpserver").IsEmpty())
+	{
+		if(!m_pHttpServer->Start(CVAR_GET_INTEGER("httpport"), CVAR_GET_STRING("hostaddress")))
+			CLogFile::Printf("WARNING: Failed to start the HTTP server, clients won't be able to download resource files.");
+	}
+
+	// Answer the server browser
+	if(CVAR_GET_BOOL("query"))
+	{
+		if(!m_pQueryServer->Start(CVAR_GET_INTEGER("queryport"), CVAR_GET_STRING("hostaddress")))
+			CLogFile::Printf("WARNING: Failed to start the query server, the server won't show up in the server browser.");
+	}
+
 	m_pResourceManager = new CResourceManager("resources");
 
 	// Loading resources
@@ -182,24 +269,8 @@ bool CServer::Startup()
 
 	auto resources = CVAR_GET_LIST("resource");
 
-	int iResourcesLoaded = 0;
 	int iFailedResources = 0;
-
-	for(auto strResource : resources)
-	{
-		if(!strResource.IsEmpty())
-		{
-			CLogFile::Printf("Loading resource (%s)", strResource.C_String());
-			if(CResource* pResource = m_pResourceManager->Load(SharedUtility::GetAbsolutePath(m_pResourceManager->GetResourceDirectory()),strResource))
-			{
-				m_pResourceManager->StartResource(pResource);
-				iResourcesLoaded++;
-			} else {
-				CLogFile::Printf("Warning: Failed to load resource %s.", strResource.Get());
-				iFailedResources++;
-			}
-		}
-	}
+	int iResourcesLoaded = m_pResourceManager->LoadAndStart(SharedUtility::GetAbsolutePath(m_pResourceManager->GetResourceDirectory()), resources, iFailedResources);
 
 	CLogFile::Printf("Successfully loaded %d resources (%d failed).", iResourcesLoaded, iFailedResources);
 
@@ -217,13 +288,41 @@ bool CServer::Startup()
 
 	m_pNetworkModule->Startup();
 
+	// Create the entity streamer
+	m_pStreamer = new CStreamer(CVAR_GET_FLOAT("streamdistance"));
+
+	// Create the sync relay
+	m_pSyncRelay = new CSyncRelay();
+
+	// Create the tick scheduler and let both peers wake it up once a packet is ready
+	m_pTickScheduler = new CTickScheduler(CVAR_GET_INTEGER("tickrate"));
+	m_pNetworkModule->SetWakeEvent(m_pTickScheduler->GetWakeEvent());
+	m_pNetServer->SetWakeEvent(m_pTickScheduler->GetWakeEvent());
+
+	// Startup is done, don't let log output stall the ticks from now on
+	int iFlushInterval = CVAR_GET_INTEGER("logflushinterval");
+	CLogFile::StartWriter((iFlushInterval > 0 ? LOG_FLUSH_INTERVAL : LOG_FLUSH_ALWAYS), iFlushInterval);
+
 	return true;
 }
 
 void CServer::Process()
 {
+	// Sleep until the next tick is due
+	if(!m_pTickScheduler->WaitForTick())
+	{
+		// We got woken up early by incoming data, just handle the network
+		m_pNetServer->Process();
+		m_pNetworkModule->Pulse();
+		return;
+	}
+
+	m_pTickScheduler->BeginTick();
+
 	m_pNetServer->Process();
 
+	m_pNetworkModule->Pulse();
+
 	// Pulse all managers
 	// Do not worry about that some managers dont need to be pulsed its just that its complete and all the same structure
 	m_pPlayerManager->Pulse();
@@ -243,10 +342,33 @@ void CServer::Process()
 	m_pBlipManager->Pulse();
 
 	m_pCheckpointManager->Pulse();
+
+	// Run pending profiler commands from the console
+	CScriptProfiler::Process();
+
+	// Fire all expired script timers
+	m_pTimerWheel->Process(SharedUtility::GetTime());
+
+	// Call the callbacks of finished database queries
+	m_pDatabaseManager->Process();
+
+	// Update what every player has streamed in
+	m_pStreamer->Process();
+
+	// Send every player a snapshot of the players around him
+	m_pSyncRelay->Process();
+
+	// Republish the query responses if players or rules changed
+	m_pQueryServer->Process();
+
+	m_pTickScheduler->EndTick();
 }
 
 void CServer::Shutdown()
 {
+	m_pNetworkModule->SetWakeEvent(NULL);
+	m_pNetServer->SetWakeEvent(NULL);
+
 	m_pNetServer->EnsureStopped();
 
 	// TODO: clear events
@@ -24,7 +24,16 @@
 
 #include <Entity/CEntityManager.h>
 #include <Entity/Entities.h>
+#include <Entity/CStreamer.h>
+#include <Network/CSyncRelay.h>
+#include "CTimerWheel.h"
+#include "CDatabaseManager.h"
 #include "Network/CNetworkModule.h"
+#include "CTickScheduler.h"
+
+// Their headers pull in <memory>, which breaks once the squirrel headers were included
+class CHttpServer;
+class CQueryServer;
 
 typedef CEntityManager<CPlayerEntity, MAX_PLAYERS> CPlayerManager;
 typedef CEntityManager<CVehicleEntity, MAX_VEHICLES> CVehicleManager;
@@ -58,6 +67,16 @@ private:
 
 	CNetworkModule				* m_pNetworkModule;
 
+	CTickScheduler				* m_pTickScheduler;
+
+	CStreamer					* m_pStreamer;
+	CSyncRelay					* m_pSyncRelay;
+
+	CTimerWheel					* m_pTimerWheel;
+	CDatabaseManager			* m_pDatabaseManager;
+	CHttpServer					* m_pHttpServer;
+	CQueryServer				* m_pQueryServer;
+
 public:
 	CServer();
 	~CServer();
@@ -84,6 +103,16 @@ public:
 	CCheckpointManager	*GetCheckpointManager() { return m_pCheckpointManager; }
 
 	CNetworkModule		*GetNetworkModule() { return m_pNetworkModule; }
+
+	CTickScheduler		*GetTickScheduler() { return m_pTickScheduler; }
+
+	CStreamer			*GetStreamer() { return m_pStreamer; }
+	CSyncRelay			*GetSyncRelay() { return m_pSyncRelay; }
+
+	CTimerWheel			*GetTimerWheel() { return m_pTimerWheel; }
+	CDatabaseManager	*GetDatabaseManager() { return m_pDatabaseManager; }
+	CHttpServer			*GetHttpServer() { return m_pHttpServer; }
+	CQueryServer		*GetQueryServer() { return m_pQueryServer; }
 };
 
 #endif // CServer_h
\ No newline at end of file
@@ -0,0 +1,94 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTickScheduler.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CTickScheduler.h"
+#include <SharedUtility.h>
+#include <CLogFile.h>
+
+CTickScheduler::CTickScheduler(unsigned int uiTickRate)
+{
+	// Make sure we never divide by zero
+	if(uiTickRate == 0)
+		uiTickRate = 1;
+
+	m_ulTickInterval = (1000 / uiTickRate);
+
+	// Tick rates above 1000 would end up with a zero interval
+	if(m_ulTickInterval == 0)
+		m_ulTickInterval = 1;
+
+	m_ulNextTickTime = SharedUtility::GetTime();
+	m_ulTickStartTime = m_ulNextTickTime;
+	m_ulTickCount = 0;
+
+	m_ulLastOverrunLogTime = 0;
+	m_uiOverrunCount = 0;
+	m_ulWorstOverrun = 0;
+
+	m_wakeEvent.InitEvent();
+}
+
+CTickScheduler::~CTickScheduler()
+{
+	m_wakeEvent.CloseEvent();
+}
+
+bool CTickScheduler::WaitForTick()
+{
+	unsigned long ulTime = SharedUtility::GetTime();
+
+	// Is the next tick already due?
+	if((long)(m_ulNextTickTime - ulTime) <= 0)
+		return true;
+
+	// Block until the next tick is due or the network layer wakes us up
+	m_wakeEvent.WaitOnEvent((int)(m_ulNextTickTime - ulTime));
+
+	// Check again, we might have been woken up by incoming data
+	return ((long)(m_ulNextTickTime - SharedUtility::GetTime()) <= 0);
+}
+
+void CTickScheduler::BeginTick()
+{
+	m_ulTickStartTime = SharedUtility::GetTime();
+}
+
+void CTickScheduler::EndTick()
+{
+	unsigned long ulTime = SharedUtility::GetTime();
+	unsigned long ulTickDuration = (ulTime - m_ulTickStartTime);
+
+	m_ulTickCount++;
+
+	// Schedule the next tick relative to the previous one so we keep a fixed cadence
+	m_ulNextTickTime += m_ulTickInterval;
+
+	// Did the tick take longer than the budget?
+	if(ulTickDuration > m_ulTickInterval)
+	{
+		m_uiOverrunCount++;
+
+		if(ulTickDuration > m_ulWorstOverrun)
+			m_ulWorstOverrun = ulTickDuration;
+	}
+
+	// Are we behind by more than a whole tick? Don't try to catch up, just skip the missed ticks
+	if((long)(ulTime - m_ulNextTickTime) > (long)m_ulTickInterval)
+		m_ulNextTickTime = ulTime;
+
+	// Report overruns, but don't flood the console
+	if(m_uiOverrunCount > 0 && (ulTime - m_ulLastOverrunLogTime) >= TICK_OVERRUN_LOG_INTERVAL)
+	{
+		CLogFile::Printf("Warning: %d tick(s) exceeded the tick budget of %dms (worst: %dms).", m_uiOverrunCount, m_ulTickInterval, m_ulWorstOverrun);
+
+		m_ulLastOverrunLogTime = ulTime;
+		m_uiOverrunCount = 0;
+		m_ulWorstOverrun = 0;
+	}
+}
@@ -0,0 +1,53 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTickScheduler.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CTickScheduler_h
+#define CTickScheduler_h
+
+#include <Common.h>
+#include <RakNet/SignaledEvent.h>
+
+// Minimum time between two overrun log messages (ms)
+#define TICK_OVERRUN_LOG_INTERVAL 5000
+
+class CTickScheduler {
+
+private:
+	RakNet::SignaledEvent	m_wakeEvent;
+
+	unsigned long			m_ulTickInterval;
+	unsigned long			m_ulNextTickTime;
+	unsigned long			m_ulTickStartTime;
+	unsigned long			m_ulTickCount;
+
+	unsigned long			m_ulLastOverrunLogTime;
+	unsigned int			m_uiOverrunCount;
+	unsigned long			m_ulWorstOverrun;
+
+public:
+	CTickScheduler(unsigned int uiTickRate);
+	~CTickScheduler();
+
+	// Blocks until the next tick is due or the wake event got signaled.
+	// Returns true if a full tick should run, false if we only got woken up early
+	bool					WaitForTick();
+
+	void					BeginTick();
+	void					EndTick();
+
+	// Thread safe, may be called from any thread to interrupt the current wait
+	void					Wake() { m_wakeEvent.SetEvent(); }
+
+	RakNet::SignaledEvent	*GetWakeEvent() { return &m_wakeEvent; }
+
+	unsigned long			GetTickInterval() { return m_ulTickInterval; }
+	unsigned long			GetTickCount() { return m_ulTickCount; }
+};
+
+#endif // CTickScheduler_h
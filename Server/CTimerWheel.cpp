@@ -0,0 +1,286 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTimerWheel.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CTimerWheel.h"
+#include <Scripting/CEventHandler.h>
+#include <Scripting/ResourceSystem/CResource.h>
+#include <Scripting/CScriptProfiler.h>
+#include <SharedUtility.h>
+
+CTimerWheel * CTimerWheel::s_pInstance = NULL;
+
+CTimerWheel::CTimerWheel(unsigned long ulTime)
+{
+	s_pInstance = this;
+
+	m_ulTime = ulTime;
+	m_pFiringTimer = NULL;
+
+	for(int i = 0; i < TIMER_WHEEL_ROOT_SIZE; i++)
+		InitList(&m_root[i]);
+
+	for(int i = 0; i < TIMER_WHEEL_LEVELS; i++)
+	{
+		for(int j = 0; j < TIMER_WHEEL_LEVEL_SIZE; j++)
+			InitList(&m_levels[i][j]);
+	}
+}
+
+CTimerWheel::~CTimerWheel()
+{
+	for(size_t i = 0; i < m_timers.size(); i++)
+	{
+		if(m_timers[i])
+			Free(m_timers[i]);
+	}
+
+	s_pInstance = NULL;
+}
+
+void CTimerWheel::Link(TimerNode * pHead, TimerNode * pNode)
+{
+	pNode->pPrev = pHead->pPrev;
+	pNode->pNext = pHead;
+	pHead->pPrev->pNext = pNode;
+	pHead->pPrev = pNode;
+}
+
+void CTimerWheel::Unlink(TimerNode * pNode)
+{
+	pNode->pPrev->pNext = pNode->pNext;
+	pNode->pNext->pPrev = pNode->pPrev;
+	InitList(pNode);
+}
+
+void CTimerWheel::Splice(TimerNode * pFrom, TimerNode * pTo)
+{
+	// Move all nodes of pFrom into the empty list pTo
+	if(IsListEmpty(pFrom))
+	{
+		InitList(pTo);
+		return;
+	}
+
+	pTo->pNext = pFrom->pNext;
+	pTo->pPrev = pFrom->pPrev;
+	pTo->pNext->pPrev = pTo;
+	pTo->pPrev->pNext = pTo;
+	InitList(pFrom);
+}
+
+void CTimerWheel::Insert(Timer * pTimer)
+{
+	unsigned long ulExpires = pTimer->ulExpires;
+	unsigned long ulDelta = (ulExpires - m_ulTime);
+	TimerNode * pHead;
+
+	if((long)ulDelta < 0)
+	{
+		// Already expired, fire it with the current slot
+		pHead = &m_root[m_ulTime & (TIMER_WHEEL_ROOT_SIZE - 1)];
+	}
+	else if(ulDelta < TIMER_WHEEL_ROOT_SIZE)
+	{
+		pHead = &m_root[ulExpires & (TIMER_WHEEL_ROOT_SIZE - 1)];
+	}
+	else
+	{
+		// Clamp to the largest delta the wheel can hold
+		if(ulDelta > TIMER_WHEEL_MAX_DELTA)
+		{
+			ulDelta = TIMER_WHEEL_MAX_DELTA;
+			ulExpires = (m_ulTime + ulDelta);
+			pTimer->ulExpires = ulExpires;
+		}
+
+		int iLevel = 0;
+		while(ulDelta >= (1ul << (TIMER_WHEEL_ROOT_BITS + ((iLevel + 1) * TIMER_WHEEL_LEVEL_BITS))))
+			iLevel++;
+
+		pHead = &m_levels[iLevel][(ulExpires >> (TIMER_WHEEL_ROOT_BITS + (iLevel * TIMER_WHEEL_LEVEL_BITS))) & (TIMER_WHEEL_LEVEL_SIZE - 1)];
+	}
+
+	Link(pHead, pTimer);
+}
+
+unsigned int CTimerWheel::Cascade(int iLevel, unsigned int uiIndex)
+{
+	// Move all timers of the slot one level down
+	TimerNode list;
+	Splice(&m_levels[iLevel][uiIndex], &list);
+
+	while(!IsListEmpty(&list))
+	{
+		Timer * pTimer = (Timer *)list.pNext;
+		Unlink(pTimer);
+		Insert(pTimer);
+	}
+
+	return uiIndex;
+}
+
+CTimerWheel::Timer * CTimerWheel::Get(TimerId timerId, CResource * pResource)
+{
+	if(timerId < 0)
+		return NULL;
+
+	unsigned int uiSlot = (timerId & 0xFFFF);
+
+	if(uiSlot >= m_timers.size() || !m_timers[uiSlot] || m_timers[uiSlot]->timerId != timerId || m_timers[uiSlot]->bKilled)
+		return NULL;
+
+	if(pResource && m_timers[uiSlot]->pResource != pResource)
+		return NULL;
+
+	return m_timers[uiSlot];
+}
+
+TimerId CTimerWheel::Add(CResource * pResource, CEventHandler * pHandler, const CScriptArguments& arguments, unsigned long ulInterval, unsigned int uiTimesToExecute)
+{
+	// Get a free slot
+	unsigned short usSlot;
+
+	if(!m_freeSlots.empty())
+	{
+		usSlot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		// Are we out of ids?
+		if(m_timers.size() > 0xFFFF)
+		{
+			delete pHandler;
+			return INVALID_TIMER_ID;
+		}
+
+		usSlot = (unsigned short)m_timers.size();
+		m_timers.push_back(NULL);
+		m_generations.push_back(0);
+	}
+
+	if(ulInterval < TIMER_MIN_INTERVAL)
+		ulInterval = TIMER_MIN_INTERVAL;
+
+	Timer * pTimer = new Timer(arguments);
+	pTimer->timerId = (TimerId)(((m_generations[usSlot] & 0x7FFF) << 16) | usSlot);
+	pTimer->pResource = pResource;
+	pTimer->pHandler = pHandler;
+	pTimer->ulInterval = ulInterval;
+	pTimer->uiRemaining = uiTimesToExecute;
+	// Relative to now, the wheel lags behind while the resources load at startup and between ticks
+	pTimer->ulExpires = (SharedUtility::GetTime() + ulInterval);
+	pTimer->bKilled = false;
+	InitList(pTimer);
+
+	m_timers[usSlot] = pTimer;
+	Insert(pTimer);
+	return pTimer->timerId;
+}
+
+void CTimerWheel::Free(Timer * pTimer)
+{
+	unsigned short usSlot = (unsigned short)(pTimer->timerId & 0xFFFF);
+
+	Unlink(pTimer);
+
+	// Release the function reference
+	CScriptVM * pVM = pTimer->pHandler->GetVM();
+
+	if(pVM && pVM->GetVMType() == LUA_VM && pTimer->pHandler->GetRef() != -1)
+		luaL_unref(((CLuaVM*)pVM)->GetVM(), LUA_REGISTRYINDEX, pTimer->pHandler->GetRef());
+
+	SAFE_DELETE(pTimer->pHandler);
+	delete pTimer;
+
+	m_timers[usSlot] = NULL;
+	m_generations[usSlot]++;
+	m_freeSlots.push_back(usSlot);
+}
+
+bool CTimerWheel::Kill(TimerId timerId, CResource * pResource)
+{
+	Timer * pTimer = Get(timerId, pResource);
+
+	if(!pTimer)
+		return false;
+
+	// A timer which kills itself gets freed once its callback returned
+	if(pTimer == m_pFiringTimer)
+		pTimer->bKilled = true;
+	else
+		Free(pTimer);
+
+	return true;
+}
+
+void CTimerWheel::RemoveResource(CResource * pResource)
+{
+	for(size_t i = 0; i < m_timers.size(); i++)
+	{
+		if(m_timers[i] && m_timers[i]->pResource == pResource)
+			Kill(m_timers[i]->timerId);
+	}
+}
+
+void CTimerWheel::Fire(Timer * pTimer)
+{
+	m_pFiringTimer = pTimer;
+	size_t sDepth = CScriptProfiler::EnterHandler(pTimer->pResource, "timer");
+	pTimer->pHandler->Call(&pTimer->arguments);
+	CScriptProfiler::LeaveHandler(sDepth);
+	m_pFiringTimer = NULL;
+
+	// Was this the last execution?
+	if(pTimer->bKilled || (pTimer->uiRemaining != 0 && --pTimer->uiRemaining == 0))
+	{
+		Free(pTimer);
+		return;
+	}
+
+	// Schedule the next execution relative to this one, but don't try to catch up missed ones
+	pTimer->ulExpires += pTimer->ulInterval;
+
+	if((long)(pTimer->ulExpires - m_ulTime) <= 0)
+		pTimer->ulExpires = (m_ulTime + 1);
+
+	Insert(pTimer);
+}
+
+void CTimerWheel::Process(unsigned long ulTime)
+{
+	// Step through every ms which passed, empty slots are cheap
+	while((long)(ulTime - m_ulTime) >= 0)
+	{
+		unsigned int uiIndex = (m_ulTime & (TIMER_WHEEL_ROOT_SIZE - 1));
+
+		// Did the root wrap around? Then pull the next slot of the levels above down
+		if(uiIndex == 0)
+		{
+			for(int iLevel = 0; iLevel < TIMER_WHEEL_LEVELS; iLevel++)
+			{
+				if(Cascade(iLevel, ((m_ulTime >> (TIMER_WHEEL_ROOT_BITS + (iLevel * TIMER_WHEEL_LEVEL_BITS))) & (TIMER_WHEEL_LEVEL_SIZE - 1))) != 0)
+					break;
+			}
+		}
+
+		// Take all expired timers out first, callbacks may add or kill timers
+		TimerNode expired;
+		Splice(&m_root[uiIndex], &expired);
+
+		m_ulTime++;
+
+		while(!IsListEmpty(&expired))
+		{
+			Timer * pTimer = (Timer *)expired.pNext;
+			Unlink(pTimer);
+			Fire(pTimer);
+		}
+	}
+}
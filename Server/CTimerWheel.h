@@ -0,0 +1,107 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTimerWheel.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CTimerWheel_h
+#define CTimerWheel_h
+
+#include <Common.h>
+#include <vector>
+#include <Scripting/CScriptArguments.h>
+
+class CResource;
+class CEventHandler;
+
+// The wheel works in 1ms steps, level 0 has 256 slots, the three levels above 64 each.
+// That covers 2^26ms (~18 hours), longer intervals get clamped
+#define TIMER_WHEEL_ROOT_BITS			8
+#define TIMER_WHEEL_LEVEL_BITS			6
+#define TIMER_WHEEL_ROOT_SIZE			(1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE			(1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_LEVELS				3
+#define TIMER_WHEEL_MAX_DELTA			((1ul << (TIMER_WHEEL_ROOT_BITS + (TIMER_WHEEL_LEVELS * TIMER_WHEEL_LEVEL_BITS))) - 1)
+
+// Shortest interval a script may use (ms)
+#define TIMER_MIN_INTERVAL				50
+
+typedef int TimerId;
+
+#define INVALID_TIMER_ID				-1
+
+class CTimerWheel {
+
+private:
+	// Node of a circular list, every slot is the head of one
+	struct TimerNode
+	{
+		TimerNode		* pPrev;
+		TimerNode		* pNext;
+	};
+
+	struct Timer : TimerNode
+	{
+		TimerId				timerId;
+		CResource			* pResource;
+		CEventHandler		* pHandler;
+		CScriptArguments	arguments;
+		unsigned long		ulInterval;
+		unsigned int		uiRemaining;	// 0 = forever
+		unsigned long		ulExpires;
+		bool				bKilled;
+
+		Timer(const CScriptArguments& _arguments) : arguments(_arguments) {}
+	};
+
+	static CTimerWheel		* s_pInstance;
+
+	unsigned long			m_ulTime;
+
+	TimerNode				m_root[TIMER_WHEEL_ROOT_SIZE];
+	TimerNode				m_levels[TIMER_WHEEL_LEVELS][TIMER_WHEEL_LEVEL_SIZE];
+
+	// Timers by the low 16 bits of their id, the high bits are a generation so stale ids never hit a new timer
+	std::vector<Timer *>		m_timers;
+	std::vector<unsigned short>	m_generations;
+	std::vector<unsigned short>	m_freeSlots;
+
+	Timer					*m_pFiringTimer;
+
+	static void				InitList(TimerNode * pHead) { pHead->pPrev = pHead->pNext = pHead; }
+	static bool				IsListEmpty(TimerNode * pHead) { return (pHead->pNext == pHead); }
+	static void				Link(TimerNode * pHead, TimerNode * pNode);
+	static void				Unlink(TimerNode * pNode);
+	static void				Splice(TimerNode * pFrom, TimerNode * pTo);
+
+	void					Insert(Timer * pTimer);
+	unsigned int			Cascade(int iLevel, unsigned int uiIndex);
+	void					Fire(Timer * pTimer);
+	void					Free(Timer * pTimer);
+
+	// Only returns timers of pResource unless it's NULL
+	Timer					*Get(TimerId timerId, CResource * pResource = NULL);
+
+public:
+	CTimerWheel(unsigned long ulTime);
+	~CTimerWheel();
+
+	static CTimerWheel		*GetInstance() { return s_pInstance; }
+
+	// Takes ownership of the handler
+	TimerId					Add(CResource * pResource, CEventHandler * pHandler, const CScriptArguments& arguments, unsigned long ulInterval, unsigned int uiTimesToExecute);
+	// Scripts pass their resource, so they can't touch the timers of other resources
+	bool					Kill(TimerId timerId, CResource * pResource = NULL);
+	bool					Exists(TimerId timerId, CResource * pResource = NULL) { return (Get(timerId, pResource) != NULL); }
+
+	// Kills every timer of a resource
+	void					RemoveResource(CResource * pResource);
+
+	// Fires everything which expired until ulTime
+	void					Process(unsigned long ulTime);
+};
+
+#endif // CTimerWheel_h
@@ -17,23 +17,82 @@ class CEntityManager {
 private:
 	T* m_pEntities[max];
 
-public:
-	CEntityManager()
+	// Stack of free ids, the next id to hand out is at the top
+	EntityId m_freeIds[max];
+	EntityId m_freeCount;
+	// Position of each free id inside m_freeIds (only valid for free ids)
+	EntityId m_freeIndex[max];
+
+	// Densely packed ids of all live entities
+	EntityId m_activeIds[max];
+	EntityId m_activeCount;
+	// Position of each live id inside m_activeIds (only valid for live ids)
+	EntityId m_activeIndex[max];
+
+	// Bumped whenever an id gets freed, tells a reused id apart from the entity which had it before
+	unsigned int m_generations[max];
+
+	void		Reserve(EntityId entityId)
+	{
+		// Swap-remove the id from the free stack
+		EntityId index = m_freeIndex[entityId];
+		EntityId lastId = m_freeIds[--m_freeCount];
+		m_freeIds[index] = lastId;
+		m_freeIndex[lastId] = index;
+
+		// Append the id to the live list
+		m_activeIds[m_activeCount] = entityId;
+		m_activeIndex[entityId] = m_activeCount;
+		m_activeCount++;
+	}
+
+	void		Release(EntityId entityId)
+	{
+		// Swap-remove the id from the live list
+		EntityId index = m_activeIndex[entityId];
+		EntityId lastId = m_activeIds[--m_activeCount];
+		m_activeIds[index] = lastId;
+		m_activeIndex[lastId] = index;
+
+		// Push the id back onto the free stack
+		m_freeIds[m_freeCount] = entityId;
+		m_freeIndex[entityId] = m_freeCount;
+		m_freeCount++;
+
+		// mark the slot as free
+		m_pEntities[entityId] = 0;
+		m_generations[entityId]++;
+	}
+
+	void		ResetIds()
 	{
 		// Set all entities invalid
 		memset(&m_pEntities, 0, sizeof(m_pEntities));
+
+		// Fill the free stack in reverse order so the lowest ids get used first
+		for(EntityId id = 0; id < max; ++id)
+		{
+			m_freeIds[id] = (max - 1 - id);
+			m_freeIndex[max - 1 - id] = id;
+		}
+
+		m_freeCount = max;
+		m_activeCount = 0;
+	}
+
+public:
+	CEntityManager()
+	{
+		memset(&m_generations, 0, sizeof(m_generations));
+		ResetIds();
 	}
 	~CEntityManager()
 	{
-		// Loop through all entities
-		for(EntityId id = 0; id < max; ++id)
+		// Loop through all live entities
+		for(EntityId i = 0; i < m_activeCount; ++i)
 		{
-			// Check if ID exists
-			if(DoesExists(id))
-			{
-				// we could call Delete() here, but there's no need to get this done in a clean way as we're about to be deleted
-				delete m_pEntities[id];
-			}
+			// we could call Delete() here, but there's no need to get this done in a clean way as we're about to be deleted
+			delete m_pEntities[m_activeIds[i]];
 		}
 	}
 
@@ -47,6 +106,10 @@ public:
 
 	bool		Add(EntityId entityId, T* pEntity)
 	{
+		// Check if the id is valid at all
+		if(entityId >= max)
+			return false;
+
 		// Check if the Entity didn't exist yet
 		if(Exists(entityId))
 		{
@@ -55,6 +118,7 @@ public:
 		}
 
 		// save it
+		Reserve(entityId);
 		m_pEntities[entityId] = pEntity;
 
 		return true;
@@ -62,29 +126,27 @@ public:
 
 	EntityId	Add(T* pEntity)
 	{
-		for(EntityId id = 0; id < max; ++id)
+		// Get the next free id
+		EntityId id = FindFreeSlot();
+
+		if(id != INVALID_ENTITY_ID)
 		{
-			if(!Exists(id))
-			{
-				m_pEntities[id] = pEntity;
-				return id;
-			}
+			Reserve(id);
+			m_pEntities[id] = pEntity;
 		}
 
-		return INVALID_ENTITY_ID;
+		return id;
 	}
 
 	bool		Delete(T* pEntity)
 	{
-		for(EntityId id = 0; id < max; ++id)
+		// Loop through all live entities
+		for(EntityId i = 0; i < m_activeCount; ++i)
 		{
-			// Check if ID exists
-			if(Exists(id) && m_pEntities[id] == pEntity)
-			{
-				// we could call Delete() here, but there's no need to get this done in a clean way as we're about to be deleted
-				delete m_pEntities[id];
-				return true;
-			}
+			EntityId id = m_activeIds[i];
+
+			if(m_pEntities[id] == pEntity)
+				return Delete(id);
 		}
 		return false;
 	}
@@ -98,8 +160,8 @@ public:
 		// Delete the entity
 		delete m_pEntities[entityId];
 
-		// mark the slot as free
-		m_pEntities[entityId] = 0;
+		// Give the id back
+		Release(entityId);
 
 		return true;
 	}
@@ -116,45 +178,38 @@ public:
 
 	EntityId	FindFreeSlot()
 	{
-		for(EntityId i = 0; i < max; i++)
-		{
-			if(!DoesExists(i))
-				return i;
-		}
+		if(m_freeCount == 0)
+			return INVALID_ENTITY_ID;
 
-		return INVALID_ENTITY_ID;
+		return m_freeIds[m_freeCount - 1];
 	}
 
 	EntityId	GetCount()
 	{
-		EntityId count = 0;
+		return m_activeCount;
+	}
 
-		// Loop through all entities
-		for(EntityId id = 0; id < max; ++id)
-		{
-			// Check if ID exists
-			if(Exists(id))
-			{
-				// Increment the count
-				count++;
-			}
-		}
+	// Returns the entity at the given position of the live list (0 .. GetCount() - 1)
+	T*			GetActiveAt(EntityId index)
+	{
+		if(index < m_activeCount)
+			return m_pEntities[m_activeIds[index]];
 
-		return count;
+		return 0;
 	}
 
 	void		Reset()
 	{
-		// Loop through all entities
-		for(EntityId id = 0; id < max; ++id)
+		// Loop through all live entities
+		for(EntityId i = 0; i < m_activeCount; ++i)
 		{
-			// Check if ID exists
-			if(DoesExists(id))
-			{
-				// we could call Delete() here, but there's no need to get this done in a clean way as we're about to be deleted
-				delete m_pEntities[id];
-			}
+			// we could call Delete() here, but there's no need to get this done in a clean way as we're about to be deleted
+			delete m_pEntities[m_activeIds[i]];
+			m_generations[m_activeIds[i]]++;
 		}
+
+		// Mark all slots as free again
+		ResetIds();
 	}
 
 	EntityId	GetMax()
@@ -162,16 +217,22 @@ public:
 		return max;
 	}
 
+	unsigned int GetGeneration(EntityId entityId)
+	{
+		return (entityId < max) ? m_generations[entityId] : 0;
+	}
+
 	void		Pulse()
 	{
-		// Loop through all entities
-		for(EntityId id = 0; id < max; ++id)
+		// Loop backwards through all live entities, so an entity deleting itself during its pulse
+		// only swaps in an entity we already pulsed
+		for(EntityId i = m_activeCount; i > 0; --i)
 		{
-			// Check if ID exists
-			if(DoesExists(id))
-			{
-				m_pEntities[id]->Pulse();
-			}
+			// Skip positions which got removed by a previous pulse
+			if(i > m_activeCount)
+				continue;
+
+			m_pEntities[m_activeIds[i - 1]]->Pulse();
 		}
 	}
 };
@@ -11,10 +11,63 @@
 
 CPlayerEntity::CPlayerEntity()
 {
-
+	m_eSyncType = UNKNOWN_ENTITY;
+	memset(&m_playerSync, 0, sizeof(m_playerSync));
+	memset(&m_vehicleSync, 0, sizeof(m_vehicleSync));
+	m_usSyncSequence = 0;
 }
 
 CPlayerEntity::~CPlayerEntity()
 {
 
+}
+
+bool CPlayerEntity::ReadSync(RakNet::BitStream * pBitStream)
+{
+	// Read the entity type
+	unsigned char ucType;
+
+	if(!pBitStream->Read(ucType))
+		return false;
+
+	// Apply the delta on top of our last state
+	switch(ucType)
+	{
+		case PLAYER_ENTITY:
+		{
+			if(!NetSync::ReadDelta(pBitStream, m_playerSync))
+				return false;
+
+			SetPosition(m_playerSync.vecPosition);
+			SetMoveSpeed(m_playerSync.vecMovementSpeed);
+			SetTurnSpeed(m_playerSync.vecTurnSpeed);
+			break;
+		}
+
+		case VEHICLE_ENTITY:
+		{
+			if(!NetSync::ReadDelta(pBitStream, m_vehicleSync))
+				return false;
+
+			SetPosition(m_vehicleSync.vecPosition);
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	m_eSyncType = (eEntityType)ucType;
+	m_usSyncSequence++;
+	return true;
+}
+
+void CPlayerEntity::WriteSync(RakNet::BitStream * pBitStream)
+{
+	pBitStream->Write((unsigned char)m_eSyncType);
+
+	if(m_eSyncType == PLAYER_ENTITY)
+		NetSync::Write(pBitStream, m_playerSync);
+	else if(m_eSyncType == VEHICLE_ENTITY)
+		NetSync::Write(pBitStream, m_vehicleSync);
 }
\ No newline at end of file
@@ -11,9 +11,19 @@
 #define CPlayerEntity_h
 
 #include "CNetworkEntity.h"
+#include <RakNet/BitStream.h>
 
 class CPlayerEntity : public CNetworkEntity {
 private:
+	// Latest sync received from the client
+	eEntityType						m_eSyncType;
+	sNetwork_Sync_Entity_Player		m_playerSync;
+	sNetwork_Sync_Entity_Vehicle	m_vehicleSync;
+
+	// Increased on every received sync, lets the relay skip unchanged players
+	unsigned short					m_usSyncSequence;
+
+	CString							m_strName;
 
 public:
 	CPlayerEntity();
@@ -21,6 +31,18 @@ public:
 
 	bool Create() {return true;}
 	bool Destroy() {return true;}
+
+	// Applies a (delta) sync packet from the client, returns false if it was malformed
+	bool							ReadSync(RakNet::BitStream * pBitStream);
+
+	// Writes the latest sync in its full quantized form
+	void							WriteSync(RakNet::BitStream * pBitStream);
+
+	bool							HasSync() { return (m_eSyncType != UNKNOWN_ENTITY); }
+	unsigned short					GetSyncSequence() { return m_usSyncSequence; }
+
+	void							SetName(const CString& strName) { m_strName = strName; }
+	const CString&					GetName() { return m_strName; }
 };
 
 #endif // CPlayerEntity_h
\ No newline at end of file
@@ -0,0 +1,240 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CStreamer.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CStreamer.h"
+#include <CServer.h>
+#include <algorithm>
+
+CStreamer::CStreamer(float fStreamDistance)
+{
+	m_fStreamDistance = fStreamDistance;
+
+	// Use the stream distance as cell size, so a query never touches more than 3x3 cells
+	for(int i = 0; i < STREAM_TYPE_MAX; i++)
+		m_grids[i].Init(m_fStreamDistance, m_fStreamDistance, STREAMER_WORLD_MIN, STREAMER_WORLD_MIN, STREAMER_WORLD_MAX, STREAMER_WORLD_MAX);
+
+	// Set the stream limits
+	m_usMaxStreamed[STREAM_TYPE_PLAYER] = MAX_STREAMED_PLAYERS;
+	m_usMaxStreamed[STREAM_TYPE_VEHICLE] = MAX_STREAMED_VEHICLES;
+	m_usMaxStreamed[STREAM_TYPE_OBJECT] = MAX_STREAMED_OBJECTS;
+	m_usMaxStreamed[STREAM_TYPE_PICKUP] = MAX_STREAMED_PICKUPS;
+	m_usMaxStreamed[STREAM_TYPE_CHECKPOINT] = MAX_STREAMED_CHECKPOINTS;
+	m_usMaxStreamed[STREAM_TYPE_LABEL] = MAX_STREAMED_LABELS;
+	m_usMaxStreamed[STREAM_TYPE_ACTOR] = MAX_STREAMED_ACTORS;
+}
+
+CStreamer::~CStreamer()
+{
+
+}
+
+template<class Manager>
+void CStreamer::FillGrid(eStreamType eType, Manager * pManager)
+{
+	GridSectorizer * pGrid = &m_grids[eType];
+	std::vector<unsigned int>& generations = m_generations[eType];
+	CVector3 vecPosition;
+
+	// Throw away the last state
+	pGrid->Clear();
+
+	if(generations.empty())
+		generations.resize(pManager->GetMax(), 0);
+
+	// Loop through all live entities
+	for(EntityId i = 0; i < pManager->GetCount(); ++i)
+	{
+		CNetworkEntity * pEntity = pManager->GetActiveAt(i);
+		EntityId entityId = pEntity->GetId();
+
+		// Was the id deleted and handed out again since the last update?
+		if(generations[entityId] != pManager->GetGeneration(entityId))
+		{
+			StreamOutEverywhere(eType, entityId);
+			generations[entityId] = pManager->GetGeneration(entityId);
+		}
+
+		pEntity->GetPosition(vecPosition);
+		pGrid->AddEntry(pEntity, (vecPosition.fX - STREAMER_ENTRY_EXTENT), (vecPosition.fY - STREAMER_ENTRY_EXTENT), (vecPosition.fX + STREAMER_ENTRY_EXTENT), (vecPosition.fY + STREAMER_ENTRY_EXTENT));
+	}
+}
+
+void CStreamer::Process()
+{
+	CServer * pServer = CServer::GetInstance();
+	CPlayerManager * pPlayerManager = pServer->GetPlayerManager();
+
+	// Forget the state of players which are gone, or left with their id taken by someone else
+	std::vector<unsigned int>& playerGenerations = m_generations[STREAM_TYPE_PLAYER];
+
+	for(EntityId playerId = 0; playerId < MAX_PLAYERS; ++playerId)
+	{
+		if(!pPlayerManager->Exists(playerId) || (!playerGenerations.empty() && playerGenerations[playerId] != pPlayerManager->GetGeneration(playerId)))
+			Reset(playerId);
+	}
+
+	// Rebuild the grids
+	FillGrid(STREAM_TYPE_PLAYER, pPlayerManager);
+	FillGrid(STREAM_TYPE_VEHICLE, pServer->GetVehicleManager());
+	FillGrid(STREAM_TYPE_OBJECT, pServer->GetObjectManager());
+	FillGrid(STREAM_TYPE_PICKUP, pServer->GetPickupManager());
+	FillGrid(STREAM_TYPE_CHECKPOINT, pServer->GetCheckpointManager());
+	FillGrid(STREAM_TYPE_LABEL, pServer->Get3DLabelManager());
+	FillGrid(STREAM_TYPE_ACTOR, pServer->GetActorManager());
+
+	// Update every player
+	for(EntityId i = 0; i < pPlayerManager->GetCount(); ++i)
+	{
+		CPlayerEntity * pPlayer = pPlayerManager->GetActiveAt(i);
+
+		for(int iType = 0; iType < STREAM_TYPE_MAX; iType++)
+			UpdatePlayer(pPlayer, (eStreamType)iType);
+	}
+}
+
+void CStreamer::UpdatePlayer(CNetworkEntity * pPlayer, eStreamType eType)
+{
+	EntityId playerId = pPlayer->GetId();
+	std::vector<EntityId>& streamed = m_streamed[playerId][eType];
+
+	CVector3 vecPlayerPosition;
+	pPlayer->GetPosition(vecPlayerPosition);
+
+	// Get all entities in the cells around the player
+	m_entries.Clear(true, _FILE_AND_LINE_);
+	m_grids[eType].GetEntries(m_entries, (vecPlayerPosition.fX - m_fStreamDistance), (vecPlayerPosition.fY - m_fStreamDistance), (vecPlayerPosition.fX + m_fStreamDistance), (vecPlayerPosition.fY + m_fStreamDistance));
+
+	// Collect the entities which are really in range
+	m_candidates.clear();
+
+	CVector3 vecPosition;
+
+	for(unsigned int i = 0; i < m_entries.Size(); i++)
+	{
+		CNetworkEntity * pEntity = (CNetworkEntity *)m_entries[i];
+
+		// Never stream a player to himself
+		if(pEntity == pPlayer)
+			continue;
+
+		pEntity->GetPosition(vecPosition);
+
+		StreamCandidate candidate;
+		candidate.fDistance = (vecPosition - vecPlayerPosition).Length();
+
+		if(candidate.fDistance > m_fStreamDistance)
+			continue;
+
+		candidate.entityId = pEntity->GetId();
+		candidate.pEntity = pEntity;
+		m_candidates.push_back(candidate);
+	}
+
+	// Entities on a cell border are in several cells, they must neither take more than one slot nor get streamed in twice
+	std::sort(m_candidates.begin(), m_candidates.end(), [](const StreamCandidate& a, const StreamCandidate& b) { return (a.entityId < b.entityId); });
+	m_candidates.erase(std::unique(m_candidates.begin(), m_candidates.end(), [](const StreamCandidate& a, const StreamCandidate& b) { return (a.entityId == b.entityId); }), m_candidates.end());
+
+	// Only keep the closest ones if we're over the limit
+	if(m_candidates.size() > m_usMaxStreamed[eType])
+	{
+		std::nth_element(m_candidates.begin(), (m_candidates.begin() + m_usMaxStreamed[eType]), m_candidates.end());
+		m_candidates.resize(m_usMaxStreamed[eType]);
+	}
+
+	// Build the new sorted set
+	m_newStreamed.clear();
+
+	for(size_t i = 0; i < m_candidates.size(); i++)
+		m_newStreamed.push_back(m_candidates[i].entityId);
+
+	std::sort(m_newStreamed.begin(), m_newStreamed.end());
+
+	// Stream out everything which isn't in the new set anymore
+	std::vector<EntityId>::iterator itNew = m_newStreamed.begin();
+
+	for(std::vector<EntityId>::iterator it = streamed.begin(); it != streamed.end(); ++it)
+	{
+		while(itNew != m_newStreamed.end() && *itNew < *it)
+			++itNew;
+
+		if(itNew == m_newStreamed.end() || *itNew != *it)
+			SendStreamOut(playerId, eType, *it);
+	}
+
+	// Stream in everything which is new
+	for(size_t i = 0; i < m_candidates.size(); i++)
+	{
+		if(!std::binary_search(streamed.begin(), streamed.end(), m_candidates[i].entityId))
+			SendStreamIn(playerId, eType, m_candidates[i].pEntity);
+	}
+
+	// Remember the new state
+	streamed.swap(m_newStreamed);
+}
+
+void CStreamer::StreamOutEverywhere(eStreamType eType, EntityId entityId)
+{
+	for(EntityId playerId = 0; playerId < MAX_PLAYERS; ++playerId)
+	{
+		std::vector<EntityId>& streamed = m_streamed[playerId][eType];
+		std::vector<EntityId>::iterator it = std::lower_bound(streamed.begin(), streamed.end(), entityId);
+
+		if(it != streamed.end() && *it == entityId)
+		{
+			SendStreamOut(playerId, eType, entityId);
+			streamed.erase(it);
+		}
+	}
+}
+
+void CStreamer::SendStreamIn(EntityId playerId, eStreamType eType, CNetworkEntity * pEntity)
+{
+	CVector3 vecPosition;
+	pEntity->GetPosition(vecPosition);
+
+	// Construct the bitstream
+	RakNet::BitStream bitStream;
+	bitStream.Write((unsigned char)eType);
+	bitStream.WriteCompressed(pEntity->GetId());
+	bitStream.Write(vecPosition.fX);
+	bitStream.Write(vecPosition.fY);
+	bitStream.Write(vecPosition.fZ);
+
+	// Send it to the player
+	CServer::GetInstance()->GetNetworkModule()->Call(RPC_ENTITY_STREAM_IN, &bitStream, HIGH_PRIORITY, RELIABLE_ORDERED, playerId, false);
+}
+
+void CStreamer::SendStreamOut(EntityId playerId, eStreamType eType, EntityId entityId)
+{
+	// Construct the bitstream
+	RakNet::BitStream bitStream;
+	bitStream.Write((unsigned char)eType);
+	bitStream.WriteCompressed(entityId);
+
+	// Send it to the player
+	CServer::GetInstance()->GetNetworkModule()->Call(RPC_ENTITY_STREAM_OUT, &bitStream, HIGH_PRIORITY, RELIABLE_ORDERED, playerId, false);
+}
+
+void CStreamer::Reset(EntityId playerId)
+{
+	if(playerId >= MAX_PLAYERS)
+		return;
+
+	for(int i = 0; i < STREAM_TYPE_MAX; i++)
+		m_streamed[playerId][i].clear();
+}
+
+bool CStreamer::IsStreamedIn(EntityId playerId, eStreamType eType, EntityId entityId)
+{
+	if(playerId >= MAX_PLAYERS || eType >= STREAM_TYPE_MAX)
+		return false;
+
+	std::vector<EntityId>& streamed = m_streamed[playerId][eType];
+	return std::binary_search(streamed.begin(), streamed.end(), entityId);
+}
@@ -0,0 +1,94 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CStreamer.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CStreamer_h
+#define CStreamer_h
+
+#include <Common.h>
+#include <RakNet/GridSectorizer.h>
+#include "CNetworkEntity.h"
+#include <vector>
+
+// World bounds covered by the streamer grid, entities outside get clamped to the border cells
+#define STREAMER_WORLD_MIN -8192.0f
+#define STREAMER_WORLD_MAX 8192.0f
+
+// Half size of the box entities get inserted into the grid with, it doesn't take empty boxes
+#define STREAMER_ENTRY_EXTENT 0.01f
+
+enum eStreamType
+{
+	STREAM_TYPE_PLAYER,
+	STREAM_TYPE_VEHICLE,
+	STREAM_TYPE_OBJECT,
+	STREAM_TYPE_PICKUP,
+	STREAM_TYPE_CHECKPOINT,
+	STREAM_TYPE_LABEL,
+	STREAM_TYPE_ACTOR,
+	STREAM_TYPE_MAX,
+};
+
+class CStreamer {
+
+private:
+	struct StreamCandidate
+	{
+		EntityId			entityId;
+		float				fDistance;
+		CNetworkEntity		* pEntity;
+
+		bool operator < (const StreamCandidate& right) const { return fDistance < right.fDistance; }
+	};
+
+	float					m_fStreamDistance;
+
+	// One grid per entity type, rebuilt every tick from the live entities
+	GridSectorizer			m_grids[STREAM_TYPE_MAX];
+	EntityId				m_usMaxStreamed[STREAM_TYPE_MAX];
+
+	// Sorted ids of the entities every player currently has streamed in
+	std::vector<EntityId>	m_streamed[MAX_PLAYERS][STREAM_TYPE_MAX];
+
+	// Generation of every id when we last saw it, a changed one means the id got reused
+	std::vector<unsigned int>	m_generations[STREAM_TYPE_MAX];
+
+	// Scratch buffers reused between updates
+	DataStructures::List<void *>	m_entries;
+	std::vector<StreamCandidate>	m_candidates;
+	std::vector<EntityId>			m_newStreamed;
+
+	template<class Manager>
+	void					FillGrid(eStreamType eType, Manager * pManager);
+
+	void					UpdatePlayer(CNetworkEntity * pPlayer, eStreamType eType);
+
+	// Streams the old entity of a reused id out for everyone, the new one gets streamed in as usual
+	void					StreamOutEverywhere(eStreamType eType, EntityId entityId);
+
+	void					SendStreamIn(EntityId playerId, eStreamType eType, CNetworkEntity * pEntity);
+	void					SendStreamOut(EntityId playerId, eStreamType eType, EntityId entityId);
+
+public:
+	CStreamer(float fStreamDistance);
+	~CStreamer();
+
+	void					Process();
+
+	// Forgets everything streamed to a player (e.g. after a disconnect)
+	void					Reset(EntityId playerId);
+
+	bool					IsStreamedIn(EntityId playerId, eStreamType eType, EntityId entityId);
+
+	// Sorted ids of everything of the given type a player has streamed in
+	const std::vector<EntityId>& GetStreamed(EntityId playerId, eStreamType eType) { return m_streamed[playerId][eType]; }
+
+	float					GetStreamDistance() { return m_fStreamDistance; }
+};
+
+#endif // CStreamer_h
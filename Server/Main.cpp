@@ -46,6 +46,9 @@ int main(int argc, char ** argv)
 	while(!g_bClose)
 	{
 		pServer->Process();
+
+		// Run the console commands which have to run on this thread
+		CInput::Process();
 	}
 
 	// Stop the input thread
@@ -57,6 +60,9 @@ int main(int argc, char ** argv)
 	// Delete our server
 	SAFE_DELETE(pServer);
 
+	// Write the queued log messages
+	CLogFile::Close();
+
 	// Exit process
 	ExitProcess(EXIT_SUCCESS);
 }
\ No newline at end of file
@@ -10,11 +10,13 @@
 #include "CNetworkModule.h"
 
 #include <CServer.h>
+#include <CQueryServer.h>
 #include <CSettings.h>
 #include <CLogFile.h>
 #include "CNetworkRPC.h"
 
 RakNet::RPC4			* CNetworkModule::m_pRPC = NULL;
+CRPCRegistry			* CNetworkModule::m_pRPCRegistry = NULL;
 
 CNetworkModule::CNetworkModule(void)
 {
@@ -27,8 +29,11 @@ CNetworkModule::CNetworkModule(void)
 	// Attact RPC4 to RakPeerInterface
 	m_pRakPeer->AttachPlugin(m_pRPC);
 
+	// Create the rpc registry
+	m_pRPCRegistry = new CRPCRegistry(m_pRPC);
+
 	// Register the RPC's
-	CNetworkRPC::Register(m_pRPC);
+	CNetworkRPC::Register(m_pRPCRegistry);
 
 	// Set the network state
 	SetNetworkState(NETSTATE_NONE);
@@ -36,11 +41,17 @@ CNetworkModule::CNetworkModule(void)
 
 CNetworkModule::~CNetworkModule(void)
 {
+	// Stop listening for password changes
+	CSettings::RemoveChangeHandler("password", PasswordChanged, this);
+
 	// Shutdown RakNet
 	m_pRakPeer->Shutdown(500);
 
 	// Unregister the RPC's
-	CNetworkRPC::Unregister(m_pRPC);
+	CNetworkRPC::Unregister(m_pRPCRegistry);
+
+	// Delete the rpc registry
+	SAFE_DELETE(m_pRPCRegistry);
 
 	// Detach RPC4 from RakPeerInterface
 	m_pRakPeer->DetachPlugin(m_pRPC);
@@ -66,21 +77,28 @@ bool CNetworkModule::Startup(void)
 		// Set the maximum incoming connections
 		m_pRakPeer->SetMaximumIncomingConnections(CVAR_GET_INTEGER("maxplayers"));
 
-		// Get the password string
-		CString strPassword = CVAR_GET_STRING("password");
+		// Set the server password
+		PasswordChanged("password", this);
 
-		// Do we have a password?
-		if(strPassword.GetLength() > 0)
-		{
-			// Set the server password
-			m_pRakPeer->SetIncomingPassword(strPassword.Get(), strPassword.GetLength());
-		}
+		// Keep the password up to date if it gets changed later on
+		CSettings::AddChangeHandler("password", PasswordChanged, this);
 	}
 
 	// Return
 	return bReturn;
 }
 
+void CNetworkModule::PasswordChanged(const CString& strSetting, void * pUserData)
+{
+	CNetworkModule * pNetworkModule = (CNetworkModule *)pUserData;
+
+	// Get the password string
+	CString strPassword = CVAR_GET_STRING(strSetting);
+
+	// Set the server password, an empty one removes it
+	pNetworkModule->m_pRakPeer->SetIncomingPassword(strPassword.Get(), strPassword.GetLength());
+}
+
 void CNetworkModule::Pulse(void)
 {
 	// Update the network
@@ -93,6 +111,12 @@ void CNetworkModule::Call(const char * szIdentifier, RakNet::BitStream * pBitStr
 	m_pRPC->Call(szIdentifier, pBitStream, priority, reliability, 0, (playerId != INVALID_ENTITY_ID ? m_pRakPeer->GetSystemAddressFromIndex(playerId) : RakNet::UNASSIGNED_SYSTEM_ADDRESS), bBroadCast);
 }
 
+void CNetworkModule::Call(eRPCIdentifier rpcId, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, EntityId playerId, bool bBroadCast)
+{
+	// Send it with the numeric id
+	CRPCRegistry::Call(m_pRakPeer, rpcId, pBitStream, priority, reliability, 0, (playerId != INVALID_ENTITY_ID ? m_pRakPeer->GetSystemAddressFromIndex(playerId) : RakNet::UNASSIGNED_SYSTEM_ADDRESS), bBroadCast);
+}
+
 int CNetworkModule::GetPlayerPing(EntityId playerId)
 {
 	return m_pRakPeer->GetLastPing(m_pRakPeer->GetSystemAddressFromIndex(playerId));
@@ -108,9 +132,16 @@ void CNetworkModule::UpdateNetwork(void)
 	{
 		switch(pPacket->data[0])
 		{
+			case ID_NUMERIC_RPC:
+			{
+				// Pass it to the rpc registry
+				m_pRPCRegistry->Process(pPacket);
+				break;
+			}
+
 			case ID_NEW_INCOMING_CONNECTION:
 			{
-				CLogFile::Printf("[network] Incoming connection from %s.", pPacket->systemAddress.ToString(true, ':'));
+				CLogFile::Logf(LOG_CATEGORY_NETWORK, LOG_LEVEL_INFO, "[network] Incoming connection from %s.", pPacket->systemAddress.ToString(true, ':'));
 				break;
 			}
 
@@ -121,6 +152,7 @@ void CNetworkModule::UpdateNetwork(void)
 				{
 					// Delete the player from the manager
 					CServer::GetInstance()->GetPlayerManager()->Delete((EntityId)pPacket->systemAddress.systemIndex);
+					CServer::GetInstance()->GetQueryServer()->Invalidate();
 				}
 				break;
 			}
@@ -132,6 +164,7 @@ void CNetworkModule::UpdateNetwork(void)
 				{
 					// Delete the player from the manager
 					CServer::GetInstance()->GetPlayerManager()->Delete((EntityId)pPacket->systemAddress.systemIndex);
+					CServer::GetInstance()->GetQueryServer()->Invalidate();
 				}
 				break;
 			}
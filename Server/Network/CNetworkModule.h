@@ -11,6 +11,7 @@
 #define CNetworkModule_h
 
 #include "../../Network/Core/NetCommon.h"
+#include "../../Network/Core/CRPCRegistry.hpp"
 
 //// OS Dependant includes
 //#ifdef _WIN32
@@ -32,11 +33,14 @@ private:
 
 	RakNet::RakPeerInterface				* m_pRakPeer;
 	static RakNet::RPC4						* m_pRPC;
+	static CRPCRegistry						* m_pRPCRegistry;
 
 	eNetworkState							m_eNetworkState;
 
 	void									UpdateNetwork( void );
 
+	static void								PasswordChanged( const CString& strSetting, void * pUserData );
+
 public:
 
 	CNetworkModule( void );
@@ -50,10 +54,15 @@ public:
 	void									Pulse( void );
 
 	void									Call( const char * szIdentifier, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, EntityId playerId, bool bBroadCast );
+	void									Call( eRPCIdentifier rpcId, RakNet::BitStream * pBitStream, PacketPriority priority, PacketReliability reliability, EntityId playerId, bool bBroadCast );
 	int										GetPlayerPing( EntityId playerId );
 
+	// Event which gets signaled from the RakNet update thread as soon as a packet was queued
+	void									SetWakeEvent( RakNet::SignaledEvent * pWakeEvent ) { m_pRakPeer->SetIncomingPacketEvent( pWakeEvent ); }
+
 	RakNet::RakPeerInterface				* GetRakPeer( void ) { return m_pRakPeer; }
 	static RakNet::RPC4						* GetRPC( void ) { return m_pRPC; }
+	static CRPCRegistry						* GetRPCRegistry( void ) { return m_pRPCRegistry; }
 
 };
 
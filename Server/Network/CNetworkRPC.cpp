@@ -13,10 +13,10 @@
 
 #include <CLogFile.h>
 #include <CServer.h>
+#include <CQueryServer.h>
 #include <Scripting/CEvents.h>
 #include <CSettings.h>
-
-#define GET_RPC_CODEX(x) CString("IVMP0xF%dF", int(x)).Get()
+#include <map>
 
 extern CServer * g_pServer;
 
@@ -25,6 +25,11 @@ RakNet::BitStream		bsReject;
 
 void InitialData(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
 {
+	// Resolve the settings we send to every new player once
+	static CSetting<CString> hostName("hostname");
+	static CSetting<int> maxPlayers("maxplayers");
+	static CSetting<int> httpPort("httpport");
+
 	// Get the playerid
 	EntityId playerId = (EntityId)pPacket->guid.systemIndex;
 
@@ -57,8 +62,16 @@ void InitialData(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
 	// Add the player to the manager
 	// TODO: add to player manager
 	CPlayerEntity * pPlayer = new CPlayerEntity();
-	// Do we need the id; maybe internal for easier sync but definetly not public to the scripting engine
-	pPlayer->SetId(CServer::GetInstance()->GetPlayerManager()->Add(pPlayer));
+	// Use the network index as id, so incoming sync can be matched to the player directly
+	pPlayer->SetId(playerId);
+	pPlayer->SetName(strName);
+	CServer::GetInstance()->GetPlayerManager()->Add(playerId, pPlayer);
+
+	// The server browser should see the new player
+	CServer::GetInstance()->GetQueryServer()->Invalidate();
+
+	// Make sure the new player gets a full snapshot
+	CServer::GetInstance()->GetSyncRelay()->Reset(playerId);
 
 	// Add everyone else connected for this player
 	// TODO: handle client join
@@ -76,34 +89,142 @@ void InitialData(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
 	//bitStream.Write(pCore->GetPlayerManager()->Get(playerId)->GetColour());
 
 	// Write the server name
-	bitStream.Write(RakNet::RakString(CVAR_GET_STRING("hostname").Get()));
+	bitStream.Write(RakNet::RakString(hostName.Get().Get()));
 
 	// Write the max player count
-	bitStream.Write(CVAR_GET_INTEGER("maxplayers"));
+	bitStream.Write(maxPlayers.Get());
 
 	// Write the file transfer port
-	bitStream.Write(CVAR_GET_INTEGER("httpport"));
+	bitStream.Write(httpPort.Get());
 
 	// Send it back to the player
-	CServer::GetInstance()->GetNetworkModule()->Call(GET_RPC_CODEX(RPC_INITIAL_DATA), &bitStream, HIGH_PRIORITY, RELIABLE, playerId, false);
+	CServer::GetInstance()->GetNetworkModule()->Call(RPC_INITIAL_DATA, &bitStream, HIGH_PRIORITY, RELIABLE, playerId, false);
+}
+
+void SyncPackage(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
+{
+	// Get the player
+	CPlayerEntity * pPlayer = CServer::GetInstance()->GetPlayerManager()->GetAt((EntityId)pPacket->guid.systemIndex);
+
+	// Ignore sync from players which didn't finish joining
+	if(!pPlayer)
+		return;
+
+	// Store the latest sync, the sync relay sends it to everyone who has the player streamed in
+	if(!pPlayer->ReadSync(pBitStream))
+		CLogFile::Logf(LOG_CATEGORY_NETWORK, LOG_LEVEL_WARNING, "[network] Dropped malformed sync package from player %d.", pPlayer->GetId());
 }
 
-void CNetworkRPC::Register(RakNet::RPC4 * pRPC)
+void ResourceSync(RakNet::BitStream * pBitStream, RakNet::Packet * pPacket)
+{
+	// Get the player
+	EntityId playerId = (EntityId)pPacket->guid.systemIndex;
+
+	// Ignore requests from players which didn't finish joining
+	if(!CServer::GetInstance()->GetPlayerManager()->GetAt(playerId))
+		return;
+
+	// Read the files the player has cached, as "<resource>/<file>" and checksum
+	unsigned short usCached;
+	if(!pBitStream->Read(usCached) || usCached > RESOURCE_SYNC_MAX_CACHED)
+		return;
+
+	std::map<CString, unsigned int> cached;
+	for(unsigned short i = 0; i < usCached; i++)
+	{
+		RakNet::RakString _strFile;
+		unsigned int uiChecksum;
+
+		if(!pBitStream->Read(_strFile) || !pBitStream->Read(uiChecksum))
+			return;
+
+		cached[CString(_strFile.C_String())] = uiChecksum;
+	}
+
+	// Construct a new bitstream
+	RakNet::BitStream bitStream;
+	unsigned short usResources = 0;
+	unsigned int uiOutdated = 0;
+	RakNet::BitStream files;
+
+	// Write the client files of every running resource, the player only downloads the outdated ones
+	for(auto pResource : CServer::GetInstance()->GetResourceManager()->GetResources())
+	{
+		if(!pResource->IsActive())
+			continue;
+
+		RakNet::BitStream resourceFiles;
+		unsigned short usFiles = 0;
+
+		for(auto pResourceFile : *pResource->GetResourceFiles())
+		{
+			if(pResourceFile->GetType() != CResourceFile::RESOURCE_FILE_TYPE_CLIENT_SCRIPT && pResourceFile->GetType() != CResourceFile::RESOURCE_FILE_TYPE_CLIENT_FILE)
+				continue;
+
+			// Hashed when the resource started, files which couldn't be read are skipped
+			unsigned int uiChecksum;
+			long long llSize;
+			if(!pResourceFile->GetChecksum(uiChecksum, llSize))
+				continue;
+
+			auto it = cached.find(pResource->GetName() + "/" + pResourceFile->GetName());
+			bool bUpToDate = (it != cached.end() && it->second == uiChecksum);
+
+			resourceFiles.Write(RakNet::RakString(pResourceFile->GetName()));
+			resourceFiles.Write((unsigned int)llSize);
+			resourceFiles.Write(uiChecksum);
+			resourceFiles.Write(bUpToDate);
+			usFiles++;
+
+			if(!bUpToDate)
+				uiOutdated++;
+		}
+
+		if(usFiles == 0)
+			continue;
+
+		files.Write(RakNet::RakString(pResource->GetName().Get()));
+		files.Write(usFiles);
+		files.Write(&resourceFiles);
+		usResources++;
+	}
+
+	// Write the resource count followed by the resources
+	bitStream.Write(usResources);
+	bitStream.Write(&files);
+
+	CLogFile::Logf(LOG_CATEGORY_NETWORK, LOG_LEVEL_DEBUG, "Player %d has to download %d client files.", playerId, uiOutdated);
+
+	// Send it back to the player
+	CServer::GetInstance()->GetNetworkModule()->Call(RPC_RESOURCE_MANIFEST, &bitStream, HIGH_PRIORITY, RELIABLE_ORDERED, playerId, false);
+}
+
+void CNetworkRPC::Register(CRPCRegistry * pRegistry)
 {
 	// Are we already registered?
 	if(m_bRegistered)
 		return;
 
 	// Default rpcs
-	pRPC->RegisterFunction(GET_RPC_CODEX(RPC_INITIAL_DATA), InitialData);
+	pRegistry->Register(RPC_INITIAL_DATA, InitialData);
+	pRegistry->Register(RPC_SYNC_PACKAGE, SyncPackage);
+	pRegistry->Register(RPC_RESOURCE_SYNC, ResourceSync);
+
+	// Mark as registered
+	m_bRegistered = true;
 }
 
-void CNetworkRPC::Unregister(RakNet::RPC4 * pRPC)
+void CNetworkRPC::Unregister(CRPCRegistry * pRegistry)
 {
 	// Are we not registered?
 	if(!m_bRegistered)
 		return;
 
 	// Default rpcs
-	pRPC->UnregisterFunction(GET_RPC_CODEX(RPC_INITIAL_DATA));
+	pRegistry->Unregister(RPC_INITIAL_DATA);
+	pRegistry->Unregister(RPC_SYNC_PACKAGE);
+	pRegistry->Unregister(RPC_RESOURCE_SYNC);
+
+	// Mark as not registered
+	m_bRegistered = false;
 }
\ No newline at end of file
@@ -11,6 +11,10 @@
 #define CNetworkRPC_h
 
 #include "../../Network/Core/NetCommon.h"
+#include "../../Network/Core/CRPCRegistry.hpp"
+
+// Most cached files a player can report in a resource sync request
+#define RESOURCE_SYNC_MAX_CACHED		4096
 
 class CNetworkRPC
 {
@@ -21,8 +25,8 @@ private:
 
 public:
 
-	static	void		Register(RakNet::RPC4 * pRPC);
-	static	void		Unregister(RakNet::RPC4 * pRPC);
+	static	void		Register(CRPCRegistry * pRegistry);
+	static	void		Unregister(CRPCRegistry * pRegistry);
 
 };
 
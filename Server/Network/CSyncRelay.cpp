@@ -0,0 +1,136 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CSyncRelay.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CSyncRelay.h"
+#include <CServer.h>
+
+CSyncRelay::CSyncRelay()
+{
+	m_ulTick = 0;
+	m_usEntryCount = 0;
+	m_ucPart = 0;
+
+	for(EntityId i = 0; i < MAX_PLAYERS; ++i)
+		Reset(i);
+}
+
+CSyncRelay::~CSyncRelay()
+{
+
+}
+
+unsigned long CSyncRelay::GetInterval(float fDistance, float fStreamDistance)
+{
+	if(fDistance <= (fStreamDistance * SYNC_RELAY_NEAR_RANGE))
+		return SYNC_RELAY_NEAR_INTERVAL;
+
+	if(fDistance <= (fStreamDistance * SYNC_RELAY_MID_RANGE))
+		return SYNC_RELAY_MID_INTERVAL;
+
+	return SYNC_RELAY_FAR_INTERVAL;
+}
+
+void CSyncRelay::FlushSnapshot(EntityId recipientId)
+{
+	// Nothing to send?
+	if(m_usEntryCount == 0)
+		return;
+
+	// Write the snapshot id, the part index and the entry count in front of the entries
+	m_snapshot.Reset();
+	m_snapshot.Write((unsigned short)m_ulTick);
+	m_snapshot.Write(m_ucPart);
+	m_snapshot.WriteCompressed(m_usEntryCount);
+	m_snapshot.Write(&m_entries);
+
+	// Parts of one snapshot carry different players, sequencing would drop every part which arrives after a later one
+	CServer::GetInstance()->GetNetworkModule()->Call(RPC_SYNC_SNAPSHOT, &m_snapshot, HIGH_PRIORITY, UNRELIABLE, recipientId, false);
+
+	m_entries.Reset();
+	m_usEntryCount = 0;
+	m_ucPart++;
+}
+
+void CSyncRelay::Process()
+{
+	CServer * pServer = CServer::GetInstance();
+	CPlayerManager * pPlayerManager = pServer->GetPlayerManager();
+	CStreamer * pStreamer = pServer->GetStreamer();
+	float fStreamDistance = pStreamer->GetStreamDistance();
+
+	m_ulTick++;
+
+	CVector3 vecRecipientPosition;
+	CVector3 vecPosition;
+
+	// Build one snapshot for every player
+	for(EntityId i = 0; i < pPlayerManager->GetCount(); ++i)
+	{
+		CPlayerEntity * pRecipient = pPlayerManager->GetActiveAt(i);
+		EntityId recipientId = pRecipient->GetId();
+
+		pRecipient->GetPosition(vecRecipientPosition);
+
+		// Every recipient gets its own snapshot
+		m_ucPart = 0;
+
+		// Only players which are streamed in for the recipient are of interest
+		const std::vector<EntityId>& streamed = pStreamer->GetStreamed(recipientId, STREAM_TYPE_PLAYER);
+
+		for(size_t j = 0; j < streamed.size(); j++)
+		{
+			EntityId playerId = streamed[j];
+			CPlayerEntity * pPlayer = pPlayerManager->GetAt(playerId);
+
+			if(!pPlayer || !pPlayer->HasSync())
+				continue;
+
+			unsigned long ulTicksSinceSent = (m_ulTick - m_ulSentTick[recipientId][playerId]);
+
+			// Skip players which didn't send anything new since the last snapshot
+			if(m_usSentSequence[recipientId][playerId] == pPlayer->GetSyncSequence() && ulTicksSinceSent < SYNC_RELAY_IDLE_INTERVAL)
+				continue;
+
+			// Send players far away less often
+			pPlayer->GetPosition(vecPosition);
+
+			if(ulTicksSinceSent < GetInterval((vecPosition - vecRecipientPosition).Length(), fStreamDistance))
+				continue;
+
+			// Write the entry
+			m_entries.WriteCompressed(playerId);
+			pPlayer->WriteSync(&m_entries);
+			m_usEntryCount++;
+
+			m_usSentSequence[recipientId][playerId] = pPlayer->GetSyncSequence();
+			m_ulSentTick[recipientId][playerId] = m_ulTick;
+
+			// Is the snapshot full?
+			if(m_entries.GetNumberOfBytesUsed() >= SYNC_RELAY_MAX_SNAPSHOT_BYTES)
+				FlushSnapshot(recipientId);
+		}
+
+		FlushSnapshot(recipientId);
+	}
+}
+
+void CSyncRelay::Reset(EntityId playerId)
+{
+	if(playerId >= MAX_PLAYERS)
+		return;
+
+	// Make sure the state of this player gets sent again and he gets everyone else again
+	for(EntityId i = 0; i < MAX_PLAYERS; ++i)
+	{
+		m_usSentSequence[playerId][i] = 0;
+		m_ulSentTick[playerId][i] = 0;
+		m_usSentSequence[i][playerId] = 0;
+		m_ulSentTick[i][playerId] = 0;
+	}
+}
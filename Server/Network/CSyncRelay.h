@@ -0,0 +1,63 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CSyncRelay.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CSyncRelay_h
+#define CSyncRelay_h
+
+#include <Common.h>
+#include <RakNet/BitStream.h>
+
+// Players within this fraction of the stream distance are sent every tick,
+// the next band every second tick and everything further away every fourth tick
+#define SYNC_RELAY_NEAR_RANGE			0.25f
+#define SYNC_RELAY_MID_RANGE			0.5f
+#define SYNC_RELAY_NEAR_INTERVAL		1
+#define SYNC_RELAY_MID_INTERVAL			2
+#define SYNC_RELAY_FAR_INTERVAL			4
+
+// Players which didn't change are still resent after this many ticks, so a lost snapshot can't leave them stale
+#define SYNC_RELAY_IDLE_INTERVAL		50
+
+// Start a new snapshot packet before we exceed the usual MTU. Every part starts with the snapshot id (the tick)
+// and its part index and is sent unreliable, a client applies an entry if it's newer than the last one it has of that player
+#define SYNC_RELAY_MAX_SNAPSHOT_BYTES	1200
+
+class CPlayerEntity;
+
+class CSyncRelay {
+
+private:
+	unsigned long			m_ulTick;
+
+	// Last sync sequence of every player sent to every recipient, and the tick it was sent in
+	unsigned short			m_usSentSequence[MAX_PLAYERS][MAX_PLAYERS];
+	unsigned long			m_ulSentTick[MAX_PLAYERS][MAX_PLAYERS];
+
+	// Snapshot which is currently being built
+	RakNet::BitStream		m_snapshot;
+	RakNet::BitStream		m_entries;
+	unsigned short			m_usEntryCount;
+	unsigned char			m_ucPart;
+
+	unsigned long			GetInterval(float fDistance, float fStreamDistance);
+
+	void					FlushSnapshot(EntityId recipientId);
+
+public:
+	CSyncRelay();
+	~CSyncRelay();
+
+	// Builds and sends one snapshot per recipient
+	void					Process();
+
+	// Forgets what was sent to/about a player, so the next snapshot contains everything
+	void					Reset(EntityId playerId);
+};
+
+#endif // CSyncRelay_h
@@ -0,0 +1,117 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CDatabaseNatives.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CDatabaseNatives.h"
+#include <Scripting/ResourceSystem/CResourceManager.h>
+#include <Scripting/CEventHandler.h>
+#include <CDatabaseManager.h>
+
+void CDatabaseNatives::Register(CScriptVM* pVM)
+{
+	pVM->RegisterFunction("sqliteOpen", Open);
+	pVM->RegisterFunction("sqliteQuery", Query);
+	pVM->RegisterFunction("sqliteClose", Close);
+}
+
+// sqliteOpen(fileName), the file is relative to the resource directory
+int CDatabaseNatives::Open(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	CString strFileName;
+	pVM->Pop(strFileName);
+	pVM->ResetStackIndex();
+
+	// Don't let scripts leave their resource directory
+	if(strFileName.IsEmpty() || strFileName.Find("..") != std::string::npos)
+	{
+		pVM->Push(false);
+		return 1;
+	}
+
+	CString strPath("%s/%s", pResource->GetResourceDirectoryPath().Get(), strFileName.Get());
+	pVM->Push((int)CDatabaseManager::GetInstance()->Open(pResource, strPath));
+	return 1;
+}
+
+// sqliteQuery(database, query, callback, ...), the arguments after the callback are bound to the ?s of the query.
+// The callback gets the rows as an array of tables, the changed row count and the last insert id, or false and the error message
+int CDatabaseNatives::Query(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	int iDatabaseId;
+	CString strQuery;
+	pVM->Pop(iDatabaseId);
+	pVM->Pop(strQuery);
+	pVM->ResetStackIndex();
+
+	// Get the callback, it may be null if the result isn't needed
+	int ref = -1;
+	SQObjectPtr pFunction;
+	bool bHasCallback = false;
+	int iCallbackIndex;
+
+	if(pVM->GetVMType() == LUA_VM)
+	{
+		iCallbackIndex = 3;
+
+		if(lua_isfunction((lua_State*)VM, iCallbackIndex))
+		{
+			lua_pushvalue((lua_State*)VM, iCallbackIndex);
+			ref = luaL_ref((lua_State*)VM, LUA_REGISTRYINDEX);
+			bHasCallback = true;
+		}
+		else if(!lua_isnil((lua_State*)VM, iCallbackIndex))
+		{
+			pVM->Push(false);
+			return 1;
+		}
+	} else {
+		iCallbackIndex = 4;
+
+		if(sq_gettype((SQVM*)VM, iCallbackIndex) == OT_CLOSURE || sq_gettype((SQVM*)VM, iCallbackIndex) == OT_NATIVECLOSURE)
+		{
+			pFunction = stack_get((SQVM*)VM, iCallbackIndex);
+			bHasCallback = true;
+		}
+		else if(sq_gettype((SQVM*)VM, iCallbackIndex) != OT_NULL)
+		{
+			pVM->Push(false);
+			return 1;
+		}
+	}
+
+	// Everything after the callback is a parameter
+	CScriptArguments parameters;
+
+	for(int i = (iCallbackIndex + 1); i <= pVM->GetArgumentCount(); i++)
+	{
+		CScriptArgument parameter;
+		parameter.pushFromStack(pVM, i);
+		parameters.push(parameter);
+	}
+
+	CEventHandler * pHandler = (bHasCallback ? new CEventHandler(pVM, ref, pFunction, CEventHandler::RESOURCE_EVENT) : NULL);
+	pVM->Push(CDatabaseManager::GetInstance()->Query(pResource, (DatabaseId)iDatabaseId, pHandler, strQuery, parameters));
+	return 1;
+}
+
+// sqliteClose(database)
+int CDatabaseNatives::Close(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	int iDatabaseId;
+	pVM->Pop(iDatabaseId);
+	pVM->ResetStackIndex();
+
+	pVM->Push(CDatabaseManager::GetInstance()->Close(pResource, (DatabaseId)iDatabaseId));
+	return 1;
+}
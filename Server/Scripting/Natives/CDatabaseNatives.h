@@ -0,0 +1,25 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CDatabaseNatives.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CDatabaseNatives_h
+#define CDatabaseNatives_h
+
+#include <Scripting/CScriptVM.h>
+
+class CDatabaseNatives {
+
+private:
+	static int	Open(int * pVM);
+	static int	Query(int * pVM);
+	static int	Close(int * pVM);
+public:
+	static void Register(CScriptVM* pVM);
+};
+
+#endif // CDatabaseNatives_h
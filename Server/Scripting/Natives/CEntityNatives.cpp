@@ -10,6 +10,7 @@
 #include "CEntityNatives.h"
 #include <Scripting/CLuaVM.h>
 #include <Scripting/CSquirrelVM.h>
+#include <Scripting/CScriptBinding.h>
 #include <CLogFile.h>
 #include <Scripting/ResourceSystem/CResourceManager.h>
 
@@ -17,131 +18,74 @@
 
 void CEntityNatives::Register(CScriptVM* pVM)
 {
-	pVM->RegisterClassFunction("setPosition", SetPosition);
-	pVM->RegisterClassFunction("getPosition", GetPosition);
+	pVM->RegisterClassFunction("setPosition", BIND_NATIVE(pVM, SetPosition));
+	pVM->RegisterClassFunction("getPosition", BIND_NATIVE(pVM, GetPosition));
 
-	pVM->RegisterClassFunction("setRotation", SetRotation);
-	pVM->RegisterClassFunction("getRotation", GetRotation);
+	pVM->RegisterClassFunction("setRotation", BIND_NATIVE(pVM, SetRotation));
+	pVM->RegisterClassFunction("getRotation", BIND_NATIVE(pVM, GetRotation));
 
-	pVM->RegisterClassFunction("setMoveSpeed", SetMoveSpeed);
-	pVM->RegisterClassFunction("getMoveSpeed", GetMoveSpeed);
+	pVM->RegisterClassFunction("setMoveSpeed", BIND_NATIVE(pVM, SetMoveSpeed));
+	pVM->RegisterClassFunction("getMoveSpeed", BIND_NATIVE(pVM, GetMoveSpeed));
 
-	pVM->RegisterClassFunction("setTurnSpeed", SetTurnSpeed);
-	pVM->RegisterClassFunction("getTurnSpeed", GetTurnSpeed);
+	pVM->RegisterClassFunction("setTurnSpeed", BIND_NATIVE(pVM, SetTurnSpeed));
+	pVM->RegisterClassFunction("getTurnSpeed", BIND_NATIVE(pVM, GetTurnSpeed));
 
 	pVM->RegisterClassFunction("destroy", Destroy);
 }
 
 
-int	CEntityNatives::SetPosition(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-		
-	CVector3 vecPos;
-	pVM->Pop(vecPos);
-	pEntity->SetPosition(vecPos);
-	pVM->ResetStackIndex();
-	
-	return 1;
-}
-
-int	CEntityNatives::GetPosition(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecPosition;
-	pEntity->GetPosition(vecPosition);
-
-	CScriptArguments arg;
-	arg.pushVector3(vecPosition);
-	pVM->PushArray(arg);
-	return 1;
-}
-
-
-int	CEntityNatives::SetRotation(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecRot;
-	pVM->Pop(vecRot);
-	pEntity->SetRotation(vecRot);
-	pVM->ResetStackIndex();
-	return 1;
-}
-
-int	CEntityNatives::GetRotation(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecRotation;
-	pEntity->GetRotation(vecRotation);
-
-	CScriptArguments arg;
-	arg.pushVector3(vecRotation);
-	pVM->PushArray(arg);
-	return 1;
-}
-
-
-int	CEntityNatives::SetMoveSpeed(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecMoveSpeed;
-	pVM->Pop(vecMoveSpeed);
-	pEntity->SetMoveSpeed(vecMoveSpeed);
-	pVM->ResetStackIndex();
-	return 1;
-}
-
-int	CEntityNatives::GetMoveSpeed(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecMoveSpeed;
-	pEntity->GetMoveSpeed(vecMoveSpeed);
-
-	CScriptArguments arg;
-	arg.pushVector3(vecMoveSpeed);
-	pVM->PushArray(arg);
-	return 1;
-}
-
-
-int	CEntityNatives::SetTurnSpeed(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecTurnSpeed;
-	pVM->Pop(vecTurnSpeed);
-	pEntity->SetMoveSpeed(vecTurnSpeed);
-	pVM->ResetStackIndex();
-	return 1;
-}
-
-int	CEntityNatives::GetTurnSpeed(int * VM)
-{
-	GET_SCRIPT_VM_SAFE;
-	GET_ENTITY_SAFE;
-
-	CVector3 vecTurnSpeed;
-	pEntity->GetTurnSpeed(vecTurnSpeed);
-
-	CScriptArguments arg;
-	arg.pushVector3(vecTurnSpeed);
-	pVM->PushArray(arg);
-	return 1;
-}
-
-int CEntityNatives::Destroy(int * VM)
-{
-	return 1;
+void CEntityNatives::SetPosition(CNetworkEntity * pEntity, const CVector3& vecPosition)
+{
+	pEntity->SetPosition(vecPosition);
+}
+
+CVector3 CEntityNatives::GetPosition(CNetworkEntity * pEntity)
+{
+	CVector3 vecPosition;
+	pEntity->GetPosition(vecPosition);
+	return vecPosition;
+}
+
+
+void CEntityNatives::SetRotation(CNetworkEntity * pEntity, const CVector3& vecRotation)
+{
+	pEntity->SetRotation(vecRotation);
+}
+
+CVector3 CEntityNatives::GetRotation(CNetworkEntity * pEntity)
+{
+	CVector3 vecRotation;
+	pEntity->GetRotation(vecRotation);
+	return vecRotation;
+}
+
+
+void CEntityNatives::SetMoveSpeed(CNetworkEntity * pEntity, const CVector3& vecMoveSpeed)
+{
+	pEntity->SetMoveSpeed(vecMoveSpeed);
+}
+
+CVector3 CEntityNatives::GetMoveSpeed(CNetworkEntity * pEntity)
+{
+	CVector3 vecMoveSpeed;
+	pEntity->GetMoveSpeed(vecMoveSpeed);
+	return vecMoveSpeed;
+}
+
+
+void CEntityNatives::SetTurnSpeed(CNetworkEntity * pEntity, const CVector3& vecTurnSpeed)
+{
+	pEntity->SetTurnSpeed(vecTurnSpeed);
+}
+
+CVector3 CEntityNatives::GetTurnSpeed(CNetworkEntity * pEntity)
+{
+	CVector3 vecTurnSpeed;
+	pEntity->GetTurnSpeed(vecTurnSpeed);
+	return vecTurnSpeed;
+}
+
+int CEntityNatives::Destroy(int * VM)
+{
+	return 1;
 }
\ No newline at end of file
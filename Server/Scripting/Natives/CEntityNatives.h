@@ -12,19 +12,21 @@
 
 #include <Scripting/CScriptVM.h>
 
+class CNetworkEntity;
+
 class CEntityNatives {
 private:
-	static int	SetPosition(int * VM);
-	static int	GetPosition(int * VM);
+	static void		SetPosition(CNetworkEntity * pEntity, const CVector3& vecPosition);
+	static CVector3	GetPosition(CNetworkEntity * pEntity);
 	
-	static int	SetRotation(int * VM);
-	static int	GetRotation(int * VM);
+	static void		SetRotation(CNetworkEntity * pEntity, const CVector3& vecRotation);
+	static CVector3	GetRotation(CNetworkEntity * pEntity);
 
-	static int	SetMoveSpeed(int * VM);
-	static int	GetMoveSpeed(int * VM);
+	static void		SetMoveSpeed(CNetworkEntity * pEntity, const CVector3& vecMoveSpeed);
+	static CVector3	GetMoveSpeed(CNetworkEntity * pEntity);
 
-	static int	SetTurnSpeed(int * VM);
-	static int	GetTurnSpeed(int * VM);
+	static void		SetTurnSpeed(CNetworkEntity * pEntity, const CVector3& vecTurnSpeed);
+	static CVector3	GetTurnSpeed(CNetworkEntity * pEntity);
 
 	static int	Destroy(int * VM);
 public:
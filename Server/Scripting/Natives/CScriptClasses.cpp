@@ -20,15 +20,51 @@ void CScriptClasses::Register(CScriptVM * pVM)
 {
 	pVM->RegisterFunction("createEntity", CreateEntity);
 
+	// Build the method table of every class once, instances only get the shared table
 	pVM->RegisterScriptClass("C3DLabelEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	C3DLabelNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CActorEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CActorNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CBlipEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CBlipNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CCheckpointEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CCheckpointNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CFireEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CFireNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CObjectEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CObjectNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CPickupEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CPickupNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CPlayerEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CPlayerNatives::Register(pVM);
+	pVM->FinishScriptClass();
+
 	pVM->RegisterScriptClass("CVehicleEntity", CreateEntity);
+	CEntityNatives::Register(pVM);
+	CVehicleNatives::Register(pVM);
+	pVM->FinishScriptClass();
 }
 
 
@@ -47,43 +83,27 @@ int CScriptClasses::CreateEntity(int * VM)
 		{
 			C3DLabelEntity* p3DLabel = new C3DLabelEntity();
 			pVM->SetClassInstance("C3DLabelEntity", (void*)p3DLabel);
-			CEntityNatives::Register(pVM);
-			C3DLabelNatives::Register(pVM);
 		} else if(strEntity == "ACTOR") {
 			CActorEntity* pActor = new CActorEntity();
 			pVM->SetClassInstance("CActorEntity", (void*)pActor);
-			CEntityNatives::Register(pVM);
-			CActorNatives::Register(pVM);
 		} else if(strEntity == "BLIP") {
 			CBlipEntity * pBlip = new CBlipEntity();
 			pVM->SetClassInstance("CBlipEntity", (void*)pBlip);
-			CEntityNatives::Register(pVM);
-			CBlipNatives::Register(pVM);
 		} else if(strEntity == "CHECKPOINT") {
 			CCheckpointEntity* pCheckpoint = new CCheckpointEntity();
 			pVM->SetClassInstance("CCheckpointEntity", (void*)pCheckpoint);
-			CEntityNatives::Register(pVM);
-			CCheckpointNatives::Register(pVM);
 		} else if(strEntity == "FIRE") {
 			CFireEntity* pFire = new CFireEntity();
 			pVM->SetClassInstance("CFireEntity", (void*)pFire);
-			CEntityNatives::Register(pVM);
-			CFireNatives::Register(pVM);
 		} else if(strEntity == "OBJECT") {
 			CObjectEntity* pObject = new CObjectEntity();
 			pVM->SetClassInstance("CObjectEntity", (void*)pObject);
-			CEntityNatives::Register(pVM);
-			CObjectNatives::Register(pVM);
 		} else if(strEntity == "PICKUP") {
 			CPickupEntity* pPickup = new CPickupEntity();
 			pVM->SetClassInstance("CPickupEntity", (void*)pPickup);
-			CEntityNatives::Register(pVM);
-			CPickupNatives::Register(pVM);
 		} else if(strEntity == "PLAYER") {
 			CPlayerEntity* pPlayer = new CPlayerEntity();
 			pVM->SetClassInstance("CPlayerEntity", (void*)pPlayer);
-			CEntityNatives::Register(pVM);
-			CPlayerNatives::Register(pVM);
 		} else if(strEntity == "VEHICLE") {
 			CVehicleEntity* pVehicle = new CVehicleEntity();
 
@@ -100,8 +120,6 @@ int CScriptClasses::CreateEntity(int * VM)
 			pVehicle->SetId(CServer::GetInstance()->GetVehicleManager()->Add(pVehicle));
 			
 			pVM->SetClassInstance("CVehicleEntity", (void*)pVehicle);
-			CEntityNatives::Register(pVM);
-			CVehicleNatives::Register(pVM);
 
 			//pVehicle->Spawn();
 		}
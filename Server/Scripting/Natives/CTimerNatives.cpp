@@ -0,0 +1,106 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTimerNatives.cpp
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CTimerNatives.h"
+#include <Scripting/ResourceSystem/CResourceManager.h>
+#include <Scripting/CEventHandler.h>
+#include <CTimerWheel.h>
+
+void CTimerNatives::Register(CScriptVM* pVM)
+{
+	pVM->RegisterFunction("setTimer", SetTimer);
+	pVM->RegisterFunction("killTimer", KillTimer);
+	pVM->RegisterFunction("isTimer", IsTimer);
+}
+
+// setTimer(function, interval, timesToExecute = 0, ...)
+int CTimerNatives::SetTimer(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	// Get the function
+	int ref = -1;
+	SQObjectPtr pFunction;
+	int iStackIndex;
+
+	if(pVM->GetVMType() == LUA_VM)
+	{
+		if(!lua_isfunction((lua_State*)VM, 1))
+		{
+			pVM->Push(false);
+			return 1;
+		}
+
+		lua_pushvalue((lua_State*)VM, 1);
+		ref = luaL_ref((lua_State*)VM, LUA_REGISTRYINDEX);
+		iStackIndex = 2;
+	} else {
+		if(sq_gettype((SQVM*)VM, 2) != OT_CLOSURE && sq_gettype((SQVM*)VM, 2) != OT_NATIVECLOSURE)
+		{
+			pVM->Push(false);
+			return 1;
+		}
+
+		pFunction = stack_get((SQVM*)VM, 2);
+		iStackIndex = 3;
+	}
+
+	// Get the interval and the execution count
+	int iInterval;
+	int iTimesToExecute;
+	pVM->SetStackIndex(iStackIndex);
+	pVM->Pop(iInterval);
+	pVM->Pop(iTimesToExecute, 0);
+
+	// Everything after that gets passed to the function
+	CScriptArguments arguments;
+
+	for(int i = (iStackIndex + 2); i <= pVM->GetArgumentCount(); i++)
+	{
+		CScriptArgument argument;
+		argument.pushFromStack(pVM, i);
+		arguments.push(argument);
+	}
+
+	pVM->ResetStackIndex();
+
+	CEventHandler * pHandler = new CEventHandler(pVM, ref, pFunction, CEventHandler::RESOURCE_EVENT);
+	TimerId timerId = CTimerWheel::GetInstance()->Add(pResource, pHandler, arguments, (iInterval > 0 ? iInterval : 0), (iTimesToExecute > 0 ? iTimesToExecute : 0));
+
+	if(timerId == INVALID_TIMER_ID)
+		pVM->Push(false);
+	else
+		pVM->Push((int)timerId);
+
+	return 1;
+}
+
+int CTimerNatives::KillTimer(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	int iTimerId;
+	pVM->Pop(iTimerId);
+	pVM->ResetStackIndex();
+
+	pVM->Push(CTimerWheel::GetInstance()->Kill((TimerId)iTimerId, pResource));
+	return 1;
+}
+
+int CTimerNatives::IsTimer(int * VM)
+{
+	GET_SCRIPT_VM_SAFE;
+
+	int iTimerId;
+	pVM->Pop(iTimerId);
+	pVM->ResetStackIndex();
+
+	pVM->Push(CTimerWheel::GetInstance()->Exists((TimerId)iTimerId, pResource));
+	return 1;
+}
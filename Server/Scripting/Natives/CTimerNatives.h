@@ -0,0 +1,25 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CTimerNatives.h
+// Project: Server.Core
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CTimerNatives_h
+#define CTimerNatives_h
+
+#include <Scripting/CScriptVM.h>
+
+class CTimerNatives {
+
+private:
+	static int	SetTimer(int * pVM);
+	static int	KillTimer(int * pVM);
+	static int	IsTimer(int * pVM);
+public:
+	static void Register(CScriptVM* pVM);
+};
+
+#endif // CTimerNatives_h
@@ -26,6 +26,10 @@
 
 #include "CServerNatives.h"
 
+#include "CTimerNatives.h"
+
+#include "CDatabaseNatives.h"
+
 #include "C3DLabelNatives.h"
 
 #include "CEntityNatives.h"
@@ -9,6 +9,7 @@
 
 #include "CLogFile.h"
 #include "SharedUtility.h"
+#include "Threading/CThread.h"
 
 #ifdef _LINUX
 #define stricmp strcasecmp
@@ -19,6 +20,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <unistd.h>
 #endif
 
 FILE *            CLogFile::m_fLogFile = NULL;
@@ -27,10 +29,39 @@ LogFileCallback_t CLogFile::m_pfnCallback = NULL;
 bool              CLogFile::m_bUseTimeStamp = true;
 CMutex            CLogFile::m_mutex;
 
+std::atomic<int>  CLogFile::m_levels[LOG_CATEGORY_MAX];
+
+// Set in a loop, the Windows toolset can't list-initialize atomics
+static struct LogLevelInitializer
+{
+	LogLevelInitializer()
+	{
+		for(int i = 0; i < LOG_CATEGORY_MAX; i++)
+		{
+#ifdef IVMP_DEBUG
+			CLogFile::SetLevel((eLogCategory)i, LOG_LEVEL_DEBUG);
+#else
+			CLogFile::SetLevel((eLogCategory)i, LOG_LEVEL_INFO);
+#endif
+		}
+	}
+} g_logLevelInitializer;
+
+std::atomic<bool>         CLogFile::m_bAsync(false);
+CLogFile::LogEntry *      CLogFile::m_pQueue = NULL;
+std::atomic<unsigned int> CLogFile::m_uiEnqueuePosition(0);
+unsigned int              CLogFile::m_uiDequeuePosition = 0;
+std::atomic<unsigned int> CLogFile::m_uiDropped(0);
+CThread *                 CLogFile::m_pWriterThread = NULL;
+eLogFlushPolicy           CLogFile::m_flushPolicy = LOG_FLUSH_ALWAYS;
+unsigned long             CLogFile::m_ulFlushInterval = 0;
+unsigned long             CLogFile::m_ulLastFlushTime = 0;
+bool                      CLogFile::m_bUnflushed = false;
+
 void CLogFile::Open(CString strLogFile, bool bAppend)
 {
 	// Lock the mutex
-	m_mutex.TryLock(1);
+	m_mutex.Lock();
 
 	// Open the log file
 	m_fLogFile = fopen(SharedUtility::GetAbsolutePath(strLogFile).Get(), bAppend ? "a" : "w");
@@ -46,113 +77,368 @@ void CLogFile::Open(CString strLogFile, bool bAppend)
 	m_mutex.Unlock();
 }
 
-void CLogFile::Print(const char * szString)
+void CLogFile::Write(const char * szString, bool bConsole, time_t time)
+{
+	// Print the message
+	if(bConsole)
+		printf("%s\n", szString);
+
+	// If we have a callback and it is enabled call it
+	if(m_bUseCallback && m_pfnCallback)
+		m_pfnCallback(szString);
+
+	// Is the log file open?
+	if(m_fLogFile)
+	{
+		// Log the message
+		if(m_bUseTimeStamp)
+		{
+			char szTime[32];
+			strftime(szTime, sizeof(szTime), "%H:%M:%S", localtime(&time));
+			fprintf(m_fLogFile, "[%s] %s\n", szTime, szString);
+		}
+		else
+			fprintf(m_fLogFile, "%s\n", szString);
+
+		m_bUnflushed = true;
+	}
+}
+
+void CLogFile::Log(const char * szString, bool bConsole)
 {
+	// Leave it to the writer thread if it's running
+	if(m_bAsync.load(std::memory_order_acquire))
+	{
+		Enqueue(szString, bConsole);
+		return;
+	}
+
 	// Lock the mutex
-	m_mutex.TryLock(1);
+	m_mutex.Lock();
 
-	// Print the message
-	printf("%s\n", szString);
+	// Write the message right away
+	Write(szString, bConsole, time(NULL));
 
-	// Flush the output buffer
-	fflush(stdout);
+	// Flush the output buffers
+	if(bConsole)
+		fflush(stdout);
 
-	// Print the message to the log file
-	PrintToFile(szString);
+	FlushFile(true);
 
 	// Unlock the mutex
 	m_mutex.Unlock();
 }
 
-void CLogFile::Printf(const char * szFormat, ...)
+bool CLogFile::Enqueue(const char * szString, bool bConsole)
 {
+	unsigned int uiPosition = m_uiEnqueuePosition.load(std::memory_order_relaxed);
+	LogEntry * pEntry;
+
+	// Claim a free entry
+	while(true)
+	{
+		pEntry = &m_pQueue[uiPosition & (LOG_QUEUE_SIZE - 1)];
+		int iDifference = (int)(pEntry->uiSequence.load(std::memory_order_acquire) - uiPosition);
+
+		if(iDifference == 0)
+		{
+			if(m_uiEnqueuePosition.compare_exchange_weak(uiPosition, (uiPosition + 1), std::memory_order_relaxed))
+				break;
+		}
+		else if(iDifference < 0)
+		{
+			// The writer can't keep up, drop the message instead of blocking
+			m_uiDropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			uiPosition = m_uiEnqueuePosition.load(std::memory_order_relaxed);
+	}
+
+	pEntry->time = time(NULL);
+	pEntry->bConsole = bConsole;
+	strncpy(pEntry->szMessage, szString, (LOG_MESSAGE_SIZE - 1));
+	pEntry->szMessage[LOG_MESSAGE_SIZE - 1] = '\0';
+
+	// Hand it to the writer
+	pEntry->uiSequence.store((uiPosition + 1), std::memory_order_release);
+	return true;
+}
+
+unsigned int CLogFile::WriteQueued()
+{
+	unsigned int uiWritten = 0;
+
 	// Lock the mutex
-	m_mutex.TryLock(1);
+	m_mutex.Lock();
+
+	while(uiWritten < LOG_WRITE_BATCH)
+	{
+		LogEntry * pEntry = &m_pQueue[m_uiDequeuePosition & (LOG_QUEUE_SIZE - 1)];
+
+		// Is the entry still being written or empty?
+		if((int)(pEntry->uiSequence.load(std::memory_order_acquire) - (m_uiDequeuePosition + 1)) < 0)
+			break;
+
+		Write(pEntry->szMessage, pEntry->bConsole, pEntry->time);
+
+		// Give the entry back to the producers
+		pEntry->uiSequence.store((m_uiDequeuePosition + LOG_QUEUE_SIZE), std::memory_order_release);
+		m_uiDequeuePosition++;
+		uiWritten++;
+	}
+
+	// Report the messages which didn't fit into the queue
+	unsigned int uiDropped = m_uiDropped.exchange(0, std::memory_order_relaxed);
+
+	if(uiDropped > 0)
+	{
+		char szBuffer[128];
+		sprintf(szBuffer, "Warning: Dropped %u log message(s), the log queue was full.", uiDropped);
+		Write(szBuffer, true, time(NULL));
+	}
+
+	// Flush the output buffers
+	if(uiWritten > 0 || uiDropped > 0)
+		fflush(stdout);
+
+	FlushFile(false);
+
+	// Unlock the mutex
+	m_mutex.Unlock();
+
+	return uiWritten;
+}
+
+void CLogFile::FlushFile(bool bForce)
+{
+	// Is there anything to flush?
+	if(!m_fLogFile || !m_bUnflushed)
+		return;
+
+	unsigned long ulTime = SharedUtility::GetTime();
+
+	if(!bForce)
+	{
+		// Does the flush policy allow it?
+		if(m_flushPolicy == LOG_FLUSH_CLOSE)
+			return;
+
+		if(m_flushPolicy == LOG_FLUSH_INTERVAL && (ulTime - m_ulLastFlushTime) < m_ulFlushInterval)
+			return;
+	}
+
+	// Flush the log file buffer
+	fflush(m_fLogFile);
+	m_ulLastFlushTime = ulTime;
+	m_bUnflushed = false;
+}
+
+void CLogFile::WriterThread(CThread * pThread)
+{
+	while(true)
+	{
+		// Check the state first so nothing queued before StopWriter gets lost
+		bool bActive = m_bAsync.load(std::memory_order_acquire);
+
+		if(WriteQueued() > 0)
+			continue;
+
+		if(!bActive)
+			break;
+
+		// Wait for new messages
+#ifdef _WIN32
+		Sleep(LOG_WRITER_IDLE_TIME);
+#else
+		usleep(LOG_WRITER_IDLE_TIME * 1000);
+#endif
+	}
+}
+
+void CLogFile::StartWriter(eLogFlushPolicy flushPolicy, unsigned long ulFlushInterval)
+{
+	// Is the writer already running?
+	if(m_bAsync.load())
+		return;
+
+	m_mutex.Lock();
+	m_flushPolicy = flushPolicy;
+	m_ulFlushInterval = ulFlushInterval;
+	m_ulLastFlushTime = SharedUtility::GetTime();
+
+	// Allocate the queue the first time, it's kept for later writers
+	// as late producers might still be using it after StopWriter
+	if(!m_pQueue)
+	{
+		m_pQueue = new LogEntry[LOG_QUEUE_SIZE];
+
+		for(unsigned int i = 0; i < LOG_QUEUE_SIZE; i++)
+			m_pQueue[i].uiSequence.store(i, std::memory_order_relaxed);
+
+		m_uiEnqueuePosition.store(0);
+		m_uiDequeuePosition = 0;
+	}
 
+	m_mutex.Unlock();
+
+	// Let the messages go to the queue
+	m_bAsync.store(true, std::memory_order_release);
+
+	m_pWriterThread = new CThread();
+	m_pWriterThread->Start(WriterThread);
+}
+
+void CLogFile::StopWriter()
+{
+	// Is the writer running?
+	if(!m_bAsync.load())
+		return;
+
+	// Write directly again, the writer exits once the queue is empty
+	m_bAsync.store(false, std::memory_order_release);
+
+	while(m_pWriterThread->IsRunning())
+	{
+#ifdef _WIN32
+		Sleep(1);
+#else
+		usleep(1000);
+#endif
+	}
+
+	SAFE_DELETE(m_pWriterThread);
+
+	// Write anything a producer queued while we switched back
+	while(WriteQueued() > 0);
+
+	m_mutex.Lock();
+	FlushFile(true);
+	m_mutex.Unlock();
+}
+
+static const char * g_szCategoryNames[LOG_CATEGORY_MAX] = { "general", "network", "script" };
+static const char * g_szLevelNames[LOG_LEVEL_NONE + 1] = { "debug", "info", "warning", "error", "none" };
+
+const char * CLogFile::GetCategoryName(eLogCategory category)
+{
+	return (category < LOG_CATEGORY_MAX) ? g_szCategoryNames[category] : "";
+}
+
+bool CLogFile::GetCategoryFromName(const char * szName, eLogCategory& category)
+{
+	for(int i = 0; i < LOG_CATEGORY_MAX; i++)
+	{
+		if(!strcmp(szName, g_szCategoryNames[i]))
+		{
+			category = (eLogCategory)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char * CLogFile::GetLevelName(eLogLevel level)
+{
+	return (level <= LOG_LEVEL_NONE) ? g_szLevelNames[level] : "";
+}
+
+bool CLogFile::GetLevelFromName(const char * szName, eLogLevel& level)
+{
+	for(int i = 0; i <= LOG_LEVEL_NONE; i++)
+	{
+		if(!strcmp(szName, g_szLevelNames[i]))
+		{
+			level = (eLogLevel)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CLogFile::Print(const char * szString)
+{
+	// Print the message to the console and the log file
+	Log(szString, true);
+}
+
+void CLogFile::Printf(const char * szFormat, ...)
+{
 	// Collect the arguments
 	va_list vaArgs;
-	char szBuffer[2048];
+	char szBuffer[LOG_MESSAGE_SIZE];
 	va_start(vaArgs, szFormat);
 	vsnprintf_s(szBuffer, sizeof(szBuffer), szFormat, vaArgs);
 	va_end(vaArgs);
 
 	// Print the message
-	Print(szBuffer);
-
-	// Unlock the mutex
-	m_mutex.Unlock();
+	Log(szBuffer, true);
 }
 
 void CLogFile::PrintDebugf(const char * szFormat, ...)
 {
 #ifdef IVMP_DEBUG
-	// Lock the mutex
-	m_mutex.TryLock(1);
+	// Is debug output enabled?
+	if(!IsEnabled(LOG_CATEGORY_GENERAL, LOG_LEVEL_DEBUG))
+		return;
 
 	// Collect the arguments
 	va_list vaArgs;
-	char szBuffer[2048];
+	char szBuffer[LOG_MESSAGE_SIZE];
 	va_start(vaArgs, szFormat);
 	vsnprintf_s(szBuffer, sizeof(szBuffer), szFormat, vaArgs);
 	va_end(vaArgs);
 
 	// Print the message
-	Print(szBuffer);
-
-	// Unlock the mutex
-	m_mutex.Unlock();
+	Log(szBuffer, true);
 #endif
 }
 
 void CLogFile::PrintToFile(const char * szString)
 {
-	// Lock the mutex
-	m_mutex.TryLock(1);
-
-	// If we have a callback and it is enabled call it
-	if(m_bUseCallback && m_pfnCallback)
-		m_pfnCallback(szString);
-
-	// Is the log file open?
-	if(m_fLogFile)
-	{
-		// Log the message
-		if(m_bUseTimeStamp)
-			fprintf(m_fLogFile, "[%s] %s\n", SharedUtility::GetTimeString(), szString);
-		else
-			fprintf(m_fLogFile, "%s\n", szString);
-
-		// Flush the log file buffer
-		fflush(m_fLogFile);
-	}
-
-	// Unlock the mutex
-	m_mutex.Unlock();
+	// Print the message to the log file only
+	Log(szString, false);
 }
 
 void CLogFile::PrintfToFile(const char * szFormat, ...)
 {
-	// Lock the mutex
-	m_mutex.TryLock(1);
-
 	// Collect the arguments
 	va_list vaArgs;
-	char szBuffer[2048];
+	char szBuffer[LOG_MESSAGE_SIZE];
 	va_start(vaArgs, szFormat);
 	vsnprintf_s(szBuffer, sizeof(szBuffer), szFormat, vaArgs);
 	va_end(vaArgs);
 
 	// Print the message to the log file
-	PrintToFile(szBuffer);
+	Log(szBuffer, false);
+}
 
-	// Unlock the mutex
-	m_mutex.Unlock();
+void CLogFile::Logf(eLogCategory category, eLogLevel level, const char * szFormat, ...)
+{
+	// Is the level enabled for this category? Check before formatting
+	if(!IsEnabled(category, level))
+		return;
+
+	// Collect the arguments
+	va_list vaArgs;
+	char szBuffer[LOG_MESSAGE_SIZE];
+	va_start(vaArgs, szFormat);
+	vsnprintf_s(szBuffer, sizeof(szBuffer), szFormat, vaArgs);
+	va_end(vaArgs);
+
+	// Print the message
+	Log(szBuffer, true);
 }
 
 void CLogFile::Close()
 {
+	// Write everything which is still queued
+	StopWriter();
+
 	// Lock the mutex
-	m_mutex.TryLock(1);
+	m_mutex.Lock();
 
 	// Is the log file open?
 	if(m_fLogFile)
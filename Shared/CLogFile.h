@@ -13,18 +13,85 @@
 #include "CString.h"
 #include "Threading/CMutex.h"
 #include <stdio.h>
+#include <time.h>
+#include <atomic>
+
+// Entries of the async writer queue, has to be a power of two
+#define LOG_QUEUE_SIZE 1024
+#define LOG_MESSAGE_SIZE 2048
+
+// Max entries the writer handles before it flushes and checks the queue state again
+#define LOG_WRITE_BATCH 64
+
+// How long the writer sleeps when the queue is empty
+#define LOG_WRITER_IDLE_TIME 5
 
 typedef void (* LogFileCallback_t)(const char * szBuffer);
 
+class CThread;
+
+enum eLogCategory
+{
+	LOG_CATEGORY_GENERAL,
+	LOG_CATEGORY_NETWORK,
+	LOG_CATEGORY_SCRIPT,
+	LOG_CATEGORY_MAX,
+};
+
+enum eLogLevel
+{
+	LOG_LEVEL_DEBUG,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_ERROR,
+	LOG_LEVEL_NONE,
+};
+
+enum eLogFlushPolicy
+{
+	LOG_FLUSH_ALWAYS,   // Flush the log file after every batch
+	LOG_FLUSH_INTERVAL, // Flush the log file at most once per interval
+	LOG_FLUSH_CLOSE,    // Only flush the log file when it gets closed
+};
+
 class CLogFile
 {
 private:
+	struct LogEntry
+	{
+		std::atomic<unsigned int> uiSequence;
+		time_t                    time;
+		bool                      bConsole;
+		char                      szMessage[LOG_MESSAGE_SIZE];
+	};
+
 	static FILE *            m_fLogFile;
 	static bool              m_bUseCallback;
 	static LogFileCallback_t m_pfnCallback;
 	static bool              m_bUseTimeStamp;
 	static CMutex            m_mutex;
 
+	static std::atomic<int>  m_levels[LOG_CATEGORY_MAX];
+
+	// Async writer, the queue is a bounded multi-producer/single-consumer ring
+	static std::atomic<bool>         m_bAsync;
+	static LogEntry *                m_pQueue;
+	static std::atomic<unsigned int> m_uiEnqueuePosition;
+	static unsigned int              m_uiDequeuePosition; // Protected by m_mutex
+	static std::atomic<unsigned int> m_uiDropped;
+	static CThread *                 m_pWriterThread;
+	static eLogFlushPolicy           m_flushPolicy;
+	static unsigned long             m_ulFlushInterval;
+	static unsigned long             m_ulLastFlushTime;
+	static bool                      m_bUnflushed;
+
+	static void              Write(const char * szString, bool bConsole, time_t time);
+	static void              Log(const char * szString, bool bConsole);
+	static bool              Enqueue(const char * szString, bool bConsole);
+	static unsigned int      WriteQueued();
+	static void              FlushFile(bool bForce);
+	static void              WriterThread(CThread * pThread);
+
 public: 
 	static void              SetUseCallback(bool bUseCallback) { m_mutex.Lock(); m_bUseCallback = bUseCallback; m_mutex.Unlock(); }
 	static bool              GetUseCallback() { m_mutex.Lock(); bool bUseCallback = m_bUseCallback; m_mutex.Unlock(); return bUseCallback; }
@@ -32,13 +99,29 @@ public:
 	static LogFileCallback_t GetCallback() { m_mutex.Lock(); LogFileCallback_t pfnLogFileCallback = m_pfnCallback; m_mutex.Unlock(); return pfnLogFileCallback; }
 	static void				 SetUseTimeStamp(bool bTimeStamp) { m_mutex.Lock(); m_bUseTimeStamp = bTimeStamp; m_mutex.Unlock(); }
 	static bool              GetUseTimeStamp() { m_mutex.Lock(); bool bTimeStamp = m_bUseTimeStamp; m_mutex.Unlock(); return bTimeStamp; }
+	static void              SetLevel(eLogCategory category, eLogLevel level) { if(category < LOG_CATEGORY_MAX) m_levels[category] = level; }
+	static eLogLevel         GetLevel(eLogCategory category) { return (category < LOG_CATEGORY_MAX) ? (eLogLevel)m_levels[category].load() : LOG_LEVEL_NONE; }
+	static bool              IsEnabled(eLogCategory category, eLogLevel level) { return (category < LOG_CATEGORY_MAX && level >= m_levels[category].load()); }
+	// Names as used by the loglevel settings, e.g. "network" and "debug"
+	static const char *      GetCategoryName(eLogCategory category);
+	static bool              GetCategoryFromName(const char * szName, eLogCategory& category);
+	static const char *      GetLevelName(eLogLevel level);
+	static bool              GetLevelFromName(const char * szName, eLogLevel& level);
 	static void              Open(CString strLogFile, bool bAppend = false);
 	static void              Print(const char * szString);
 	static void              Printf(const char * szFormat, ...);
 	static void              PrintDebugf(const char * szFormat, ...);
 	static void              PrintToFile(const char * szString);
 	static void              PrintfToFile(const char * szFormat, ...);
-	static void              Close();
+	// The Print functions always write, Logf only if the level is enabled for the category
+	static void              Logf(eLogCategory category, eLogLevel level, const char * szFormat, ...);
+	static void              Close(); // Stops the writer too
+
+	// Hands the output to a background thread, the calling threads only queue their messages.
+	// Messages are dropped (and counted) while the queue is full
+	static void              StartWriter(eLogFlushPolicy flushPolicy = LOG_FLUSH_INTERVAL, unsigned long ulFlushInterval = 1000);
+	static void              StopWriter();
+	static bool              IsWriterRunning() { return m_bAsync.load(); }
 };
 
 #endif // CLogFile_h
\ No newline at end of file
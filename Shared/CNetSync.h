@@ -12,6 +12,7 @@
 
 #include "Common.h"
 #include "Math/CMaths.h"
+#include "Network/CBitStream.h"
 
 enum ePackageType
 {
@@ -77,6 +78,365 @@ struct sNetwork_Sync_Packet
 	sNetwork_Sync_Entity_Vehicle pEntityVehicle;
 };
 
+// World bounds used to quantize positions (positions outside get clamped)
+#define SYNC_WORLD_MIN_XY				-4096.0f
+#define SYNC_WORLD_MAX_XY				4096.0f
+#define SYNC_WORLD_MIN_Z				-256.0f
+#define SYNC_WORLD_MAX_Z				1792.0f
+
+// Bits used per component (8192 / 2^20 = ~0.8cm, 2048 / 2^16 = ~3cm)
+#define SYNC_POSITION_XY_BITS			20
+#define SYNC_POSITION_Z_BITS			16
+
+// Velocities are sent as a quantized length plus a normalized direction
+#define SYNC_MAX_VELOCITY				128.0f
+#define SYNC_VELOCITY_LENGTH_BITS		16
+#define SYNC_VELOCITY_DIRECTION_BITS	12
+
+#define SYNC_HEADING_BITS				16
+
+// Every n-th delta packet is a full keyframe so lost packets heal themselves
+#define SYNC_KEYFRAME_INTERVAL			20
+
+// Fields which changed since the last packet
+enum eSyncDirtyField
+{
+	SYNC_DIRTY_POSITION		= 0x1,
+	SYNC_DIRTY_MOVE_SPEED	= 0x2,
+	SYNC_DIRTY_TURN_SPEED	= 0x4,
+	SYNC_DIRTY_DUCK_STATE	= 0x8,
+	SYNC_DIRTY_HEADING		= 0x10,
+	SYNC_DIRTY_WEAPON_DATA	= 0x20,
+};
+
+#define SYNC_PLAYER_DIRTY_BITS			6
+
+namespace NetSync
+{
+	// Maps fValue (clamped to fMin..fMax) to 0..(2^uiBits - 1)
+	inline unsigned int Quantize(float fValue, float fMin, float fMax, unsigned int uiBits)
+	{
+		unsigned int uiMax = ((1u << uiBits) - 1);
+
+		if(fValue < fMin)
+			fValue = fMin;
+		else if(fValue > fMax)
+			fValue = fMax;
+
+		return (unsigned int)(((fValue - fMin) / (fMax - fMin)) * uiMax + 0.5f);
+	}
+
+	template<class BitStream>
+	inline void WriteQuantized(BitStream * pBitStream, float fValue, float fMin, float fMax, unsigned int uiBits)
+	{
+		unsigned int uiValue = Quantize(fValue, fMin, fMax, uiBits);
+		pBitStream->WriteBits((unsigned char *)&uiValue, uiBits, true);
+	}
+
+	template<class BitStream>
+	inline bool ReadQuantized(BitStream * pBitStream, float& fValue, float fMin, float fMax, unsigned int uiBits)
+	{
+		unsigned int uiMax = ((1u << uiBits) - 1);
+		unsigned int uiValue = 0;
+
+		if(!pBitStream->ReadBits((unsigned char *)&uiValue, uiBits, true))
+			return false;
+
+		fValue = (fMin + ((float)uiValue / uiMax) * (fMax - fMin));
+		return true;
+	}
+
+	template<class BitStream>
+	inline void WritePosition(BitStream * pBitStream, const CVector3& vecPosition)
+	{
+		WriteQuantized(pBitStream, vecPosition.fX, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS);
+		WriteQuantized(pBitStream, vecPosition.fY, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS);
+		WriteQuantized(pBitStream, vecPosition.fZ, SYNC_WORLD_MIN_Z, SYNC_WORLD_MAX_Z, SYNC_POSITION_Z_BITS);
+	}
+
+	template<class BitStream>
+	inline bool ReadPosition(BitStream * pBitStream, CVector3& vecPosition)
+	{
+		return (ReadQuantized(pBitStream, vecPosition.fX, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) &&
+			ReadQuantized(pBitStream, vecPosition.fY, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) &&
+			ReadQuantized(pBitStream, vecPosition.fZ, SYNC_WORLD_MIN_Z, SYNC_WORLD_MAX_Z, SYNC_POSITION_Z_BITS));
+	}
+
+	// Writes a zero bit for a (nearly) zero vector, otherwise the length and the normalized direction
+	template<class BitStream>
+	inline void WriteVelocity(BitStream * pBitStream, const CVector3& vecVelocity)
+	{
+		float fLength = vecVelocity.Length();
+
+		if(fLength < 0.0001f)
+		{
+			pBitStream->Write0();
+			return;
+		}
+
+		pBitStream->Write1();
+		WriteQuantized(pBitStream, fLength, 0.0f, SYNC_MAX_VELOCITY, SYNC_VELOCITY_LENGTH_BITS);
+		WriteQuantized(pBitStream, (vecVelocity.fX / fLength), -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS);
+		WriteQuantized(pBitStream, (vecVelocity.fY / fLength), -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS);
+		WriteQuantized(pBitStream, (vecVelocity.fZ / fLength), -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS);
+	}
+
+	template<class BitStream>
+	inline bool ReadVelocity(BitStream * pBitStream, CVector3& vecVelocity)
+	{
+		vecVelocity = CVector3();
+
+		if(!pBitStream->ReadBit())
+			return true;
+
+		float fLength;
+		CVector3 vecDirection;
+
+		if(!ReadQuantized(pBitStream, fLength, 0.0f, SYNC_MAX_VELOCITY, SYNC_VELOCITY_LENGTH_BITS) ||
+			!ReadQuantized(pBitStream, vecDirection.fX, -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS) ||
+			!ReadQuantized(pBitStream, vecDirection.fY, -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS) ||
+			!ReadQuantized(pBitStream, vecDirection.fZ, -1.0f, 1.0f, SYNC_VELOCITY_DIRECTION_BITS))
+			return false;
+
+		// Renormalize to get rid of the quantization error
+		float fDirectionLength = vecDirection.Length();
+
+		if(fDirectionLength > 0.0f)
+			vecVelocity = (vecDirection * (fLength / fDirectionLength));
+
+		return true;
+	}
+
+	// Headings are wrapped to -PI..PI
+	inline float WrapHeading(float fHeading)
+	{
+		while(fHeading > PI)
+			fHeading -= DOUBLE_PI;
+
+		while(fHeading < -PI)
+			fHeading += DOUBLE_PI;
+
+		return fHeading;
+	}
+
+	template<class BitStream>
+	inline void WriteHeading(BitStream * pBitStream, float fHeading)
+	{
+		WriteQuantized(pBitStream, WrapHeading(fHeading), -PI, PI, SYNC_HEADING_BITS);
+	}
+
+	template<class BitStream>
+	inline bool ReadHeading(BitStream * pBitStream, float& fHeading)
+	{
+		return ReadQuantized(pBitStream, fHeading, -PI, PI, SYNC_HEADING_BITS);
+	}
+
+	// Only sends the weapon data if there is any
+	template<class BitStream>
+	inline void WriteWeaponData(BitStream * pBitStream, const sNetwork_Sync_Entity_Player& syncPacket)
+	{
+		if(syncPacket.sWeaponData.vecAimTarget.IsEmpty() && syncPacket.sWeaponData.vecShotTarget.IsEmpty())
+		{
+			pBitStream->Write0();
+			return;
+		}
+
+		pBitStream->Write1();
+		WritePosition(pBitStream, syncPacket.sWeaponData.vecAimTarget);
+		pBitStream->Write(syncPacket.sWeaponData.vecAimSpecific[0]);
+		pBitStream->Write(syncPacket.sWeaponData.vecAimSpecific[1]);
+		WritePosition(pBitStream, syncPacket.sWeaponData.vecShotTarget);
+	}
+
+	template<class BitStream>
+	inline bool ReadWeaponData(BitStream * pBitStream, sNetwork_Sync_Entity_Player& syncPacket)
+	{
+		memset(&syncPacket.sWeaponData, 0, sizeof(syncPacket.sWeaponData));
+
+		if(!pBitStream->ReadBit())
+			return true;
+
+		return (ReadPosition(pBitStream, syncPacket.sWeaponData.vecAimTarget) &&
+			pBitStream->Read(syncPacket.sWeaponData.vecAimSpecific[0]) &&
+			pBitStream->Read(syncPacket.sWeaponData.vecAimSpecific[1]) &&
+			ReadPosition(pBitStream, syncPacket.sWeaponData.vecShotTarget));
+	}
+
+	template<class BitStream>
+	inline void Write(BitStream * pBitStream, const sNetwork_Sync_Entity_Player& syncPacket)
+	{
+		WritePosition(pBitStream, syncPacket.vecPosition);
+		WriteVelocity(pBitStream, syncPacket.vecMovementSpeed);
+		WriteVelocity(pBitStream, syncPacket.vecTurnSpeed);
+
+		if(syncPacket.bDuckState)
+			pBitStream->Write1();
+		else
+			pBitStream->Write0();
+
+		WriteHeading(pBitStream, syncPacket.fHeading);
+		WriteWeaponData(pBitStream, syncPacket);
+	}
+
+	template<class BitStream>
+	inline bool Read(BitStream * pBitStream, sNetwork_Sync_Entity_Player& syncPacket)
+	{
+		if(!ReadPosition(pBitStream, syncPacket.vecPosition) ||
+			!ReadVelocity(pBitStream, syncPacket.vecMovementSpeed) ||
+			!ReadVelocity(pBitStream, syncPacket.vecTurnSpeed))
+			return false;
+
+		syncPacket.bDuckState = pBitStream->ReadBit();
+
+		return (ReadHeading(pBitStream, syncPacket.fHeading) && ReadWeaponData(pBitStream, syncPacket));
+	}
+
+	template<class BitStream>
+	inline void Write(BitStream * pBitStream, const sNetwork_Sync_Entity_Vehicle& syncPacket)
+	{
+		WritePosition(pBitStream, syncPacket.vecPosition);
+	}
+
+	template<class BitStream>
+	inline bool Read(BitStream * pBitStream, sNetwork_Sync_Entity_Vehicle& syncPacket)
+	{
+		return ReadPosition(pBitStream, syncPacket.vecPosition);
+	}
+
+	// Compares two positions the way they end up on the wire
+	inline bool PositionChanged(const CVector3& vecCurrent, const CVector3& vecPrevious)
+	{
+		return (Quantize(vecCurrent.fX, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) != Quantize(vecPrevious.fX, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) ||
+			Quantize(vecCurrent.fY, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) != Quantize(vecPrevious.fY, SYNC_WORLD_MIN_XY, SYNC_WORLD_MAX_XY, SYNC_POSITION_XY_BITS) ||
+			Quantize(vecCurrent.fZ, SYNC_WORLD_MIN_Z, SYNC_WORLD_MAX_Z, SYNC_POSITION_Z_BITS) != Quantize(vecPrevious.fZ, SYNC_WORLD_MIN_Z, SYNC_WORLD_MAX_Z, SYNC_POSITION_Z_BITS));
+	}
+
+	inline bool VelocityChanged(const CVector3& vecCurrent, const CVector3& vecPrevious)
+	{
+		return ((vecCurrent - vecPrevious).Length() > (SYNC_MAX_VELOCITY / (1 << SYNC_VELOCITY_LENGTH_BITS)));
+	}
+
+	inline unsigned char GetDirtyFields(const sNetwork_Sync_Entity_Player& current, const sNetwork_Sync_Entity_Player& previous)
+	{
+		unsigned char ucDirty = 0;
+
+		if(PositionChanged(current.vecPosition, previous.vecPosition))
+			ucDirty |= SYNC_DIRTY_POSITION;
+
+		if(VelocityChanged(current.vecMovementSpeed, previous.vecMovementSpeed))
+			ucDirty |= SYNC_DIRTY_MOVE_SPEED;
+
+		if(VelocityChanged(current.vecTurnSpeed, previous.vecTurnSpeed))
+			ucDirty |= SYNC_DIRTY_TURN_SPEED;
+
+		if(current.bDuckState != previous.bDuckState)
+			ucDirty |= SYNC_DIRTY_DUCK_STATE;
+
+		if(Quantize(WrapHeading(current.fHeading), -PI, PI, SYNC_HEADING_BITS) != Quantize(WrapHeading(previous.fHeading), -PI, PI, SYNC_HEADING_BITS))
+			ucDirty |= SYNC_DIRTY_HEADING;
+
+		if(memcmp(&current.sWeaponData, &previous.sWeaponData, sizeof(current.sWeaponData)) != 0)
+			ucDirty |= SYNC_DIRTY_WEAPON_DATA;
+
+		return ucDirty;
+	}
+
+	// Writes a keyframe bit, then either the full packet or a dirty mask and the changed fields
+	template<class BitStream>
+	inline void WriteDelta(BitStream * pBitStream, const sNetwork_Sync_Entity_Player& current, const sNetwork_Sync_Entity_Player& previous, bool bKeyframe)
+	{
+		if(bKeyframe)
+		{
+			pBitStream->Write1();
+			Write(pBitStream, current);
+			return;
+		}
+
+		pBitStream->Write0();
+
+		unsigned char ucDirty = GetDirtyFields(current, previous);
+		pBitStream->WriteBits(&ucDirty, SYNC_PLAYER_DIRTY_BITS, true);
+
+		if(ucDirty & SYNC_DIRTY_POSITION)
+			WritePosition(pBitStream, current.vecPosition);
+
+		if(ucDirty & SYNC_DIRTY_MOVE_SPEED)
+			WriteVelocity(pBitStream, current.vecMovementSpeed);
+
+		if(ucDirty & SYNC_DIRTY_TURN_SPEED)
+			WriteVelocity(pBitStream, current.vecTurnSpeed);
+
+		if(ucDirty & SYNC_DIRTY_DUCK_STATE)
+		{
+			if(current.bDuckState)
+				pBitStream->Write1();
+			else
+				pBitStream->Write0();
+		}
+
+		if(ucDirty & SYNC_DIRTY_HEADING)
+			WriteHeading(pBitStream, current.fHeading);
+
+		if(ucDirty & SYNC_DIRTY_WEAPON_DATA)
+			WriteWeaponData(pBitStream, current);
+	}
+
+	// Applies a delta (or keyframe) on top of the last received state
+	template<class BitStream>
+	inline bool ReadDelta(BitStream * pBitStream, sNetwork_Sync_Entity_Player& state)
+	{
+		if(pBitStream->ReadBit())
+			return Read(pBitStream, state);
+
+		unsigned char ucDirty = 0;
+
+		if(!pBitStream->ReadBits(&ucDirty, SYNC_PLAYER_DIRTY_BITS, true))
+			return false;
+
+		if((ucDirty & SYNC_DIRTY_POSITION) && !ReadPosition(pBitStream, state.vecPosition))
+			return false;
+
+		if((ucDirty & SYNC_DIRTY_MOVE_SPEED) && !ReadVelocity(pBitStream, state.vecMovementSpeed))
+			return false;
+
+		if((ucDirty & SYNC_DIRTY_TURN_SPEED) && !ReadVelocity(pBitStream, state.vecTurnSpeed))
+			return false;
+
+		if(ucDirty & SYNC_DIRTY_DUCK_STATE)
+			state.bDuckState = pBitStream->ReadBit();
+
+		if((ucDirty & SYNC_DIRTY_HEADING) && !ReadHeading(pBitStream, state.fHeading))
+			return false;
+
+		if((ucDirty & SYNC_DIRTY_WEAPON_DATA) && !ReadWeaponData(pBitStream, state))
+			return false;
+
+		return true;
+	}
+
+	template<class BitStream>
+	inline void WriteDelta(BitStream * pBitStream, const sNetwork_Sync_Entity_Vehicle& current, const sNetwork_Sync_Entity_Vehicle& previous, bool bKeyframe)
+	{
+		if(bKeyframe || PositionChanged(current.vecPosition, previous.vecPosition))
+		{
+			pBitStream->Write1();
+			Write(pBitStream, current);
+			return;
+		}
+
+		pBitStream->Write0();
+	}
+
+	template<class BitStream>
+	inline bool ReadDelta(BitStream * pBitStream, sNetwork_Sync_Entity_Vehicle& state)
+	{
+		if(pBitStream->ReadBit())
+			return Read(pBitStream, state);
+
+		return true;
+	}
+};
+
 
 #define	NETWORK_TIMEOUT					3000
 
@@ -10,9 +10,7 @@
 #ifndef CRC_h
 #define CRC_h
 
-#ifndef _WIN32
-#include	"Linux.h"
-#endif
+#include	<stdio.h>
 
 #include	"CString.h"
 #include	"SharedUtility.h"
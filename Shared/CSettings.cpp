@@ -25,8 +25,11 @@ void CSettings::LoadDefaults(bool bClient)
 		AddInteger("port", 9999, 1024, 65535);
 		AddInteger("httpport", 9998, 80, 65535);
 		AddString("httpserver", "");
+		AddInteger("httpbandwidth", 1024, 0, 1048576);
 		AddInteger("maxplayers", MAX_PLAYERS, 1, MAX_PLAYERS);
 		AddInteger("maxvehicles", MAX_VEHICLES, 0, MAX_VEHICLES);
+		AddInteger("tickrate", 100, 1, 1000);
+		AddFloat("streamdistance", 200.0, 50.0, 2000.0);
 		AddString("password", "");
 		AddBool("query", true);
 		AddBool("listed", false);
@@ -45,6 +48,11 @@ void CSettings::LoadDefaults(bool bClient)
 		AddFloat("wind",0.0,0.0,50.0);
 		AddBool("silent", false);
 		AddBool("timestamp", true);
+		AddInteger("logflushinterval", 1000, 0, 60000);
+		// debug, info, warning, error or none, empty keeps the default of the build
+		AddString("loglevel.general", "");
+		AddString("loglevel.network", "");
+		AddString("loglevel.script", "");
 		AddList("script");
 		AddList("clientscript");
 		AddList("clientresource");
@@ -70,13 +78,83 @@ void CSettings::LoadDefaults(bool bClient)
 
 SettingsValue * CSettings::GetSetting(CString strSetting)
 {
-	for(std::map<CString, SettingsValue *>::iterator iter = m_values.begin(); iter != m_values.end(); iter++)
+	std::map<CString, SettingsValue *>::iterator iter = m_values.find(strSetting);
+
+	// Placeholders don't count as settings
+	if(iter != m_values.end() && iter->second->Exists())
+		return iter->second;
+
+	return NULL;
+}
+
+SettingsValue * CSettings::Intern(CString strSetting)
+{
+	std::map<CString, SettingsValue *>::iterator iter = m_values.find(strSetting);
+
+	if(iter != m_values.end())
+		return iter->second;
+
+	// Create a placeholder, Add* fills it in once the setting gets defined
+	SettingsValue * setting = new SettingsValue;
+	setting->cFlags = 0;
+	m_values[strSetting] = setting;
+	return setting;
+}
+
+SettingsValue * CSettings::CreateSetting(CString strSetting, char cFlag)
+{
+	if(Exists(strSetting))
+		return NULL;
+
+	// Reuse the placeholder if there is one, handles might point to it already
+	SettingsValue * setting = Intern(strSetting);
+	setting->cFlags = 0;
+	SET_BIT(setting->cFlags, cFlag);
+	setting->strValue.Clear();
+	setting->listValue.clear();
+	return setting;
+}
+
+void CSettings::NotifyChange(CString strSetting, SettingsValue * setting)
+{
+	// Work on a copy, a handler might remove itself
+	std::vector<SettingsChangeHandler> handlers = setting->handlers;
+
+	for(std::vector<SettingsChangeHandler>::iterator iter = handlers.begin(); iter != handlers.end(); iter++)
+		iter->pfnHandler(strSetting, iter->pUserData);
+}
+
+bool CSettings::AddChangeHandler(CString strSetting, SettingsChangeHandler_t pfnHandler, void * pUserData)
+{
+	if(!pfnHandler)
+		return false;
+
+	SettingsChangeHandler handler;
+	handler.pfnHandler = pfnHandler;
+	handler.pUserData = pUserData;
+	Intern(strSetting)->handlers.push_back(handler);
+	return true;
+}
+
+bool CSettings::RemoveChangeHandler(CString strSetting, SettingsChangeHandler_t pfnHandler, void * pUserData)
+{
+	std::map<CString, SettingsValue *>::iterator iter = m_values.find(strSetting);
+
+	if(iter == m_values.end())
+		return false;
+
+	std::vector<SettingsChangeHandler>& handlers = iter->second->handlers;
+
+	for(std::vector<SettingsChangeHandler>::iterator iter2 = handlers.begin(); iter2 != handlers.end(); iter2++)
 	{
-		if(iter->first == strSetting)
-			return iter->second;
+		if(iter2->pfnHandler == pfnHandler && iter2->pUserData == pUserData)
+		{
+			handlers.erase(iter2);
+			return true;
+		}
 	}
 
-	return NULL;
+	return false;
 }
 
 bool CSettings::Open(CString strPath, bool bCreate, bool bSave, bool bClient)
@@ -196,6 +274,10 @@ bool CSettings::Save()
 		// Get the setting pointer
 		SettingsValue * setting = iter->second;
 
+		// Skip placeholders
+		if(!setting->Exists())
+			continue;
+
 		// Find all nodes for this value
 		bool bFoundNode = false;
 
@@ -283,15 +365,14 @@ bool CSettings::Save()
 
 bool CSettings::AddBool(CString strSetting, bool bDefaultValue)
 {
-	if(Exists(strSetting))
+	SettingsValue * setting = CreateSetting(strSetting, SETTINGS_FLAG_BOOL);
+
+	if(!setting)
 		return false;
 
-	SettingsValue * setting = new SettingsValue;
-	setting->cFlags = 0;
-	SET_BIT(setting->cFlags, SETTINGS_FLAG_BOOL);
 	setting->bValue = bDefaultValue;
-	m_values[strSetting] = setting;
-	
+	NotifyChange(strSetting, setting);
+
 	// Save the XML file
 	Save();
 	return true;
@@ -299,16 +380,15 @@ bool CSettings::AddBool(CString strSetting, bool bDefaultValue)
 
 bool CSettings::AddInteger(CString strSetting, int iDefaultValue, int iMinimumValue, int iMaximumValue)
 {
-	if(Exists(strSetting))
+	SettingsValue * setting = CreateSetting(strSetting, SETTINGS_FLAG_INTEGER);
+
+	if(!setting)
 		return false;
 
-	SettingsValue * setting = new SettingsValue;
-	setting->cFlags = 0;
-	SET_BIT(setting->cFlags, SETTINGS_FLAG_INTEGER);
 	setting->iValue = iDefaultValue;
 	setting->iMinimumValue = iMinimumValue;
 	setting->iMaximimValue = iMaximumValue;
-	m_values[strSetting] = setting;
+	NotifyChange(strSetting, setting);
 
 	// Save the XML file
 	Save();
@@ -317,16 +397,15 @@ bool CSettings::AddInteger(CString strSetting, int iDefaultValue, int iMinimumVa
 
 bool CSettings::AddFloat(CString strSetting, float fDefaultValue, float fMinimumValue, float fMaximumValue)
 {
-	if(Exists(strSetting))
+	SettingsValue * setting = CreateSetting(strSetting, SETTINGS_FLAG_FLOAT);
+
+	if(!setting)
 		return false;
 
-	SettingsValue * setting = new SettingsValue;
-	setting->cFlags = 0;
-	SET_BIT(setting->cFlags, SETTINGS_FLAG_FLOAT);
 	setting->fValue = fDefaultValue;
 	setting->fMinimumValue = fMinimumValue;
 	setting->fMaximimValue = fMaximumValue;
-	m_values[strSetting] = setting;
+	NotifyChange(strSetting, setting);
 
 	// Save the XML file
 	Save();
@@ -335,14 +414,13 @@ bool CSettings::AddFloat(CString strSetting, float fDefaultValue, float fMinimum
 
 bool CSettings::AddString(CString strSetting, CString strDefaultValue)
 {
-	if(Exists(strSetting))
+	SettingsValue * setting = CreateSetting(strSetting, SETTINGS_FLAG_STRING);
+
+	if(!setting)
 		return false;
 
-	SettingsValue * setting = new SettingsValue;
-	setting->cFlags = 0;
-	SET_BIT(setting->cFlags, SETTINGS_FLAG_STRING);
 	setting->strValue = strDefaultValue;
-	m_values[strSetting] = setting;
+	NotifyChange(strSetting, setting);
 
 	// Save the XML file
 	Save();
@@ -351,21 +429,26 @@ bool CSettings::AddString(CString strSetting, CString strDefaultValue)
 
 bool CSettings::AddList(CString strSetting)
 {
-	if(Exists(strSetting))
+	SettingsValue * setting = CreateSetting(strSetting, SETTINGS_FLAG_LIST);
+
+	if(!setting)
 		return false;
 
-	SettingsValue * setting = new SettingsValue;
-	setting->cFlags = 0;
-	SET_BIT(setting->cFlags, SETTINGS_FLAG_LIST);
-	m_values[strSetting] = setting;
+	NotifyChange(strSetting, setting);
 	return true;
 }
 
 bool CSettings::SetBool(CString strSetting, bool bValue)
 {
-	if(IsBool(strSetting))
+	SettingsValue * setting = GetSetting(strSetting);
+
+	if(setting && setting->IsBool())
 	{
-		GetSetting(strSetting)->bValue = bValue;
+		if(setting->bValue != bValue)
+		{
+			setting->bValue = bValue;
+			NotifyChange(strSetting, setting);
+		}
 
 		// Save the XML file
 		Save();
@@ -377,14 +460,18 @@ bool CSettings::SetBool(CString strSetting, bool bValue)
 
 bool CSettings::SetInteger(CString strSetting, int iValue)
 {
-	if(IsInteger(strSetting))
-	{
-		SettingsValue * setting = GetSetting(strSetting);
+	SettingsValue * setting = GetSetting(strSetting);
 
+	if(setting && setting->IsInteger())
+	{
 		if(iValue < setting->iMinimumValue || iValue > setting->iMaximimValue)
 			return false;
 
-		setting->iValue = iValue;
+		if(setting->iValue != iValue)
+		{
+			setting->iValue = iValue;
+			NotifyChange(strSetting, setting);
+		}
 
 		// Save the XML file
 		Save();
@@ -396,14 +483,18 @@ bool CSettings::SetInteger(CString strSetting, int iValue)
 
 bool CSettings::SetFloat(CString strSetting, float fValue)
 {
-	if(IsFloat(strSetting))
-	{
-		SettingsValue * setting = GetSetting(strSetting);
+	SettingsValue * setting = GetSetting(strSetting);
 
+	if(setting && setting->IsFloat())
+	{
 		if(fValue < setting->fMinimumValue || fValue > setting->fMaximimValue)
 			return false;
 
-		setting->fValue = fValue;
+		if(setting->fValue != fValue)
+		{
+			setting->fValue = fValue;
+			NotifyChange(strSetting, setting);
+		}
 
 		// Save the XML file
 		Save();
@@ -415,9 +506,15 @@ bool CSettings::SetFloat(CString strSetting, float fValue)
 
 bool CSettings::SetString(CString strSetting, CString strValue)
 {
-	if(IsString(strSetting))
+	SettingsValue * setting = GetSetting(strSetting);
+
+	if(setting && setting->IsString())
 	{
-		GetSetting(strSetting)->strValue = strValue;
+		if(setting->strValue != strValue)
+		{
+			setting->strValue = strValue;
+			NotifyChange(strSetting, setting);
+		}
 
 		// Save the XML file
 		Save();
@@ -429,9 +526,12 @@ bool CSettings::SetString(CString strSetting, CString strValue)
 
 bool CSettings::AddToList(CString strSetting, CString strValue)
 {
-	if(IsList(strSetting))
+	SettingsValue * setting = GetSetting(strSetting);
+
+	if(setting && setting->IsList())
 	{
-		GetSetting(strSetting)->listValue.push_back(strValue);
+		setting->listValue.push_back(strValue);
+		NotifyChange(strSetting, setting);
 
 		// Save the XML file
 		Save();
@@ -580,18 +680,16 @@ bool CSettings::IsList(CString strSetting)
 
 bool CSettings::Remove(CString strSetting)
 {
-	if(!Exists(strSetting))
+	SettingsValue * setting = GetSetting(strSetting);
+
+	if(!setting)
 		return false;
 
-	for(std::map<CString, SettingsValue *>::iterator iter = m_values.begin(); iter != m_values.end(); iter++)
-	{
-		if(iter->first == strSetting)
-		{
-			delete iter->second;
-			m_values.erase(iter);
-			break;
-		}
-	}
+	// Turn it into a placeholder instead of freeing it, handles might still point to it
+	setting->cFlags = 0;
+	setting->strValue.Clear();
+	setting->listValue.clear();
+	NotifyChange(strSetting, setting);
 
 	// Save the XML file
 	Save();
@@ -12,6 +12,7 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include "Common.h"
 #include "CString.h"
 #include <tinyxml/tinyxml.h>
@@ -42,6 +43,17 @@ enum eSettingsFlags
 	SETTINGS_FLAG_LIST = 16
 };
 
+// Called after a setting was changed
+typedef void (* SettingsChangeHandler_t)(const CString& strSetting, void * pUserData);
+
+struct SettingsChangeHandler
+{
+	SettingsChangeHandler_t pfnHandler;
+	void                  * pUserData;
+};
+
+// Values are never freed, so pointers to them (see CSetting) stay valid. A value without
+// flags is a placeholder for a name which was looked up or removed but isn't defined
 struct SettingsValue
 {
 	char              cFlags;
@@ -54,7 +66,9 @@ struct SettingsValue
 	float             fMinimumValue;
 	int               iMaximimValue;
 	float             fMaximimValue;
+	std::vector<SettingsChangeHandler> handlers;
 
+	bool Exists() { return (cFlags != 0); }
 	bool IsBool() { return IS_BIT_SET(cFlags, SETTINGS_FLAG_BOOL); }
 	bool IsInteger() { return IS_BIT_SET(cFlags, SETTINGS_FLAG_INTEGER); }
 	bool IsFloat() { return IS_BIT_SET(cFlags, SETTINGS_FLAG_FLOAT); }
@@ -71,6 +85,8 @@ private:
 
 	static void                                LoadDefaults(bool bClient = false);
 	static SettingsValue                     * GetSetting(CString strSetting);
+	static SettingsValue                     * CreateSetting(CString strSetting, char cFlag);
+	static void                                NotifyChange(CString strSetting, SettingsValue * setting);
 
 public:
 	CSettings();
@@ -110,8 +126,36 @@ public:
 
 	static bool                                Remove(CString strSetting);
 
+	// Returns the value slot of a setting, creating a placeholder if it isn't defined (yet)
+	static SettingsValue                     * Intern(CString strSetting);
+
+	static bool                                AddChangeHandler(CString strSetting, SettingsChangeHandler_t pfnHandler, void * pUserData = NULL);
+	static bool                                RemoveChangeHandler(CString strSetting, SettingsChangeHandler_t pfnHandler, void * pUserData = NULL);
+
 	static void                                ParseCommandLine(int argc, char ** argv);
 	static void                                ParseCommandLine(char * szCommandLine);
 };
 
+// Resolves a setting name once, reading it afterwards doesn't need a lookup.
+// Don't construct these before main (e.g. as globals), use function statics or members
+template<typename T>
+class CSetting {
+private:
+	SettingsValue * m_pValue;
+
+public:
+	CSetting(const char * szSetting) { m_pValue = CSettings::Intern(szSetting); }
+
+	// Returns the same default as the CVAR_GET_* functions if the setting doesn't exist or has another type
+	T                                          Get() const;
+	operator                                   T() const { return Get(); }
+
+	bool                                       Exists() const { return m_pValue->Exists(); }
+};
+
+template<> inline bool CSetting<bool>::Get() const { return (m_pValue->IsBool() ? m_pValue->bValue : false); }
+template<> inline int CSetting<int>::Get() const { return (m_pValue->IsInteger() ? m_pValue->iValue : 0); }
+template<> inline float CSetting<float>::Get() const { return (m_pValue->IsFloat() ? m_pValue->fValue : 0.0f); }
+template<> inline CString CSetting<CString>::Get() const { return (m_pValue->IsString() ? m_pValue->strValue : CString()); }
+
 #endif // CSettings_h
\ No newline at end of file
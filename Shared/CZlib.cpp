@@ -9,7 +9,8 @@
 
 #include	"CZlib.h"
 #include	<assert.h>
-#include	<Libraries/zlib-1.2.5/zlib.h>
+#include	<string.h>
+#include	<zlib-1.2.5/zlib.h>
 
 #if defined(MSDOS) || defined(OS2) || defined(_WIN32) || defined(__CYGWIN__)
 #  include <fcntl.h>
@@ -105,4 +106,34 @@ int CZlib::Decompress(CString strFileName, CString strOutput)
 	fclose(out);
 
 	return iReturn;
-}
\ No newline at end of file
+}
+
+bool CZlib::Compress(const unsigned char * pSource, unsigned int uiLength, std::string& strDestination, bool bGzip)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+
+	// Adding 16 to the window bits makes zlib write a gzip wrapper
+	if(deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, (bGzip ? (MAX_WBITS + 16) : MAX_WBITS), 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	// Make room for the worst case so one call is enough
+	strDestination.resize(deflateBound(&strm, uiLength));
+
+	strm.next_in = (Bytef *)pSource;
+	strm.avail_in = uiLength;
+	strm.next_out = (Bytef *)&strDestination[0];
+	strm.avail_out = (uInt)strDestination.size();
+
+	int iReturn = deflate(&strm, Z_FINISH);
+	deflateEnd(&strm);
+
+	if(iReturn != Z_STREAM_END)
+	{
+		strDestination.clear();
+		return false;
+	}
+
+	strDestination.resize(strm.total_out);
+	return true;
+}
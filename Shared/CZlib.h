@@ -12,6 +12,7 @@
 
 #include "CString.h"
 #include <stdio.h>
+#include <string>
 
 class CZlib {
 public:
@@ -19,6 +20,9 @@ public:
 	static	int			Inflate(FILE * pSource, FILE * pDestination);
 	static	int			Decompress(CString strFileName, CString strOutput);
 
+	// Deflates a buffer, with a gzip header and trailer instead of the zlib ones if bGzip is set
+	static	bool		Compress(const unsigned char * pSource, unsigned int uiLength, std::string& strDestination, bool bGzip = false);
+
 };
 
 #endif // CZlib_h
\ No newline at end of file
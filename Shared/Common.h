@@ -190,7 +190,6 @@ using namespace std; // Conflicts with string(std::string) in network stuff
 #define D3DVEC_TO_CVEC(vec) &CVector3(vec.x, vec.y, vec.z)
 
 // Macros
-#define GET_RPC_CODEX(x) CString("IVMP0xF%dF", int(x)).Get()
 #define CHECK_PTR(x) if(!x) return false;
 #define CHECK_PTR_VOID(x) if(!x) return;
 
@@ -21,6 +21,14 @@ enum eRPCIdentifier : RPCIdentifier
 	RPC_NEW_PLAYER,
 	RPC_DELETE_PLAYER,
 	RPC_SYNC_PACKAGE,
+	RPC_ENTITY_STREAM_IN,
+	RPC_ENTITY_STREAM_OUT,
+	RPC_SYNC_SNAPSHOT,
+	RPC_RESOURCE_SYNC,
+	RPC_RESOURCE_MANIFEST,
+
+	// Must be last
+	RPC_MAX,
 };
 
 #endif // RPCIdentifier_h
\ No newline at end of file
@@ -26,6 +26,7 @@ public:
 		RESOURCE_EVENT,
 		GLOBAL_EVENT,
 		REMOTE_EVENT,
+		EVENT_TYPE_MAX,
 	};
 private:
 	CScriptVM * m_pVM;
@@ -51,27 +52,84 @@ public:
 	int GetRef() { return m_iRef; }
 
 	eEventType GetType() { return m_EventType; }
-	void Call(CScriptArguments* pArguments, CScriptArgument * pReturn = 0)
+
+	// Pushes the arguments onto the vm stack (for squirrel the root table as 'this' first),
+	// returns the stack top from before so it can be restored with PopArguments
+	static int PushArguments(CScriptVM * pVM, CScriptArguments * pArguments)
+	{
+		int iTop;
+
+		if(pVM->GetVMType() == LUA_VM)
+		{
+			iTop = lua_gettop(((CLuaVM*)pVM)->GetVM());
+		} else {
+			iTop = (int)sq_gettop(((CSquirrelVM*)pVM)->GetVM());
+			sq_pushroottable(((CSquirrelVM*)pVM)->GetVM());
+		}
+
+		if(pArguments)
+		{
+			for(auto pArgument = pArguments->begin(); pArgument != pArguments->end(); ++pArgument)
+				pArgument->Push(pVM);
+		}
+
+		return iTop;
+	}
+
+	static void PopArguments(CScriptVM * pVM, int iTop)
+	{
+		if(pVM->GetVMType() == LUA_VM)
+			lua_settop(((CLuaVM*)pVM)->GetVM(), iTop);
+		else
+			sq_settop(((CSquirrelVM*)pVM)->GetVM(), iTop);
+	}
+
+	// Calls the handler with the iArgumentCount values on top of the stack (pushed by PushArguments).
+	// They are only copied, so the next handler of the same vm can reuse them
+	void Call(int iArgumentCount, CScriptArgument * pReturn = 0)
 	{
 		if(m_pVM->GetVMType() == LUA_VM)
 		{
-			lua_rawgeti(((CLuaVM*)m_pVM)->GetVM(), LUA_REGISTRYINDEX, m_iRef);
-			lua_pcall(((CLuaVM*)m_pVM)->GetVM(), 0, LUA_MULTRET, NULL);
-			lua_settop(((CLuaVM*)m_pVM)->GetVM(), 0);
+			lua_State * pLuaVM = ((CLuaVM*)m_pVM)->GetVM();
+			int iTop = lua_gettop(pLuaVM);
+
+			lua_rawgeti(pLuaVM, LUA_REGISTRYINDEX, m_iRef);
+
+			for(int i = (iTop - iArgumentCount + 1); i <= iTop; i++)
+				lua_pushvalue(pLuaVM, i);
+
+			if(lua_pcall(pLuaVM, iArgumentCount, 1, 0) == 0 && pReturn)
+				pReturn->pushFromStack(m_pVM, -1);
+
+			lua_settop(pLuaVM, iTop);
 		} else {
+			SQVM * pSquirrelVM = ((CSquirrelVM*)m_pVM)->GetVM();
+			SQInteger iTop = sq_gettop(pSquirrelVM);
+
+			// Copy 'this' and the arguments
+			for(int i = 0; i <= iArgumentCount; i++)
+				sq_push(pSquirrelVM, -(iArgumentCount + 1));
+
 			SQObjectPtr res;
-			int iTop = sq_gettop(((CSquirrelVM*)m_pVM)->GetVM());
-			if(((CSquirrelVM*)m_pVM)->GetVM()->Call(m_func, 1, ((CSquirrelVM*)m_pVM)->GetVM()->_top-1, res, true))
+			if(pSquirrelVM->Call(m_func, (iArgumentCount + 1), (pSquirrelVM->_top - (iArgumentCount + 1)), res, true))
 			{
 				if(pReturn)
 				{
+					pSquirrelVM->Push(res);
 					pReturn->pushFromStack(m_pVM, -1);
 				}
 			}
-			sq_settop(((CSquirrelVM*)m_pVM)->GetVM(), iTop);
+			sq_settop(pSquirrelVM, iTop);
 		}
 	}
 
+	void Call(CScriptArguments* pArguments, CScriptArgument * pReturn = 0)
+	{
+		int iTop = PushArguments(m_pVM, pArguments);
+		Call((pArguments ? (int)pArguments->size() : 0), pReturn);
+		PopArguments(m_pVM, iTop);
+	}
+
 	bool equals(CEventHandler* other)
 	{
 		return (other->GetVM() 
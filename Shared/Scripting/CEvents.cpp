@@ -8,90 +8,179 @@
 //==============================================================================
 
 #include "CEvents.h"
+#include "CScriptProfiler.h"
 
 CEvents* CEvents::s_pInstance = 0;
 
+EventId CEvents::GetEventId(const CString& strName, bool bCreate)
+{
+	auto itEvent = m_eventIds.find(strName.Get());
+	if(itEvent != m_eventIds.end())
+		return itEvent->second;
+
+	if(!bCreate)
+		return INVALID_EVENT_ID;
+
+	// new - create the event
+	EventId eventId = (EventId)m_events.size();
+	m_events.push_back(Event());
+	m_events[eventId].strName = strName;
+	m_eventIds[strName.Get()] = eventId;
+	return eventId;
+}
 
-bool CEvents::Add(CString strName, CEventHandler* pEventHandler)
+bool CEvents::Add(const CString& strName, CEventHandler* pEventHandler)
 {
-	auto itEvent = m_Events.find(strName);
-	if(itEvent == m_Events.end())
+	std::vector<CEventHandler*>& handlers = m_events[GetEventId(strName, true)].handlers[pEventHandler->GetType()];
+
+	for(auto pEvent : handlers)
 	{
-		// new - create the event
-		auto ret = m_Events.insert(std::pair<CString, std::list<CEventHandler*>>(strName, std::list<CEventHandler*>()));
-		itEvent = ret.first;
+		if(pEventHandler->equals(pEvent))
+			return false;
+	}
 
-	} else {
-		for(auto pEvent : itEvent->second)
-		{
-			if(pEventHandler->equals(pEvent))
-				return false;
-		}
+	// Insert it behind the last handler of the same vm, so a call only has to push the arguments once per vm
+	auto itInsert = handlers.end();
+	for(auto it = handlers.begin(); it != handlers.end(); ++it)
+	{
+		if((*it)->GetVM() == pEventHandler->GetVM())
+			itInsert = (it + 1);
 	}
 
-	itEvent->second.push_back(pEventHandler);
+	handlers.insert(itInsert, pEventHandler);
 	return true;
 }
 
-CScriptArgument CEvents::Call(CString strName, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM)
+void CEvents::CallHandlers(EventId eventId, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM, CScriptArgument * pReturn)
 {
-	auto itEvent = m_Events.find(strName);
-	if(itEvent != m_Events.end())
+	if(eventId >= m_events.size() || EventType >= CEventHandler::EVENT_TYPE_MAX)
+		return;
+
+	int iArgumentCount = (pArguments ? (int)pArguments->size() : 0);
+	CScriptVM * pArgumentsVM = NULL;
+	int iTop = 0;
+
+	// Handlers may add events while we're calling them, so don't keep references into the vectors
+	for(size_t i = 0; i < m_events[eventId].handlers[EventType].size(); i++)
 	{
-		for(auto pEvent : itEvent->second)
+		CEventHandler * pEvent = m_events[eventId].handlers[EventType][i];
+
+		// Resource events only go to the vm which triggered them
+		if(EventType == CEventHandler::RESOURCE_EVENT && pEvent->GetVM() != pVM)
+			continue;
+
+		// Push the arguments once for every vm
+		if(pEvent->GetVM() != pArgumentsVM)
 		{
-			if(EventType == CEventHandler::eEventType::GLOBAL_EVENT
-				&& pEvent->GetType() == CEventHandler::GLOBAL_EVENT)
-			{
-				CScriptArgument ret;
-				pEvent->Call(pArguments, &ret);
-				return ret;
-			}
-			else if(EventType == CEventHandler::eEventType::RESOURCE_EVENT
-				&& pEvent->GetType() == CEventHandler::RESOURCE_EVENT
-				&& pEvent->GetVM() == pVM)
-			{
-				CScriptArgument ret;
-				pEvent->Call(pArguments, &ret);
-				return ret;
-			}
+			if(pArgumentsVM)
+				CEventHandler::PopArguments(pArgumentsVM, iTop);
+
+			pArgumentsVM = pEvent->GetVM();
+			iTop = CEventHandler::PushArguments(pArgumentsVM, pArguments);
 		}
+
+		if(CScriptProfiler::IsEnabled())
+		{
+			size_t sDepth = CScriptProfiler::EnterHandler(pEvent->GetVM()->GetResource(), CString("event:%s", m_events[eventId].strName.Get()));
+			pEvent->Call(iArgumentCount, pReturn);
+			CScriptProfiler::LeaveHandler(sDepth);
+		}
+		else
+			pEvent->Call(iArgumentCount, pReturn);
 	}
+
+	if(pArgumentsVM)
+		CEventHandler::PopArguments(pArgumentsVM, iTop);
+}
+
+CScriptArgument CEvents::Call(EventId eventId, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM)
+{
 	CScriptArgument ret;
 	ret.SetBool(false);
+	CallHandlers(eventId, pArguments, EventType, pVM, &ret);
 	return ret;
 }
 
-bool CEvents::Remove(CString strName, CEventHandler* pEventHandler)
+CScriptArgument CEvents::Call(const CString& strName, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM)
 {
-	auto itEvent = m_Events.find(strName);
-	if(itEvent != m_Events.end())
+	CScriptArgument ret;
+	ret.SetBool(false);
+	CallHandlers(GetEventId(strName), pArguments, EventType, pVM, &ret);
+	return ret;
+}
+
+bool CEvents::Remove(const CString& strName, CEventHandler* pEventHandler)
+{
+	EventId eventId = GetEventId(strName);
+	if(eventId == INVALID_EVENT_ID)
+		return false;
+
+	std::vector<CEventHandler*>& handlers = m_events[eventId].handlers[pEventHandler->GetType()];
+
+	for(auto it = handlers.begin(); it != handlers.end(); ++it)
 	{
-		for(auto pEvent = itEvent->second.begin(); pEvent != itEvent->second.end(); pEvent++)
+		if(pEventHandler->equals(*it))
 		{
-			if(pEventHandler->equals(*pEvent))
+			handlers.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CEvents::RemoveScript(CScriptVM* pVM)
+{
+	bool bRemoved = false;
+
+	for(auto& event : m_events)
+	{
+		for(int i = 0; i < CEventHandler::EVENT_TYPE_MAX; i++)
+		{
+			std::vector<CEventHandler*>& handlers = event.handlers[i];
+
+			for(auto it = handlers.begin(); it != handlers.end();)
 			{
-				itEvent->second.erase(pEvent);
-				if(itEvent->second.size() == 0)
+				if((*it)->GetVM() == pVM)
 				{
-					m_Events.erase(itEvent);
-					return true;
+					SAFE_DELETE(*it);
+					it = handlers.erase(it);
+					bRemoved = true;
 				}
+				else
+					++it;
 			}
 		}
 	}
+	return bRemoved;
+}
+
+bool CEvents::IsEventRegistered(const CString& eventName)
+{
+	EventId eventId = GetEventId(eventName);
+	if(eventId == INVALID_EVENT_ID)
+		return false;
+
+	for(int i = 0; i < CEventHandler::EVENT_TYPE_MAX; i++)
+	{
+		if(!m_events[eventId].handlers[i].empty())
+			return true;
+	}
 	return false;
 }
 
 void CEvents::Clear()
 {
-	for(auto pEvent : m_Events)
+	for(auto& event : m_events)
 	{
-		for(auto event : pEvent.second)
+		for(int i = 0; i < CEventHandler::EVENT_TYPE_MAX; i++)
 		{
-			SAFE_DELETE(event);
+			for(auto pEvent : event.handlers[i])
+			{
+				SAFE_DELETE(pEvent);
+			}
+			event.handlers[i].clear();
 		}
-		pEvent.second.clear();
 	}
-	m_Events.clear();
+	m_events.clear();
+	m_eventIds.clear();
 }
\ No newline at end of file
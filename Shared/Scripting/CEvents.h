@@ -11,16 +11,35 @@
 #define CEvents_h
 
 #include <Common.h>
-#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "CScriptVM.h"
 #include "CEventHandler.h"
 
+typedef unsigned int EventId;
+
+#define INVALID_EVENT_ID ((EventId)-1)
+
 class CEvents {
 
 private:
 	static CEvents* s_pInstance;
 
-	std::map<CString, std::list<CEventHandler*>> m_Events;
+	struct Event
+	{
+		CString strName;
+
+		// Handlers of every type, the handlers of one vm are kept next to each other
+		std::vector<CEventHandler*> handlers[CEventHandler::EVENT_TYPE_MAX];
+	};
+
+	// Event names are interned once, the ids stay valid until Clear
+	std::unordered_map<std::string, EventId> m_eventIds;
+	std::vector<Event> m_events;
+
+	void CallHandlers(EventId eventId, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM, CScriptArgument * pReturn);
+
 public:
 	CEvents()
 	{
@@ -30,16 +49,21 @@ public:
 	
 	static CEvents* GetInstance() { return s_pInstance; }
 
-	bool Add(CString strName, CEventHandler* pEventHandler);
+	// Returns the id of an event, registers the name if bCreate is set
+	EventId GetEventId(const CString& strName, bool bCreate = false);
+
+	bool Add(const CString& strName, CEventHandler* pEventHandler);
 
-	bool Remove(CString strName, CEventHandler* pEventHandler);
+	bool Remove(const CString& strName, CEventHandler* pEventHandler);
 
 	bool RemoveScript(CScriptVM* pVM);
-	bool IsEventRegistered(CString eventName);
+	bool IsEventRegistered(const CString& eventName);
 
 	void Clear();
 
-	CScriptArgument Call(CString strName, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM);
+	// Calls every handler of the given type, returns the result of the last one
+	CScriptArgument Call(EventId eventId, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM);
+	CScriptArgument Call(const CString& strName, CScriptArguments* pArguments, CEventHandler::eEventType EventType, CScriptVM * pVM);
 };
 
 #endif // CEvents_h
\ No newline at end of file
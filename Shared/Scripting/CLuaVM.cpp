@@ -12,6 +12,11 @@
 #include <SharedUtility.h>
 #include <CLogFile.h>
 #include "CScriptArgument.h"
+#include "ResourceSystem/CResourceManager.h"
+#include "CScriptProfiler.h"
+#include "CScriptCache.h"
+#include "CScriptBinding.h"
+#include <vector>
 
 CLuaVM::CLuaVM(CResource* pResource)
 	: CScriptVM(pResource),
@@ -19,30 +24,106 @@ CLuaVM::CLuaVM(CResource* pResource)
 {
 	m_pVM = luaL_newstate();
 	luaL_openlibs(m_pVM);
+
+	// Let natives find our resource
+	if(CResourceManager::GetInstance())
+		CResourceManager::GetInstance()->AddVM((int *)m_pVM, pResource);
 }
 
 CLuaVM::~CLuaVM()
 {
+	if(CResourceManager::GetInstance())
+		CResourceManager::GetInstance()->RemoveVM((int *)m_pVM);
+
+	// Free the profiler wrappers of our natives
+	CScriptProfiler::RemoveNatives(this);
+
 	lua_close(m_pVM);
 	m_pVM = NULL;
 
 }
 
+static int ChunkWriter(lua_State * pVM, const void * pData, size_t sSize, void * pUserData)
+{
+	((std::string *)pUserData)->append((const char *)pData, sSize);
+	return 0;
+}
+
+bool CLuaVM::Compile(const CString& strPath, const std::string& strSource, std::string& strChunk, CString& strError)
+{
+	// Use a private state, the resource vm might not exist yet
+	lua_State * pVM = luaL_newstate();
+
+	if(!pVM)
+	{
+		strError = "not enough memory";
+		return false;
+	}
+
+	CString strChunkName("@%s", strPath.Get());
+	bool bSuccess = false;
+
+	if(luaL_loadbufferx(pVM, strSource.data(), strSource.size(), strChunkName.Get(), NULL) != 0)
+	{
+		strError = lua_tostring(pVM, -1);
+	}
+	else
+	{
+		strChunk.clear();
+
+		if(lua_dump(pVM, ChunkWriter, &strChunk) == 0)
+			bSuccess = true;
+		else
+			strError = "failed to dump the chunk";
+	}
+
+	lua_close(pVM);
+	return bSuccess;
+}
+
 bool CLuaVM::LoadScript(CString script)
 {
-		CString scriptPath( "%s/%s", GetResource()->GetResourceDirectoryPath().Get(), script.Get());
-	
-	if(!SharedUtility::Exists(script.Get()) && luaL_loadfile(m_pVM, scriptPath.Get()) != 0)
+	std::string strChunk;
+	bool bCached = false;
+
+	if(!CScriptCache::Compile(GetResource(), LUA_VM, script, strChunk, bCached))
+		return false;
+
+	return RunScript(script, strChunk, bCached);
+}
+
+bool CLuaVM::RunScript(const CString& script, const std::string& strChunk, bool bCached)
+{
+	CString strChunkName("@%s/%s", GetResource()->GetResourceDirectoryPath().Get(), script.Get());
+
+	if(luaL_loadbufferx(m_pVM, strChunk.data(), strChunk.size(), strChunkName.Get(), "b") != 0)
 	{
-		CLogFile::Printf("[%s] Failed to load file %s.", GetResource()->GetName().Get(), script.Get());
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to load file %s: %s", GetResource()->GetName().Get(), script.Get(), lua_tostring(m_pVM, -1));
+		lua_pop(m_pVM, 1);
+
+		// Compile it from source instead, this also replaces the broken cache file
+		if(bCached)
+		{
+			std::string strSourceChunk;
+
+			if(!CScriptCache::Compile(GetResource(), LUA_VM, script, strSourceChunk, bCached, false))
+				return false;
+
+			return RunScript(script, strSourceChunk, false);
+		}
+
 		return false;
-	} else {
-		if(lua_pcall(m_pVM, 0, LUA_MULTRET, 0) == 0)
-			CLogFile::Printf("\t[%s] Loaded file %s.", GetResource()->GetName().Get(), script.Get());
-		return true;
 	}
-	CLogFile::Printf("[%s] Failed to load file %s.", GetResource()->GetName().Get(), script.Get());
-	return false;
+
+	if(lua_pcall(m_pVM, 0, 0, 0) != 0)
+	{
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to run file %s: %s", GetResource()->GetName().Get(), script.Get(), lua_tostring(m_pVM, -1));
+		lua_pop(m_pVM, 1);
+		return false;
+	}
+
+	CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_INFO, "\t[%s] Loaded file %s%s.", GetResource()->GetName().Get(), script.Get(), (bCached ? " (cached)" : ""));
+	return true;
 }
 
 bool CLuaVM::LoadScripts(std::list<CScript> scripts)
@@ -54,10 +135,50 @@ bool CLuaVM::LoadScripts(std::list<CScript> scripts)
 
 	return true;
 }
-int iFuncIndex = 1;
+static int ProfiledNative(lua_State * pVM)
+{
+	return CScriptProfiler::CallNative((CScriptProfiler::Native *)lua_touserdata(pVM, lua_upvalueindex(1)), (int *)pVM);
+}
+
 void CLuaVM::RegisterFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount, const char* szFunctionTemplate, bool bPushRootTable)
 {
-	lua_register(m_pVM, szFunctionName, (lua_CFunction)pfnFunction);
+	// Register it through the profiler wrapper, the native is its upvalue
+	lua_pushlightuserdata(m_pVM, CScriptProfiler::AddNative(this, GetResource(), szFunctionName, pfnFunction));
+	lua_pushcclosure(m_pVM, ProfiledNative, 1);
+	lua_setglobal(m_pVM, szFunctionName);
+}
+
+static void ProfilerHook(lua_State * pVM, lua_Debug * pDebug)
+{
+	// Collect the stack from the innermost function
+	std::vector<CString> frames;
+	lua_Debug frame;
+
+	for(int iLevel = 0; iLevel < PROFILER_MAX_STACK_DEPTH && lua_getstack(pVM, iLevel, &frame); iLevel++)
+	{
+		lua_getinfo(pVM, "Snl", &frame);
+		frames.push_back(CString("%s (%s:%d)", (frame.name ? frame.name : "?"), frame.short_src, frame.currentline));
+	}
+
+	CString strStack;
+
+	for(auto it = frames.rbegin(); it != frames.rend(); ++it)
+	{
+		if(!strStack.IsEmpty())
+			strStack += ";";
+
+		strStack += *it;
+	}
+
+	CScriptProfiler::AddSample(CResourceManager::GetInstance()->Get((int *)pVM), strStack);
+}
+
+void CLuaVM::SetProfilerHook(bool bEnabled)
+{
+	if(bEnabled)
+		lua_sethook(m_pVM, ProfilerHook, LUA_MASKCOUNT, PROFILER_LUA_SAMPLE_INSTRUCTIONS);
+	else
+		lua_sethook(m_pVM, NULL, 0, 0);
 }
 
 static int gc_obj(lua_State *L) {
@@ -72,40 +193,49 @@ void CLuaVM::RegisterScriptClass(const char* className, scriptFunction pfnFuncti
 	lua_pushcfunction(m_pVM, (lua_CFunction)pfnFunction);
 	lua_setglobal(m_pVM, m_strClassName.Get());
 
+	// All instances share the metatable, methods are looked up through __index
 	luaL_newmetatable(m_pVM, className);
+	lua_pushstring(m_pVM, className);
+	lua_setfield(m_pVM, -2, "__name");
 	lua_pushstring(m_pVM, "__gc");
 	lua_pushcfunction(m_pVM, gc_obj);
 	lua_settable(m_pVM, -3);
 
-	iFuncIndex = 0;
+	// Keep the method table on the stack until FinishScriptClass
+	lua_newtable(m_pVM);
+	lua_pushvalue(m_pVM, -1);
+	lua_setfield(m_pVM, -3, "__index");
+	lua_remove(m_pVM, -2);
+}
+
+void CLuaVM::FinishScriptClass()
+{
+	// Pop the method table
+	lua_pop(m_pVM, 1);
 }
 
 void CLuaVM::SetClassInstance(const char* szClassName, void * pInstance)
 {
-	lua_newtable(m_pVM);
-	lua_pushnumber(m_pVM, 0);
-	void** a = (void**)lua_newuserdata(m_pVM, sizeof(int*));
-	*a = pInstance;
-	luaL_getmetatable(m_pVM, szClassName);
-	lua_setmetatable(m_pVM, -2);
-	lua_settable(m_pVM, -3); // table[0] = obj;
-	iFuncIndex = 0;
+	// An instance is just a pointer with the class metatable
+	void ** ppInstance = (void **)lua_newuserdata(m_pVM, sizeof(void *));
+	*ppInstance = pInstance;
+	luaL_setmetatable(m_pVM, szClassName);
 }
 
 void * CLuaVM::GetClassInstance(const char* szClassName)
 {
-	int i = (int)lua_tonumber(m_pVM, lua_upvalueindex(1));
-	lua_pushnumber(m_pVM, 0);
-	lua_gettable(m_pVM, 1);
+	// The instance is 'self', skip it for the parameters
 	m_iStackIndex++;
-	return (void*)*(int**)lua_touserdata(m_pVM, -1);//luaL_checkudata(m_pVM, -1, szClassName);
+
+	return ScriptBinding::GetLuaInstance(m_pVM, 1);
 }
 
 void CLuaVM::RegisterClassFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount, const char* szFunctionTemplate)
 {
+	// Same wrapper as for global functions, profiled as Class.method
 	lua_pushstring(m_pVM, szFunctionName);
-	lua_pushnumber(m_pVM, iFuncIndex++);
-	lua_pushcclosure(m_pVM, (lua_CFunction)pfnFunction, 1);
+	lua_pushlightuserdata(m_pVM, CScriptProfiler::AddNative(this, GetResource(), CString("%s.%s", m_strClassName.Get(), szFunctionName), pfnFunction));
+	lua_pushcclosure(m_pVM, ProfiledNative, 1);
 	lua_settable(m_pVM, -3);
 }
 
@@ -144,7 +274,7 @@ void CLuaVM::Pop(bool& b, bool bDefaultValue)
 void CLuaVM::Pop(int& i)
 {
 	int argType = lua_type(m_pVM, m_iStackIndex);
-	if (argType == LUA_TBOOLEAN)
+	if (argType == LUA_TNUMBER || argType == LUA_TSTRING)
 	{
 		i = static_cast<int>(lua_tointeger(m_pVM, m_iStackIndex++));
 		return;
@@ -165,6 +295,8 @@ void CLuaVM::Pop(int& i, int iDefaultValue)
 		if(argType == LUA_TNONE || argType == LUA_TNIL)
 		{
 			i = iDefaultValue;
+			m_iStackIndex++;
+			return;
 		}
 	}
 
@@ -190,12 +322,14 @@ void CLuaVM::Pop(float& f, float fDefaultValue)
 	int argType = lua_type(m_pVM, m_iStackIndex);
 	if (argType == LUA_TNUMBER || argType == LUA_TSTRING)
 	{
-		f = static_cast<int>(lua_tonumber(m_pVM, m_iStackIndex++));
+		f = static_cast<float>(lua_tonumber(m_pVM, m_iStackIndex++));
 		return;
 	} else {
 		if(argType == LUA_TNONE || argType == LUA_TNIL)
 		{
 			f = fDefaultValue;
+			m_iStackIndex++;
+			return;
 		}
 	}
 
@@ -273,6 +407,11 @@ void CLuaVM::Push(const CString& str)
 	lua_pushstring(m_pVM, str.Get());
 }
 
+void CLuaVM::Push(const char* szString)
+{
+	lua_pushstring(m_pVM, szString);
+}
+
 void CLuaVM::Push(const CVector3& vec)
 {
 	Push(vec.fX);
@@ -284,7 +423,7 @@ void CLuaVM::PushArray(const CScriptArguments &array)
 {
 	int index = 0;
 	lua_newtable(m_pVM); 
-	for(auto pArgument : array.m_Arguments)
+	for(auto pArgument = array.begin(); pArgument != array.end(); ++pArgument)
 	{
 		lua_pushnumber(m_pVM, index);
 		pArgument->Push(this);
@@ -297,11 +436,11 @@ void CLuaVM::PushTable(const CScriptArguments &table)
 {
 	int index = 0;
 	lua_newtable(m_pVM); 
-	for(auto iter = table.m_Arguments.begin(); iter != table.m_Arguments.end(); iter++)
+	for(auto iter = table.begin(); iter != table.end(); iter++)
 	{
-		(*iter)->Push(this);
+		iter->Push(this);
 		++iter;
-		(*iter)->Push(this);
+		iter->Push(this);
 		lua_settable(m_pVM, -3);
 	}
 }
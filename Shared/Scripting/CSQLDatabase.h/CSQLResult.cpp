@@ -0,0 +1,211 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CSQLResult.cpp
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CSQLResult.h"
+#include <stdlib.h>
+#include <string.h>
+
+CSQLResult::CSQLResult()
+	: m_pArena(NULL),
+	m_pCells(NULL),
+	m_puiNames(NULL),
+	m_szText(NULL),
+	m_uiColumns(0),
+	m_uiRows(0),
+	m_iChanges(0),
+	m_llLastInsertId(0)
+{
+
+}
+
+CSQLResult::~CSQLResult()
+{
+	Clear();
+}
+
+void CSQLResult::Clear()
+{
+	if(m_pArena)
+	{
+		free(m_pArena);
+		m_pArena = NULL;
+	}
+
+	m_pCells = NULL;
+	m_puiNames = NULL;
+	m_szText = NULL;
+	m_uiColumns = 0;
+	m_uiRows = 0;
+	m_iChanges = 0;
+	m_llLastInsertId = 0;
+
+	m_cells.clear();
+	m_names.clear();
+	m_strText.clear();
+}
+
+void CSQLResult::AddColumn(const char * szName)
+{
+	m_names.push_back((unsigned int)m_strText.size());
+	m_strText.append(szName ? szName : "");
+	m_strText.push_back('\0');
+	m_uiColumns++;
+}
+
+void CSQLResult::AddNull()
+{
+	Cell cell;
+	cell.uiType = SQL_NULL;
+	cell.uiLength = 0;
+	cell.llInteger = 0;
+	m_cells.push_back(cell);
+}
+
+void CSQLResult::AddInteger(long long llValue)
+{
+	Cell cell;
+	cell.uiType = SQL_INTEGER;
+	cell.uiLength = 0;
+	cell.llInteger = llValue;
+	m_cells.push_back(cell);
+}
+
+void CSQLResult::AddFloat(double dValue)
+{
+	Cell cell;
+	cell.uiType = SQL_FLOAT;
+	cell.uiLength = 0;
+	cell.dFloat = dValue;
+	m_cells.push_back(cell);
+}
+
+void CSQLResult::AddText(const char * szValue, unsigned int uiLength)
+{
+	Cell cell;
+	cell.uiType = SQL_TEXT;
+	cell.uiLength = uiLength;
+	cell.uiOffset = (unsigned int)m_strText.size();
+	m_cells.push_back(cell);
+
+	m_strText.append(szValue, uiLength);
+	m_strText.push_back('\0');
+}
+
+void CSQLResult::Finish()
+{
+	if(m_pArena || m_uiColumns == 0)
+		return;
+
+	m_uiRows = (unsigned int)(m_cells.size() / m_uiColumns);
+
+	// The cells come first so they are aligned by malloc, the rest only needs 4 bytes
+	size_t sCells = (sizeof(Cell) * m_uiColumns * m_uiRows);
+	size_t sNames = (sizeof(unsigned int) * m_uiColumns);
+	m_pArena = (char *)malloc(sCells + sNames + m_strText.size());
+
+	m_pCells = (Cell *)m_pArena;
+	m_puiNames = (unsigned int *)(m_pArena + sCells);
+	m_szText = (m_pArena + sCells + sNames);
+
+	// Turn the rows into columns
+	for(unsigned int uiRow = 0; uiRow < m_uiRows; uiRow++)
+	{
+		for(unsigned int uiColumn = 0; uiColumn < m_uiColumns; uiColumn++)
+			m_pCells[(uiColumn * m_uiRows) + uiRow] = m_cells[(uiRow * m_uiColumns) + uiColumn];
+	}
+
+	memcpy(m_puiNames, m_names.data(), sNames);
+	memcpy((char *)m_szText, m_strText.data(), m_strText.size());
+
+	// Give the build buffers back
+	std::vector<Cell>().swap(m_cells);
+	std::vector<unsigned int>().swap(m_names);
+	std::string().swap(m_strText);
+}
+
+const CSQLResult::Cell * CSQLResult::GetCell(unsigned int uiColumn, unsigned int uiRow) const
+{
+	if(!m_pArena || uiColumn >= m_uiColumns || uiRow >= m_uiRows)
+		return NULL;
+
+	return &m_pCells[(uiColumn * m_uiRows) + uiRow];
+}
+
+const char * CSQLResult::GetColumnName(unsigned int uiColumn) const
+{
+	if(!m_pArena || uiColumn >= m_uiColumns)
+		return NULL;
+
+	return (m_szText + m_puiNames[uiColumn]);
+}
+
+int CSQLResult::FindColumn(const char * szName) const
+{
+	for(unsigned int i = 0; i < m_uiColumns; i++)
+	{
+		if(!strcmp(GetColumnName(i), szName))
+			return (int)i;
+	}
+
+	return -1;
+}
+
+CSQLResult::eValueType CSQLResult::GetType(unsigned int uiColumn, unsigned int uiRow) const
+{
+	const Cell * pCell = GetCell(uiColumn, uiRow);
+	return (pCell ? (eValueType)pCell->uiType : SQL_NULL);
+}
+
+long long CSQLResult::GetInteger(unsigned int uiColumn, unsigned int uiRow) const
+{
+	const Cell * pCell = GetCell(uiColumn, uiRow);
+
+	if(!pCell)
+		return 0;
+
+	if(pCell->uiType == SQL_INTEGER)
+		return pCell->llInteger;
+
+	if(pCell->uiType == SQL_FLOAT)
+		return (long long)pCell->dFloat;
+
+	if(pCell->uiType == SQL_TEXT)
+		return atoll(m_szText + pCell->uiOffset);
+
+	return 0;
+}
+
+double CSQLResult::GetFloat(unsigned int uiColumn, unsigned int uiRow) const
+{
+	const Cell * pCell = GetCell(uiColumn, uiRow);
+
+	if(!pCell)
+		return 0.0;
+
+	if(pCell->uiType == SQL_FLOAT)
+		return pCell->dFloat;
+
+	if(pCell->uiType == SQL_INTEGER)
+		return (double)pCell->llInteger;
+
+	if(pCell->uiType == SQL_TEXT)
+		return atof(m_szText + pCell->uiOffset);
+
+	return 0.0;
+}
+
+const char * CSQLResult::GetText(unsigned int uiColumn, unsigned int uiRow) const
+{
+	const Cell * pCell = GetCell(uiColumn, uiRow);
+
+	if(!pCell || pCell->uiType != SQL_TEXT)
+		return NULL;
+
+	return (m_szText + pCell->uiOffset);
+}
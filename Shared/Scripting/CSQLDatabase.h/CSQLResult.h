@@ -0,0 +1,97 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CSQLResult.h
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CSQLResult_h
+#define CSQLResult_h
+
+#include <Common.h>
+#include <string>
+#include <vector>
+
+// Rows of a query, stored column by column in one allocation once the query is done
+class CSQLResult {
+
+public:
+	enum eValueType
+	{
+		SQL_NULL,
+		SQL_INTEGER,
+		SQL_FLOAT,
+		SQL_TEXT,
+	};
+
+private:
+	struct Cell
+	{
+		unsigned int	uiType;
+		unsigned int	uiLength;	// Text only, without the terminator
+
+		union
+		{
+			long long		llInteger;
+			double			dFloat;
+			unsigned int	uiOffset;	// Text only, into the text block
+		};
+	};
+
+	// Arena layout: cells (column by column), column name offsets, text
+	char				* m_pArena;
+	Cell				* m_pCells;
+	unsigned int		* m_puiNames;
+	const char			* m_szText;
+
+	unsigned int		m_uiColumns;
+	unsigned int		m_uiRows;
+
+	int					m_iChanges;
+	long long			m_llLastInsertId;
+
+	// Filled while the rows are read, row by row
+	std::vector<Cell>			m_cells;
+	std::vector<unsigned int>	m_names;
+	std::string					m_strText;
+
+	const Cell			* GetCell(unsigned int uiColumn, unsigned int uiRow) const;
+
+	// Not copyable, the arena belongs to one result
+	CSQLResult(const CSQLResult&);
+	CSQLResult&			operator = (const CSQLResult&);
+
+public:
+	CSQLResult();
+	~CSQLResult();
+
+	void				Clear();
+
+	// Building, AddColumn for every column first, then the values row by row
+	void				AddColumn(const char * szName);
+	void				AddNull();
+	void				AddInteger(long long llValue);
+	void				AddFloat(double dValue);
+	void				AddText(const char * szValue, unsigned int uiLength);
+	void				SetChanges(int iChanges, long long llLastInsertId) { m_iChanges = iChanges; m_llLastInsertId = llLastInsertId; }
+
+	// Moves everything into the arena, the result can't be extended afterwards
+	void				Finish();
+
+	unsigned int		GetColumnCount() const { return m_uiColumns; }
+	unsigned int		GetRowCount() const { return m_uiRows; }
+	int					GetChanges() const { return m_iChanges; }
+	long long			GetLastInsertId() const { return m_llLastInsertId; }
+
+	const char			* GetColumnName(unsigned int uiColumn) const;
+	int					FindColumn(const char * szName) const;
+
+	eValueType			GetType(unsigned int uiColumn, unsigned int uiRow) const;
+	long long			GetInteger(unsigned int uiColumn, unsigned int uiRow) const;
+	double				GetFloat(unsigned int uiColumn, unsigned int uiRow) const;
+	const char			* GetText(unsigned int uiColumn, unsigned int uiRow) const;
+};
+
+#endif // CSQLResult_h
@@ -8,6 +8,7 @@
 //==============================================================================
 
 #include "CSQLite.h"
+#include <ctype.h>
 
 
 CSQLite::CSQLite()
@@ -17,59 +18,220 @@ CSQLite::CSQLite()
 	
 }
 
-bool CSQLite::Open(const char* szFileName)
+CSQLite::~CSQLite()
+{
+	Close();
+}
+
+bool CSQLite::Open(const char* szFileName, CString& strError)
 {
 	if(sqlite3_open(szFileName, &m_pSQLite) != SQLITE_OK)
 	{
-		printf(sqlite3_errmsg(m_pSQLite));
+		strError = sqlite3_errmsg(m_pSQLite);
+		sqlite3_close(m_pSQLite);
+		m_pSQLite = 0;
 		return false;
 	}
 	m_bIsOpen = true;
 	return true;
 }
 
-void CSQLite::Query(const char * szSql, std::map<const char*, std::list<const char*>> &result)
+sqlite3_stmt * CSQLite::Prepare(const char * szQuery, CString& strError)
+{
+	// Do we have it prepared already?
+	auto it = m_statementIndex.find(szQuery);
+
+	if(it != m_statementIndex.end())
+	{
+		// Mark it as most recently used
+		m_statements.splice(m_statements.begin(), m_statements, it->second);
+		return it->second->pStatement;
+	}
+
+	sqlite3_stmt * pStatement = NULL;
+	const char * szTail = NULL;
+
+	if(sqlite3_prepare_v2(m_pSQLite, szQuery, -1, &pStatement, &szTail) != SQLITE_OK)
+	{
+		strError = sqlite3_errmsg(m_pSQLite);
+		return NULL;
+	}
+
+	// Only one statement per query, the cache entry has to stand for the whole string
+	while(szTail && isspace((unsigned char)*szTail))
+		szTail++;
+
+	if(szTail && *szTail && strcmp(szTail, ";"))
+	{
+		sqlite3_finalize(pStatement);
+		strError = "only one statement per query is supported";
+		return NULL;
+	}
+
+	// Empty query (e.g. only a comment)
+	if(!pStatement)
+	{
+		strError = "empty query";
+		return NULL;
+	}
+
+	Statement statement;
+	statement.strQuery = szQuery;
+	statement.pStatement = pStatement;
+	m_statements.push_front(statement);
+	m_statementIndex[statement.strQuery] = m_statements.begin();
+
+	// Finalize the least recently used one if the cache is full
+	if(m_statements.size() > SQLITE_STATEMENT_CACHE_SIZE)
+	{
+		m_statementIndex.erase(m_statements.back().strQuery);
+		sqlite3_finalize(m_statements.back().pStatement);
+		m_statements.pop_back();
+	}
+
+	return pStatement;
+}
+
+bool CSQLite::Bind(sqlite3_stmt * pStatement, const CScriptArguments& parameters, CString& strError)
 {
+	if((int)parameters.size() != sqlite3_bind_parameter_count(pStatement))
+	{
+		strError.Format("expected %d parameter(s), got %d", sqlite3_bind_parameter_count(pStatement), (int)parameters.size());
+		return false;
+	}
+
+	int iIndex = 1;
+
+	for(auto pParameter = parameters.begin(); pParameter != parameters.end(); ++pParameter, ++iIndex)
+	{
+		int iResult;
+
+		switch(pParameter->GetType())
+		{
+		case CScriptArgument::ST_INTEGER:
+			iResult = sqlite3_bind_int(pStatement, iIndex, pParameter->GetInteger());
+			break;
+		case CScriptArgument::ST_BOOL:
+			iResult = sqlite3_bind_int(pStatement, iIndex, (pParameter->GetBool() ? 1 : 0));
+			break;
+		case CScriptArgument::ST_FLOAT:
+			iResult = sqlite3_bind_double(pStatement, iIndex, pParameter->GetFloat());
+			break;
+		case CScriptArgument::ST_STRING:
+			iResult = sqlite3_bind_text(pStatement, iIndex, pParameter->GetString(), -1, SQLITE_TRANSIENT);
+			break;
+		default:
+			iResult = sqlite3_bind_null(pStatement, iIndex);
+			break;
+		}
+
+		if(iResult != SQLITE_OK)
+		{
+			strError = sqlite3_errmsg(m_pSQLite);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CSQLite::Query(const char * szQuery, const CScriptArguments& parameters, CSQLResult& result, CString& strError)
+{
+	result.Clear();
+
 	if(!m_bIsOpen)
 	{
-		printf("Database is not open");
-		return;
+		strError = "database is not open";
+		return false;
 	}
 
-	sqlite3_exec(m_pSQLite, szSql, 
-		[] (void *NotUsed, int argc, char **argv, char **azColName) -> int
+	sqlite3_stmt * pStatement = Prepare(szQuery, strError);
+
+	if(!pStatement)
+		return false;
+
+	bool bSuccess = Bind(pStatement, parameters, strError);
+
+	if(bSuccess)
+	{
+		int iColumns = sqlite3_column_count(pStatement);
+
+		for(int i = 0; i < iColumns; i++)
+			result.AddColumn(sqlite3_column_name(pStatement, i));
+
+		while(true)
 		{
-			std::map<const char*, std::list<const char*>> *result = (std::map<const char*, std::list<const char*>>*)NotUsed;
-			int columnCount = argc;
-			for(int n = 0; n < columnCount; ++n)
+			int iResult = sqlite3_step(pStatement);
+
+			if(iResult == SQLITE_DONE)
+				break;
+
+			if(iResult != SQLITE_ROW)
+			{
+				strError = sqlite3_errmsg(m_pSQLite);
+				bSuccess = false;
+				break;
+			}
+
+			for(int i = 0; i < iColumns; i++)
 			{
-				int valueLength = strlen(argv[n]);
-				int nameLength = strlen(azColName[n]);
-
-				char* columnName = new char[nameLength+1];
-				memcpy(columnName, azColName[n], nameLength);
-				columnName[nameLength] = 0;
-
-				char* columnValue = new char[valueLength+1];
-				memcpy(columnValue, argv[n], valueLength);
-				columnValue[valueLength] = 0;
-				
-				auto column = result->find(columnName);
-				if(column == result->end())
+				switch(sqlite3_column_type(pStatement, i))
 				{
-					result->insert(std::pair<const char*, std::list<const char*>>(columnName, std::list<const char*>()));
+				case SQLITE_INTEGER:
+					result.AddInteger(sqlite3_column_int64(pStatement, i));
+					break;
+				case SQLITE_FLOAT:
+					result.AddFloat(sqlite3_column_double(pStatement, i));
+					break;
+				case SQLITE_NULL:
+					result.AddNull();
+					break;
+				default:
+					// Text and blobs, the length has to be read after the value
+					{
+						const char * szValue = (const char *)sqlite3_column_text(pStatement, i);
+						result.AddText(szValue, (unsigned int)sqlite3_column_bytes(pStatement, i));
+					}
+					break;
 				}
-
-				column->second.push_back(columnValue);
 			}
-			return 1;
 		}
-		, &result, 0);
+
+		result.SetChanges(sqlite3_changes(m_pSQLite), sqlite3_last_insert_rowid(m_pSQLite));
+	}
+
+	// Make the statement ready for the next use
+	sqlite3_reset(pStatement);
+	sqlite3_clear_bindings(pStatement);
+
+	if(!bSuccess)
+	{
+		result.Clear();
+		return false;
+	}
+
+	result.Finish();
+	return true;
 }
 
+void CSQLite::ClearStatements()
+{
+	for(auto it = m_statements.begin(); it != m_statements.end(); ++it)
+		sqlite3_finalize(it->pStatement);
+
+	m_statements.clear();
+	m_statementIndex.clear();
+}
 
 void CSQLite::Close()
 {
+	ClearStatements();
+
+	if(m_pSQLite)
+	{
+		sqlite3_close(m_pSQLite);
+		m_pSQLite = 0;
+	}
+
 	m_bIsOpen = false;
-	sqlite3_close(m_pSQLite);
-}
\ No newline at end of file
+}
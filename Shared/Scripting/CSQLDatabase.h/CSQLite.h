@@ -1,7 +1,7 @@
 //============== IV: Multiplayer - http://code.iv-multiplayer.com ==============
 //
 // File: CSQLite.h
-// Project: Client.Core
+// Project: Shared
 // Author: xForce <xf0rc3.11@gmail.com>
 // License: See LICENSE in root directory
 //
@@ -10,24 +10,47 @@
 #ifndef CSQLite_h
 #define CSQLite_h
 
-
-#include <sqlite/sqlite3.h>
-#include <map>
+#include <Common.h>
+#include <Sqlite/sqlite3.h>
 #include <list>
+#include <string>
+#include <unordered_map>
+#include "CSQLResult.h"
+#include "../CScriptArguments.h"
+
+// Prepared statements kept per connection, the least recently used one gets finalized first
+#define SQLITE_STATEMENT_CACHE_SIZE 32
 
 class CSQLite {
 private:
+	struct Statement
+	{
+		std::string		strQuery;
+		sqlite3_stmt	* pStatement;
+	};
+
 	sqlite3 * m_pSQLite;
 	bool	  m_bIsOpen;
+
+	// Most recently used first
+	std::list<Statement>	m_statements;
+	std::unordered_map<std::string, std::list<Statement>::iterator>	m_statementIndex;
+
+	sqlite3_stmt *	Prepare(const char * szQuery, CString& strError);
+	bool			Bind(sqlite3_stmt * pStatement, const CScriptArguments& parameters, CString& strError);
+	void			ClearStatements();
+
 public:
 	CSQLite();
 	~CSQLite();
 
-	bool Open(const char* szFileName);
-	void Query(const char* szSql, std::map<const char*, std::list<const char*>> &result);
+	bool Open(const char* szFileName, CString& strError);
+
+	// Runs one statement, the parameters are bound to its ?s in order
+	bool Query(const char* szQuery, const CScriptArguments& parameters, CSQLResult& result, CString& strError);
 	void Close();
 
 	bool IsOpen() { return m_bIsOpen; }
 };
 
-#endif // CSQLite_h
\ No newline at end of file
+#endif // CSQLite_h
@@ -8,6 +8,7 @@
 //==============================================================================
 
 #include "CScriptArgument.h"
+#include "CScriptArguments.h"
 #include "CScriptVM.h"
 #include <assert.h>
 
@@ -16,19 +17,53 @@ CScriptArgument::~CScriptArgument()
 	reset();
 }
 
-CScriptArgument::CScriptArgument(CScriptArgument& p)
+CScriptArgument::CScriptArgument(const CScriptArgument& p)
 {
+	m_eType = ST_INVALID;
 	set(p);
 }
 
+CScriptArgument::CScriptArgument(const CScriptArguments& array, bool isArray)
+{
+	m_eType = (isArray ? ST_ARRAY : ST_TABLE);
+	m_bInlineString = false;
+	data.pArray = new CScriptArguments(array);
+}
+
+CScriptArgument& CScriptArgument::operator = (const CScriptArgument& p)
+{
+	if(this != &p)
+		set(p);
+
+	return *this;
+}
+
 void CScriptArgument::reset()
 {
-	if(m_eType == ST_STRING)
+	if(m_eType == ST_STRING && !m_bInlineString)
 		delete data.str;
 	else if(m_eType == ST_ARRAY || m_eType == ST_TABLE)
 		delete data.pArray;
 
 	m_eType = ST_INVALID;
+	m_bInlineString = false;
+}
+
+void CScriptArgument::SetStringInternal(const char* s, size_t sLength)
+{
+	m_eType = ST_STRING;
+
+	// Short strings don't need an allocation
+	if(sLength < SCRIPT_ARGUMENT_INLINE_STRING)
+	{
+		memcpy(data.szInline, s, sLength + 1);
+		m_bInlineString = true;
+	}
+	else
+	{
+		data.str = new CString(s);
+		m_bInlineString = false;
+	}
 }
 
 
@@ -53,7 +88,7 @@ void CScriptArgument::Push(CScriptVM * pVM)
 		break;
 	case CScriptArgument::ArgumentType::ST_STRING:
 		{
-			pVM->Push(CString(GetString()));
+			pVM->Push(GetString());
 		}
 		break;
 	case CScriptArgument::ArgumentType::ST_ARRAY:
@@ -73,11 +108,11 @@ void CScriptArgument::Push(CScriptVM * pVM)
 }
 
 
-void CScriptArgument::set(CScriptArgument& p)
+void CScriptArgument::set(const CScriptArgument& p)
 {
-	m_eType = p.GetType();
+	reset();
 
-	switch(m_eType)
+	switch(p.GetType())
 	{
 	case ST_INVALID:
 		break;
@@ -91,13 +126,31 @@ void CScriptArgument::set(CScriptArgument& p)
 		data.f = p.data.f;
 		break;
 	case ST_STRING:
-		data.str = new CString(p.data.str->Get());
+		if(p.m_bInlineString)
+			SetStringInternal(p.data.szInline, strlen(p.data.szInline));
+		else
+			SetStringInternal(p.data.str->Get(), p.data.str->GetLength());
 		break;
 	case ST_ARRAY:
 	case ST_TABLE:
 		data.pArray = new CScriptArguments(*p.data.pArray);
 		break;
 	}
+
+	m_eType = p.GetType();
+}
+
+void CScriptArgument::take(CScriptArgument& p)
+{
+	reset();
+
+	// The union is plain data, so the owned pointers just change hands
+	m_eType = p.m_eType;
+	m_bInlineString = p.m_bInlineString;
+	memcpy(&data, &p.data, sizeof(data));
+
+	p.m_eType = ST_INVALID;
+	p.m_bInlineString = false;
 }
 
 
@@ -135,9 +188,9 @@ bool CScriptArgument::pushFromStack(CScriptVM * pVM, int idx)
 		break;
 	case CScriptArgument::ArgumentType::ST_TABLE:
 		{
-			CScriptArguments table;
-			pVM->PopTable(table);
-			SetTable(&table);
+			CScriptArguments * pTable = new CScriptArguments();
+			pVM->PopTable(*pTable);
+			SetTable(pTable);
 			m_eType = CScriptArgument::ArgumentType::ST_TABLE;
 		}	
 		break;
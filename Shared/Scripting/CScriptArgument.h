@@ -12,7 +12,9 @@
 
 #include <Common.h>
 #include <lua/lua.hpp>
-#include "CScriptArguments.h"
+
+// Strings up to this length (including the terminator) are stored inside the argument
+#define SCRIPT_ARGUMENT_INLINE_STRING 24
 
 class CScriptVM;
 class CScriptArguments;
@@ -31,6 +33,10 @@ public:
 	};
 private:
 	ArgumentType m_eType;
+	bool         m_bInlineString;
+
+	void         SetStringInternal(const char* s, size_t sLength);
+
 public:
 
 	union
@@ -40,37 +46,43 @@ public:
 		float f;
 		CString * str;
 		CScriptArguments * pArray;
+		char szInline[SCRIPT_ARGUMENT_INLINE_STRING];
 	} data;
 
-	CScriptArgument() { m_eType = ST_INVALID;}
-	CScriptArgument(int i) { m_eType = ST_INTEGER; data.i = i; }
-	CScriptArgument(bool b) { m_eType = ST_BOOL; data.b = b; }
-	CScriptArgument(float f) { m_eType = ST_FLOAT; data.f = f; }
-	CScriptArgument(CScriptArgument& p);
-	CScriptArgument(CString str) { m_eType = ST_STRING; data.str = new CString(str); }
-	CScriptArgument(const CScriptArguments& array, bool isArray = true) { m_eType = (isArray ? ST_ARRAY : ST_TABLE); data.pArray = new CScriptArguments(array); }
+	CScriptArgument() { m_eType = ST_INVALID; m_bInlineString = false; }
+	CScriptArgument(int i) { m_eType = ST_INTEGER; m_bInlineString = false; data.i = i; }
+	CScriptArgument(bool b) { m_eType = ST_BOOL; m_bInlineString = false; data.b = b; }
+	CScriptArgument(float f) { m_eType = ST_FLOAT; m_bInlineString = false; data.f = f; }
+	CScriptArgument(const CScriptArgument& p);
+	CScriptArgument(const CString& str) { m_eType = ST_INVALID; SetString(str.Get()); }
+	CScriptArgument(const CScriptArguments& array, bool isArray = true);
 	~CScriptArgument();
 
-	ArgumentType		 GetType() { return m_eType; }
+	CScriptArgument&	 operator = (const CScriptArgument& p);
+
+	ArgumentType		 GetType() const { return m_eType; }
 
 	void				 reset();
 
 	void				 Push(CScriptVM* pVM);
 
-	void                 set(CScriptArgument& p);
+	void                 set(const CScriptArgument& p);
+
+	// Takes over the value of p without copying it, p is left invalid
+	void                 take(CScriptArgument& p);
 
 	void                 SetNull()                 { reset(); m_eType = ST_INVALID; }
 	void                 SetInteger(int i)         { reset(); m_eType = ST_INTEGER; data.i = i; }
 	void                 SetBool   (bool b)        { reset(); m_eType = ST_BOOL; data.b = b; }
 	void                 SetFloat  (float f)       { reset(); m_eType = ST_FLOAT; data.f = f; }
-	void                 SetString (const char* s) { reset(); m_eType = ST_STRING; data.str = new CString(s); }
+	void                 SetString (const char* s) { reset(); SetStringInternal(s, strlen(s)); }
 	void                 SetArray(CScriptArguments * pArray) { reset(); m_eType = ST_ARRAY; data.pArray = pArray; }
 	void                 SetTable(CScriptArguments * pTable) { reset(); m_eType = ST_TABLE; data.pArray = pTable; }
 
 	int                  GetInteger() const { return (m_eType == ST_INTEGER) ? data.i : 0; }
 	bool                 GetBool()    const { return (m_eType == ST_BOOL)    ? data.b : false; }
 	float                GetFloat()   const { return (m_eType == ST_FLOAT)   ? data.f : 0.0f; }
-	const char         * GetString()  const { return (m_eType == ST_STRING)  ? data.str->Get() : NULL; }
+	const char         * GetString()  const { return (m_eType == ST_STRING)  ? (m_bInlineString ? data.szInline : data.str->Get()) : NULL; }
 	CScriptArguments   * GetTable() const { return (m_eType == ST_TABLE) ? data.pArray : NULL; }
 	CScriptArguments   * GetArray() const { return (m_eType == ST_ARRAY) ? data.pArray : NULL; }
 
@@ -14,65 +14,118 @@
 CScriptArguments::~CScriptArguments()
 {
 	reset();
+
+	if(m_pArguments != m_inlineArguments)
+		delete [] m_pArguments;
 }
 
 CScriptArguments::CScriptArguments()
 {
-	reset();
+	m_pArguments = m_inlineArguments;
+	m_uiCount = 0;
+	m_uiCapacity = SCRIPT_ARGUMENTS_INLINE;
+}
+
+CScriptArguments::CScriptArguments(const CScriptArguments& p)
+{
+	m_pArguments = m_inlineArguments;
+	m_uiCount = 0;
+	m_uiCapacity = SCRIPT_ARGUMENTS_INLINE;
+
+	for(auto pArgument = p.begin(); pArgument != p.end(); ++pArgument)
+		next()->set(*pArgument);
+}
+
+CScriptArguments& CScriptArguments::operator = (const CScriptArguments& p)
+{
+	if(this != &p)
+	{
+		reset();
+
+		for(auto pArgument = p.begin(); pArgument != p.end(); ++pArgument)
+			next()->set(*pArgument);
+	}
+
+	return *this;
 }
 
 void CScriptArguments::reset()
 {
-	for(auto pArgument : m_Arguments)
-		delete pArgument;
+	// Keep the storage around, the container is usually filled again right away
+	for(unsigned int i = 0; i < m_uiCount; i++)
+		m_pArguments[i].reset();
 
-	m_Arguments.clear();
+	m_uiCount = 0;
 }
 
-CScriptArguments::CScriptArguments(const CScriptArguments& p)
+CScriptArgument * CScriptArguments::next()
 {
-	for(auto pArgument : p.m_Arguments)
-		m_Arguments.push_back(new CScriptArgument(*pArgument));
+	// Are we out of space?
+	if(m_uiCount == m_uiCapacity)
+	{
+		unsigned int uiCapacity = (m_uiCapacity * 2);
+		CScriptArgument * pArguments = new CScriptArgument[uiCapacity];
+
+		// Move the arguments over without copying strings or arrays
+		for(unsigned int i = 0; i < m_uiCount; i++)
+			pArguments[i].take(m_pArguments[i]);
+
+		if(m_pArguments != m_inlineArguments)
+			delete [] m_pArguments;
+
+		m_pArguments = pArguments;
+		m_uiCapacity = uiCapacity;
+	}
+
+	return &m_pArguments[m_uiCount++];
 }
 
 void CScriptArguments::push(int i)
 {
-	m_Arguments.push_back(new CScriptArgument(i));
+	next()->SetInteger(i);
 }
 
 void CScriptArguments::push(bool b)
 {
-	m_Arguments.push_back(new CScriptArgument(b));
+	next()->SetBool(b);
 }
 
 void CScriptArguments::push(float f)
 {
-	m_Arguments.push_back(new CScriptArgument(f));
+	next()->SetFloat(f);
 }
 
 void CScriptArguments::push(const char* c)
 {
-	m_Arguments.push_back(new CScriptArgument(CString(c)));
+	next()->SetString(c);
+}
+
+void CScriptArguments::push(const CString& str)
+{
+	next()->SetString(str.Get());
 }
 
-void CScriptArguments::push(CString str)
+void CScriptArguments::push(const CScriptArgument &arg)
 {
-	m_Arguments.push_back(new CScriptArgument(CString(str)));
+	next()->set(arg);
 }
 
 void CScriptArguments::push(const CScriptArguments &array, bool isArray)
 {
-	m_Arguments.push_back(new CScriptArgument(array, isArray));
+	if(isArray)
+		next()->SetArray(new CScriptArguments(array));
+	else
+		next()->SetTable(new CScriptArguments(array));
 }
 
 void CScriptArguments::push(CScriptArguments* pArray, bool isArray)
 {
-	m_Arguments.push_back(new CScriptArgument(*pArray, isArray));
+	push(*pArray, isArray);
 }
 
 void CScriptArguments::pushVector3(const CVector3 &vec3)
 {
-	m_Arguments.push_back(new CScriptArgument(vec3.fX));
-	m_Arguments.push_back(new CScriptArgument(vec3.fY));
-	m_Arguments.push_back(new CScriptArgument(vec3.fZ));
+	next()->SetFloat(vec3.fX);
+	next()->SetFloat(vec3.fY);
+	next()->SetFloat(vec3.fZ);
 }
\ No newline at end of file
@@ -11,27 +11,38 @@
 #define CScriptArguments_h
 
 #include <Common.h>
-#include <list>
+#include "CScriptArgument.h"
+
+// Number of arguments stored inside the container before it spills to the heap
+#define SCRIPT_ARGUMENTS_INLINE 8
 
-class CScriptArgument;
 class CScriptVM;
 
 class CScriptArguments {
 
 private:
-	
+	// Points to either m_inlineArguments or a heap block once we outgrew it
+	CScriptArgument    * m_pArguments;
+	unsigned int         m_uiCount;
+	unsigned int         m_uiCapacity;
+	CScriptArgument      m_inlineArguments[SCRIPT_ARGUMENTS_INLINE];
+
+	CScriptArgument    * next();
+
 public:
 	CScriptArguments();
 	CScriptArguments(const CScriptArguments& p);
 	~CScriptArguments();
 
+	CScriptArguments&    operator = (const CScriptArguments& p);
+
 	void reset();
 
 	void push(int i);
 	void push(bool b);
 	void push(float f);
 	void push(const char* c);
-	void push(CString str);
+	void push(const CString& str);
 	void push(const CScriptArgument &arg);
 	void push(const CScriptArguments &array, bool isArray);
 	void push(CScriptArguments* pArray, bool isArray);
@@ -40,7 +51,10 @@ public:
 	CScriptArgument pop();
 	bool popVector3(CVector3 &vec3);
 
-	std::list<CScriptArgument *> m_Arguments;
+	unsigned int         size() const { return m_uiCount; }
+	CScriptArgument    * begin() const { return m_pArguments; }
+	CScriptArgument    * end() const { return (m_pArguments + m_uiCount); }
+	CScriptArgument    & operator [] (unsigned int uiIndex) const { return m_pArguments[uiIndex]; }
 };
 
 #endif // CScriptArguments_h
\ No newline at end of file
@@ -0,0 +1,433 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CScriptBinding.h
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CScriptBinding_h
+#define CScriptBinding_h
+
+#include <Common.h>
+#include <lua/lua.hpp>
+#include <Squirrel/squirrel.h>
+#include <type_traits>
+#include "CScriptVM.h"
+
+// Generates a native for a plain C++ function, e.g. BIND_NATIVE(pVM, CMathNatives::GetDistanceBetweenPoints2D).
+// The parameters are read straight from the lua/squirrel stack and type checked before the call,
+// the return value (if any) is pushed back. A pointer as first parameter receives the class instance.
+// Functions can take up to nine parameters
+#define BIND_NATIVE(pVM, function) ScriptBinding::Native<decltype(&function), &function>::Get(pVM)
+
+namespace ScriptBinding
+{
+	template<class T> struct Decay { typedef typename std::remove_cv<typename std::remove_reference<T>::type>::type Type; };
+
+	// Lua values, the stack starts at 1
+	template<class T> struct LuaValue;
+
+	template<> struct LuaValue<int>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "integer"; }
+		static bool Check(lua_State * L, int idx) { return (lua_isnumber(L, idx) != 0); }
+		static int Get(lua_State * L, int idx) { return (int)lua_tointeger(L, idx); }
+		static void Push(lua_State * L, int i) { lua_pushinteger(L, i); }
+	};
+
+	template<> struct LuaValue<float>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "float"; }
+		static bool Check(lua_State * L, int idx) { return (lua_isnumber(L, idx) != 0); }
+		static float Get(lua_State * L, int idx) { return (float)lua_tonumber(L, idx); }
+		static void Push(lua_State * L, float f) { lua_pushnumber(L, f); }
+	};
+
+	template<> struct LuaValue<bool>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "bool"; }
+		static bool Check(lua_State * L, int idx) { return lua_isboolean(L, idx); }
+		static bool Get(lua_State * L, int idx) { return (lua_toboolean(L, idx) != 0); }
+		static void Push(lua_State * L, bool b) { lua_pushboolean(L, b); }
+	};
+
+	template<> struct LuaValue<const char *>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "string"; }
+		static bool Check(lua_State * L, int idx) { return (lua_isstring(L, idx) != 0); }
+		static const char * Get(lua_State * L, int idx) { return lua_tostring(L, idx); }
+		static void Push(lua_State * L, const char * sz) { lua_pushstring(L, sz); }
+	};
+
+	template<> struct LuaValue<CString>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "string"; }
+		static bool Check(lua_State * L, int idx) { return (lua_isstring(L, idx) != 0); }
+		static CString Get(lua_State * L, int idx) { size_t sLength = 0; const char * sz = lua_tolstring(L, idx, &sLength); CString str; str.Set(sz, sLength); return str; }
+		static void Push(lua_State * L, const CString& str) { lua_pushlstring(L, str.Get(), str.GetLength()); }
+	};
+
+	template<> struct LuaValue<CVector3>
+	{
+		enum { Slots = 3 };
+		static const char * Name() { return "float"; }
+		static bool Check(lua_State * L, int idx) { return (lua_isnumber(L, idx) && lua_isnumber(L, idx + 1) && lua_isnumber(L, idx + 2)); }
+		static CVector3 Get(lua_State * L, int idx) { return CVector3((float)lua_tonumber(L, idx), (float)lua_tonumber(L, idx + 1), (float)lua_tonumber(L, idx + 2)); }
+
+		// Same layout as CLuaVM::PushArray
+		static void Push(lua_State * L, const CVector3& vec)
+		{
+			lua_createtable(L, 0, 3);
+			lua_pushnumber(L, vec.fX);
+			lua_rawseti(L, -2, 0);
+			lua_pushnumber(L, vec.fY);
+			lua_rawseti(L, -2, 1);
+			lua_pushnumber(L, vec.fZ);
+			lua_rawseti(L, -2, 2);
+		}
+	};
+
+	// Returns the pointer of a class instance, a userdata with the metatable of its class (see CLuaVM::SetClassInstance).
+	// The metatable knows the class name, anything else (tables, other userdata) gives NULL
+	inline void * GetLuaInstance(lua_State * L, int idx)
+	{
+		idx = lua_absindex(L, idx);
+
+		if(!lua_getmetatable(L, idx))
+			return NULL;
+
+		void ** ppInstance = NULL;
+		lua_getfield(L, -1, "__name");
+
+		if(lua_type(L, -1) == LUA_TSTRING)
+			ppInstance = (void **)luaL_testudata(L, idx, lua_tostring(L, -1));
+
+		lua_pop(L, 2);
+		return (ppInstance ? *ppInstance : NULL);
+	}
+
+	// Class instance
+	template<class T> struct LuaValue<T *>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "instance"; }
+		static bool Check(lua_State * L, int idx) { return (Get(L, idx) != NULL); }
+		static T * Get(lua_State * L, int idx) { return (T *)GetLuaInstance(L, idx); }
+	};
+
+	// Type tag of the classes registered by CSquirrelVM, instances of other classes don't carry our pointers
+	inline SQUserPointer GetSquirrelClassTag()
+	{
+		static char cTag;
+		return &cTag;
+	}
+
+	// Returns the pointer of an instance of a registered class (or a script class extending one), NULL for anything else
+	inline void * GetSquirrelInstance(HSQUIRRELVM v, int idx)
+	{
+		SQUserPointer pInstance = NULL;
+
+		if(SQ_FAILED(sq_getinstanceup(v, idx, &pInstance, GetSquirrelClassTag())))
+			return NULL;
+
+		return pInstance;
+	}
+
+	// Squirrel values, index 1 is 'this' so the parameters start at 2
+	template<class T> struct SquirrelValue;
+
+	template<> struct SquirrelValue<int>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "integer"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return ((sq_gettype(v, idx) & SQOBJECT_NUMERIC) != 0); }
+		static int Get(HSQUIRRELVM v, int idx) { SQInteger i = 0; sq_getinteger(v, idx, &i); return (int)i; }
+		static void Push(HSQUIRRELVM v, int i) { sq_pushinteger(v, i); }
+	};
+
+	template<> struct SquirrelValue<float>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "float"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return ((sq_gettype(v, idx) & SQOBJECT_NUMERIC) != 0); }
+		static float Get(HSQUIRRELVM v, int idx) { SQFloat f = 0; sq_getfloat(v, idx, &f); return (float)f; }
+		static void Push(HSQUIRRELVM v, float f) { sq_pushfloat(v, f); }
+	};
+
+	template<> struct SquirrelValue<bool>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "bool"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return (sq_gettype(v, idx) == OT_BOOL); }
+		static bool Get(HSQUIRRELVM v, int idx) { SQBool b = SQFalse; sq_getbool(v, idx, &b); return (b != SQFalse); }
+		static void Push(HSQUIRRELVM v, bool b) { sq_pushbool(v, b); }
+	};
+
+	template<> struct SquirrelValue<const char *>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "string"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return (sq_gettype(v, idx) == OT_STRING); }
+		static const char * Get(HSQUIRRELVM v, int idx) { const SQChar * sz = NULL; sq_getstring(v, idx, &sz); return sz; }
+		static void Push(HSQUIRRELVM v, const char * sz) { sq_pushstring(v, sz, -1); }
+	};
+
+	template<> struct SquirrelValue<CString>
+	{
+		enum { Slots = 1 };
+		static const char * Name() { return "string"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return (sq_gettype(v, idx) == OT_STRING); }
+		static CString Get(HSQUIRRELVM v, int idx) { const SQChar * sz = NULL; sq_getstring(v, idx, &sz); return CString(sz); }
+		static void Push(HSQUIRRELVM v, const CString& str) { sq_pushstring(v, str.Get(), str.GetLength()); }
+	};
+
+	template<> struct SquirrelValue<CVector3>
+	{
+		enum { Slots = 3 };
+		static const char * Name() { return "float"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return ((sq_gettype(v, idx) & sq_gettype(v, idx + 1) & sq_gettype(v, idx + 2) & SQOBJECT_NUMERIC) != 0); }
+		static CVector3 Get(HSQUIRRELVM v, int idx) { return CVector3(SquirrelValue<float>::Get(v, idx), SquirrelValue<float>::Get(v, idx + 1), SquirrelValue<float>::Get(v, idx + 2)); }
+
+		// Same layout as CSquirrelVM::PushArray
+		static void Push(HSQUIRRELVM v, const CVector3& vec)
+		{
+			sq_newarray(v, 0);
+			sq_pushfloat(v, vec.fX);
+			sq_arrayappend(v, -2);
+			sq_pushfloat(v, vec.fY);
+			sq_arrayappend(v, -2);
+			sq_pushfloat(v, vec.fZ);
+			sq_arrayappend(v, -2);
+		}
+	};
+
+	// Class instance, it's 'this' so it doesn't take a parameter slot
+	template<class T> struct SquirrelValue<T *>
+	{
+		enum { Slots = 0 };
+		static const char * Name() { return "instance"; }
+		static bool Check(HSQUIRRELVM v, int idx) { return (Get(v, idx) != NULL); }
+
+		static T * Get(HSQUIRRELVM v, int idx) { return (T *)GetSquirrelInstance(v, 1); }
+	};
+
+	// Placeholder for the parameters a native doesn't have
+	struct Unused { };
+
+	// Checks one parameter, iSlot receives its stack index and idx moves past it
+	template<template<class> class Value, class T> struct Parameter
+	{
+		typedef Value<typename Decay<T>::Type> Type;
+
+		template<class VM> static bool Check(VM vm, int& idx, int& iSlot, const char *& szExpected)
+		{
+			if(!Type::Check(vm, idx))
+			{
+				szExpected = Type::Name();
+				return false;
+			}
+
+			iSlot = idx;
+			idx += Type::Slots;
+			return true;
+		}
+
+		template<class VM> static typename Decay<T>::Type Get(VM vm, int iSlot) { return Type::Get(vm, iSlot); }
+	};
+
+	template<template<class> class Value> struct Parameter<Value, Unused>
+	{
+		template<class VM> static bool Check(VM vm, int& idx, int& iSlot, const char *& szExpected) { return true; }
+	};
+
+	// Calls the native and pushes the return value (if any)
+	template<class R> struct Result
+	{
+		template<template<class> class Value, class Function, class VM> static int Invoke(VM vm, const int * piSlots)
+		{
+			Value<typename Decay<R>::Type>::Push(vm, Function::template Call<Value>(vm, piSlots));
+			return 1;
+		}
+	};
+
+	template<> struct Result<void>
+	{
+		template<template<class> class Value, class Function, class VM> static int Invoke(VM vm, const int * piSlots)
+		{
+			Function::template Call<Value>(vm, piSlots);
+			return 0;
+		}
+	};
+
+	// Everything but the call itself, Function is the Native below which knows how to call the C++ function.
+	// Written out for a fixed number of parameters since the Windows toolset has no variadic templates
+	template<class R, class Function, class A1 = Unused, class A2 = Unused, class A3 = Unused, class A4 = Unused, class A5 = Unused,
+		class A6 = Unused, class A7 = Unused, class A8 = Unused, class A9 = Unused> struct Binding
+	{
+		// Checks all parameters, returns the name of the expected type of the first bad one
+		template<template<class> class Value, class VM> static const char * Check(VM vm, int& idx, int * piSlots)
+		{
+			const char * szExpected = NULL;
+
+			if(Parameter<Value, A1>::Check(vm, idx, piSlots[0], szExpected) && Parameter<Value, A2>::Check(vm, idx, piSlots[1], szExpected) &&
+				Parameter<Value, A3>::Check(vm, idx, piSlots[2], szExpected) && Parameter<Value, A4>::Check(vm, idx, piSlots[3], szExpected) &&
+				Parameter<Value, A5>::Check(vm, idx, piSlots[4], szExpected) && Parameter<Value, A6>::Check(vm, idx, piSlots[5], szExpected) &&
+				Parameter<Value, A7>::Check(vm, idx, piSlots[6], szExpected) && Parameter<Value, A8>::Check(vm, idx, piSlots[7], szExpected) &&
+				Parameter<Value, A9>::Check(vm, idx, piSlots[8], szExpected))
+				return NULL;
+
+			return szExpected;
+		}
+
+		static int Lua(int * VM)
+		{
+			lua_State * L = (lua_State *)VM;
+
+			int idx = 1;
+			int iSlots[9];
+			const char * szExpected = Check<LuaValue>(L, idx, iSlots);
+
+			if(szExpected)
+				return luaL_error(L, "bad argument #%d (%s expected)", idx, szExpected);
+
+			return Result<R>::template Invoke<LuaValue, Function>(L, iSlots);
+		}
+
+		static int Squirrel(int * VM)
+		{
+			HSQUIRRELVM v = (HSQUIRRELVM)VM;
+
+			int idx = 2;
+			int iSlots[9];
+			const char * szExpected = Check<SquirrelValue>(v, idx, iSlots);
+
+			if(szExpected)
+				return (int)sq_throwerror(v, CString("parameter %d has an invalid type (%s expected)", (idx - 1), szExpected).Get());
+
+			return Result<R>::template Invoke<SquirrelValue, Function>(v, iSlots);
+		}
+
+		static CScriptVM::scriptFunction Get(CScriptVM * pVM)
+		{
+			return ((pVM->GetVMType() == LUA_VM) ? Lua : Squirrel);
+		}
+	};
+
+	template<class Signature, Signature pfnFunction> struct Native;
+
+#define BINDING_PARAMETER(n) Parameter<Value, A##n>::Get(vm, piSlots[n - 1])
+
+	template<class R, R (* pfnFunction)()>
+	struct Native<R (*)(), pfnFunction>
+		: Binding<R, Native<R (*)(), pfnFunction> >
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction();
+		}
+	};
+
+	template<class R, class A1, R (* pfnFunction)(A1)>
+	struct Native<R (*)(A1), pfnFunction>
+		: Binding<R, Native<R (*)(A1), pfnFunction>, A1>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1));
+		}
+	};
+
+	template<class R, class A1, class A2, R (* pfnFunction)(A1, A2)>
+	struct Native<R (*)(A1, A2), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2), pfnFunction>, A1, A2>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, R (* pfnFunction)(A1, A2, A3)>
+	struct Native<R (*)(A1, A2, A3), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3), pfnFunction>, A1, A2, A3>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, R (* pfnFunction)(A1, A2, A3, A4)>
+	struct Native<R (*)(A1, A2, A3, A4), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4), pfnFunction>, A1, A2, A3, A4>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5, R (* pfnFunction)(A1, A2, A3, A4, A5)>
+	struct Native<R (*)(A1, A2, A3, A4, A5), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4, A5), pfnFunction>, A1, A2, A3, A4, A5>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4), BINDING_PARAMETER(5));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5, class A6, R (* pfnFunction)(A1, A2, A3, A4, A5, A6)>
+	struct Native<R (*)(A1, A2, A3, A4, A5, A6), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4, A5, A6), pfnFunction>, A1, A2, A3, A4, A5, A6>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4), BINDING_PARAMETER(5), BINDING_PARAMETER(6));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5, class A6, class A7, R (* pfnFunction)(A1, A2, A3, A4, A5, A6, A7)>
+	struct Native<R (*)(A1, A2, A3, A4, A5, A6, A7), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4, A5, A6, A7), pfnFunction>, A1, A2, A3, A4, A5, A6, A7>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4), BINDING_PARAMETER(5), BINDING_PARAMETER(6),
+				BINDING_PARAMETER(7));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8, R (* pfnFunction)(A1, A2, A3, A4, A5, A6, A7, A8)>
+	struct Native<R (*)(A1, A2, A3, A4, A5, A6, A7, A8), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4, A5, A6, A7, A8), pfnFunction>, A1, A2, A3, A4, A5, A6, A7, A8>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4), BINDING_PARAMETER(5), BINDING_PARAMETER(6),
+				BINDING_PARAMETER(7), BINDING_PARAMETER(8));
+		}
+	};
+
+	template<class R, class A1, class A2, class A3, class A4, class A5, class A6, class A7, class A8, class A9, R (* pfnFunction)(A1, A2, A3, A4, A5, A6, A7, A8, A9)>
+	struct Native<R (*)(A1, A2, A3, A4, A5, A6, A7, A8, A9), pfnFunction>
+		: Binding<R, Native<R (*)(A1, A2, A3, A4, A5, A6, A7, A8, A9), pfnFunction>, A1, A2, A3, A4, A5, A6, A7, A8, A9>
+	{
+		template<template<class> class Value, class VM> static R Call(VM vm, const int * piSlots)
+		{
+			return pfnFunction(BINDING_PARAMETER(1), BINDING_PARAMETER(2), BINDING_PARAMETER(3), BINDING_PARAMETER(4), BINDING_PARAMETER(5), BINDING_PARAMETER(6),
+				BINDING_PARAMETER(7), BINDING_PARAMETER(8), BINDING_PARAMETER(9));
+		}
+	};
+
+#undef BINDING_PARAMETER
+}
+
+#endif // CScriptBinding_h
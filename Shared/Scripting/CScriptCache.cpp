@@ -0,0 +1,168 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CScriptCache.cpp
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CScriptCache.h"
+#include <CRC.h>
+#include <SharedUtility.h>
+#include <CLogFile.h>
+#include "ResourceSystem/CResource.h"
+#include "CLuaVM.h"
+#include "CSquirrelVM.h"
+
+bool CScriptCache::ReadFile(const CString& strPath, std::string& strData)
+{
+	FILE * pFile = fopen(strPath.Get(), "rb");
+
+	if(!pFile)
+		return false;
+
+	// Get the file size
+	fseek(pFile, 0, SEEK_END);
+	long lSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	if(lSize < 0)
+	{
+		fclose(pFile);
+		return false;
+	}
+
+	strData.resize((size_t)lSize);
+
+	bool bSuccess = (lSize == 0 || fread(&strData[0], 1, (size_t)lSize, pFile) == (size_t)lSize);
+	fclose(pFile);
+	return bSuccess;
+}
+
+CString CScriptCache::GetPath(CResource * pResource, const CString& strScript)
+{
+	// Flatten the script path so every script gets its own file in the cache directory
+	CString strFileName = strScript;
+
+	for(size_t i = 0; i < strFileName.GetLength(); i++)
+	{
+		if(strFileName[i] == '/' || strFileName[i] == '\\')
+			strFileName.SetChar(i, '_');
+	}
+
+	return CString("%s/%s/%s%s", pResource->GetResourceDirectoryPath().Get(), SCRIPT_CACHE_DIRECTORY, strFileName.Get(), SCRIPT_CACHE_EXTENSION);
+}
+
+unsigned int CScriptCache::GetChecksum(const std::string& strSource)
+{
+	CChecksum checksum;
+
+	if(!strSource.empty())
+		checksum.Add((unsigned char *)strSource.data(), (unsigned int)strSource.size());
+
+	return checksum.GetChecksum();
+}
+
+bool CScriptCache::Compile(CResource * pResource, eVMType vmType, const CString& strScript, std::string& strChunk, bool& bCached, bool bUseCache)
+{
+	CString strScriptPath("%s/%s", pResource->GetResourceDirectoryPath().Get(), strScript.Get());
+	std::string strSource;
+
+	if(!ReadFile(strScriptPath, strSource))
+	{
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to load file %s.", pResource->GetName().Get(), strScript.Get());
+		return false;
+	}
+
+	// Use the compiled chunk if it was built from this source
+	CString strCachePath = GetPath(pResource, strScript);
+	bCached = (bUseCache && Load(strCachePath, vmType, strSource, strChunk));
+
+	if(bCached)
+		return true;
+
+	CString strError;
+	bool bCompiled = false;
+
+	if(vmType == LUA_VM)
+		bCompiled = CLuaVM::Compile(strScriptPath, strSource, strChunk, strError);
+	else if(vmType == SQUIRREL_VM)
+		bCompiled = CSquirrelVM::Compile(strScriptPath, strSource, strChunk, strError);
+	else
+		strError = "unknown vm type";
+
+	if(!bCompiled)
+	{
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to load file %s: %s", pResource->GetName().Get(), strScript.Get(), strError.Get());
+		return false;
+	}
+
+	// Store the compiled chunk for the next start
+	Save(strCachePath, vmType, strSource, strChunk);
+	return true;
+}
+
+bool CScriptCache::Load(const CString& strCachePath, eVMType vmType, const std::string& strSource, std::string& strChunk)
+{
+	std::string strData;
+
+	if(!ReadFile(strCachePath, strData) || strData.size() < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, strData.data(), sizeof(Header));
+
+	// Is it a cache file of this version for this vm?
+	if(header.uiMagic != SCRIPT_CACHE_MAGIC || header.uiVersion != SCRIPT_CACHE_VERSION || header.uiVMType != (unsigned int)vmType)
+		return false;
+
+	// Was it compiled from the current source?
+	if(header.uiSourceLength != strSource.size() || header.uiChecksum != GetChecksum(strSource))
+		return false;
+
+	// Is the file complete?
+	if(header.uiChunkLength != (strData.size() - sizeof(Header)))
+		return false;
+
+	strChunk.assign(strData, sizeof(Header), std::string::npos);
+	return true;
+}
+
+bool CScriptCache::Save(const CString& strCachePath, eVMType vmType, const std::string& strSource, const std::string& strChunk)
+{
+	// Make sure the cache directory exists
+	CString strDirectory = strCachePath.Substring(0, strCachePath.ReverseFind((unsigned char)'/'));
+
+	if(!SharedUtility::Exists(strDirectory.Get()))
+		SharedUtility::CreateDirectory(strDirectory.Get());
+
+	FILE * pFile = fopen(strCachePath.Get(), "wb");
+
+	if(!pFile)
+	{
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_WARNING, "Failed to write script cache %s", strCachePath.Get());
+		return false;
+	}
+
+	Header header;
+	header.uiMagic = SCRIPT_CACHE_MAGIC;
+	header.uiVersion = SCRIPT_CACHE_VERSION;
+	header.uiVMType = (unsigned int)vmType;
+	header.uiChecksum = GetChecksum(strSource);
+	header.uiSourceLength = (unsigned int)strSource.size();
+	header.uiChunkLength = (unsigned int)strChunk.size();
+
+	bool bSuccess = (fwrite(&header, sizeof(Header), 1, pFile) == 1);
+
+	if(bSuccess && !strChunk.empty())
+		bSuccess = (fwrite(strChunk.data(), 1, strChunk.size(), pFile) == strChunk.size());
+
+	fclose(pFile);
+
+	// Don't leave a broken cache file behind
+	if(!bSuccess)
+		remove(strCachePath.Get());
+
+	return bSuccess;
+}
@@ -0,0 +1,55 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CScriptCache.h
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CScriptCache_h
+#define CScriptCache_h
+
+#include <Common.h>
+#include <string>
+#include "CScriptVM.h"
+
+// Compiled scripts are stored in this directory inside the resource directory
+#define SCRIPT_CACHE_DIRECTORY	"cache"
+#define SCRIPT_CACHE_EXTENSION	".ivc"
+
+#define SCRIPT_CACHE_MAGIC		0x43535649 // IVSC
+#define SCRIPT_CACHE_VERSION	1
+
+class CResource;
+
+class CScriptCache {
+
+private:
+	struct Header
+	{
+		unsigned int	uiMagic;
+		unsigned int	uiVersion;
+		unsigned int	uiVMType;
+		unsigned int	uiChecksum;
+		unsigned int	uiSourceLength;
+		unsigned int	uiChunkLength;
+	};
+
+public:
+	// Reads a whole file into strData
+	static bool			ReadFile(const CString& strPath, std::string& strData);
+
+	static CString		GetPath(CResource * pResource, const CString& strScript);
+	static unsigned int	GetChecksum(const std::string& strSource);
+
+	// Reads the script and returns its compiled chunk, from the cache when it's up to date and bUseCache is set.
+	// Doesn't touch the vm of the resource, so it's safe to call from a worker thread
+	static bool			Compile(CResource * pResource, eVMType vmType, const CString& strScript, std::string& strChunk, bool& bCached, bool bUseCache = true);
+
+	// Reads the compiled chunk, fails if the cache doesn't belong to the given source
+	static bool			Load(const CString& strCachePath, eVMType vmType, const std::string& strSource, std::string& strChunk);
+	static bool			Save(const CString& strCachePath, eVMType vmType, const std::string& strSource, const std::string& strChunk);
+};
+
+#endif // CScriptCache_h
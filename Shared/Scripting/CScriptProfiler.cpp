@@ -0,0 +1,339 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CScriptProfiler.cpp
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#include "CScriptProfiler.h"
+#include "ResourceSystem/CResourceManager.h"
+#include <CLogFile.h>
+#include <Threading/CMutex.h>
+#include <RakNet/GetTime.h>
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+bool												CScriptProfiler::s_bEnabled = false;
+bool												CScriptProfiler::s_bSampling = false;
+unsigned long long									CScriptProfiler::s_ullStartTime = 0;
+unsigned long long									CScriptProfiler::s_ullProfiledTime = 0;
+std::map<CScriptVM *, std::map<CString, CScriptProfiler::Native>> CScriptProfiler::s_natives;
+std::vector<CScriptProfiler::Frame>					CScriptProfiler::s_stack;
+std::map<CString, CScriptProfiler::Statistics>		CScriptProfiler::s_nativeStatistics;
+std::map<CString, CScriptProfiler::Statistics>		CScriptProfiler::s_handlerStatistics;
+std::map<CString, CScriptProfiler::Statistics>		CScriptProfiler::s_resourceStatistics;
+std::map<CString, unsigned long long>				CScriptProfiler::s_foldedTime;
+std::map<CString, unsigned long>					CScriptProfiler::s_foldedSamples;
+
+// Console commands come from the input thread, they are run from Process
+static std::atomic<int>								g_iPendingCommand(0);
+static CMutex										g_dumpFileMutex;
+static CString										g_strDumpFile;
+
+CScriptProfiler::Native * CScriptProfiler::AddNative(CScriptVM * pVM, CResource * pResource, const char * szName, CScriptVM::scriptFunction pfnFunction)
+{
+	Native * pNative = &s_natives[pVM][szName];
+	pNative->pfnFunction = pfnFunction;
+	pNative->pResource = pResource;
+	pNative->strName = szName;
+	return pNative;
+}
+
+void CScriptProfiler::RemoveNatives(CScriptVM * pVM)
+{
+	s_natives.erase(pVM);
+}
+
+int CScriptProfiler::CallNative(Native * pNative, int * pVM)
+{
+	// Don't pay for anything while we're not profiling
+	if(!s_bEnabled)
+		return pNative->pfnFunction(pVM);
+
+	size_t sDepth = Enter(FRAME_NATIVE, pNative->pResource, pNative->strName);
+	int iReturn = pNative->pfnFunction(pVM);
+	Leave(sDepth);
+	return iReturn;
+}
+
+size_t CScriptProfiler::Enter(eFrameType eType, CResource * pResource, const CString& strName)
+{
+	if(!s_bEnabled)
+		return (size_t)-1;
+
+	Frame frame;
+	frame.eType = eType;
+	frame.pResource = pResource;
+	frame.strName = strName;
+	frame.ullChildTime = 0;
+	frame.ullStartTime = RakNet::GetTimeUS();
+	s_stack.push_back(frame);
+
+	return (s_stack.size() - 1);
+}
+
+void CScriptProfiler::Leave(size_t sDepth)
+{
+	// Was the frame entered before we started (or did we get reset since)?
+	if(sDepth >= s_stack.size())
+		return;
+
+	unsigned long long ullTime = RakNet::GetTimeUS();
+
+	// Also pop frames which never left (script errors can jump out of natives)
+	while(s_stack.size() > sDepth)
+	{
+		Frame& frame = s_stack.back();
+		unsigned long long ullElapsed = (ullTime - frame.ullStartTime);
+		unsigned long long ullSelf = (ullElapsed > frame.ullChildTime ? (ullElapsed - frame.ullChildTime) : 0);
+		CString strResource = (frame.pResource ? frame.pResource->GetName() : CString("unknown"));
+
+		// Update the flat statistics
+		Statistics& statistics = (frame.eType == FRAME_NATIVE ? s_nativeStatistics[frame.strName] : s_handlerStatistics[strResource + ":" + frame.strName]);
+		statistics.ulCalls++;
+		statistics.ullTime += ullElapsed;
+		statistics.ullSelfTime += ullSelf;
+
+		Statistics& resourceStatistics = s_resourceStatistics[strResource];
+		resourceStatistics.ullSelfTime += ullSelf;
+
+		if(frame.eType == FRAME_HANDLER)
+			resourceStatistics.ulCalls++;
+
+		// Build the folded stack (resource;outer;...;inner)
+		CString strStack = strResource;
+
+		for(size_t i = 0; i < s_stack.size(); i++)
+		{
+			strStack += ";";
+			strStack += s_stack[i].strName;
+		}
+
+		s_foldedTime[strStack] += ullSelf;
+
+		s_stack.pop_back();
+
+		if(!s_stack.empty())
+			s_stack.back().ullChildTime += ullElapsed;
+	}
+}
+
+void CScriptProfiler::AddSample(CResource * pResource, const CString& strStack)
+{
+	if(!s_bEnabled)
+		return;
+
+	CString strSample = (pResource ? pResource->GetName() : CString("unknown"));
+	strSample += ";";
+	strSample += strStack;
+	s_foldedSamples[strSample]++;
+}
+
+void CScriptProfiler::SetHooks(bool bEnabled)
+{
+	if(!CResourceManager::GetInstance())
+		return;
+
+	std::list<CResource*> resources = CResourceManager::GetInstance()->GetResources();
+
+	for(auto pResource : resources)
+	{
+		if(pResource && pResource->GetVM())
+			pResource->GetVM()->SetProfilerHook(bEnabled);
+	}
+}
+
+void CScriptProfiler::Reset()
+{
+	s_stack.clear();
+	s_nativeStatistics.clear();
+	s_handlerStatistics.clear();
+	s_resourceStatistics.clear();
+	s_foldedTime.clear();
+	s_foldedSamples.clear();
+	s_ullProfiledTime = 0;
+}
+
+void CScriptProfiler::Start(bool bSampling)
+{
+	if(s_bEnabled)
+	{
+		CLogFile::Print("[Profiler] Already running.");
+		return;
+	}
+
+	Reset();
+
+	s_bEnabled = true;
+	s_bSampling = bSampling;
+	s_ullStartTime = RakNet::GetTimeUS();
+
+	if(s_bSampling)
+		SetHooks(true);
+
+	CLogFile::Printf("[Profiler] Started%s.", (s_bSampling ? " with sampling" : ""));
+}
+
+void CScriptProfiler::Stop()
+{
+	if(!s_bEnabled)
+	{
+		CLogFile::Print("[Profiler] Not running.");
+		return;
+	}
+
+	if(s_bSampling)
+		SetHooks(false);
+
+	s_bEnabled = false;
+	s_bSampling = false;
+	s_ullProfiledTime = (RakNet::GetTimeUS() - s_ullStartTime);
+	s_stack.clear();
+
+	CLogFile::Printf("[Profiler] Stopped after %llums, use 'profile dump' to see the results.", (s_ullProfiledTime / 1000));
+}
+
+struct ProfilerEntry
+{
+	CString				strName;
+	unsigned long		ulCalls;
+	unsigned long long	ullTime;
+	unsigned long long	ullSelfTime;
+
+	bool operator < (const ProfilerEntry& right) const { return ullSelfTime > right.ullSelfTime; }
+};
+
+template<class Map>
+static void PrintStatistics(const char * szTitle, const Map& statistics)
+{
+	// Sort by self time
+	std::vector<ProfilerEntry> entries;
+
+	for(auto it = statistics.begin(); it != statistics.end(); ++it)
+	{
+		ProfilerEntry entry;
+		entry.strName = it->first;
+		entry.ulCalls = it->second.ulCalls;
+		entry.ullTime = it->second.ullTime;
+		entry.ullSelfTime = it->second.ullSelfTime;
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end());
+
+	CLogFile::Printf("---------- %s ----------", szTitle);
+
+	for(size_t i = 0; i < entries.size(); i++)
+	{
+		ProfilerEntry& entry = entries[i];
+		CLogFile::Printf("%-40s %8lu calls %10.3fms self %10.3fms total %8.2fus avg", entry.strName.Get(), entry.ulCalls, (entry.ullSelfTime / 1000.0), (entry.ullTime / 1000.0), (entry.ulCalls > 0 ? ((double)entry.ullTime / entry.ulCalls) : 0.0));
+	}
+}
+
+void CScriptProfiler::Dump(const char * szFile)
+{
+	unsigned long long ullProfiledTime = (s_bEnabled ? (RakNet::GetTimeUS() - s_ullStartTime) : s_ullProfiledTime);
+
+	CLogFile::Printf("[Profiler] Results of %.3fms:", (ullProfiledTime / 1000.0));
+	PrintStatistics("Resources", s_resourceStatistics);
+	PrintStatistics("Event handlers", s_handlerStatistics);
+	PrintStatistics("Natives", s_nativeStatistics);
+
+	// Write the folded stacks, one "frame;frame;frame value" line each
+	FILE * pFile = fopen(szFile, "w");
+
+	if(!pFile)
+	{
+		CLogFile::Printf("[Profiler] Failed to open %s for writing.", szFile);
+		return;
+	}
+
+	for(auto it = s_foldedTime.begin(); it != s_foldedTime.end(); ++it)
+		fprintf(pFile, "%s %llu\n", it->first.Get(), it->second);
+
+	fclose(pFile);
+
+	CLogFile::Printf("[Profiler] Wrote timed stacks (us) to %s.", szFile);
+
+	// Write the samples next to it
+	if(!s_foldedSamples.empty())
+	{
+		CString strSampleFile("%s.samples", szFile);
+		pFile = fopen(strSampleFile.Get(), "w");
+
+		if(pFile)
+		{
+			for(auto it = s_foldedSamples.begin(); it != s_foldedSamples.end(); ++it)
+				fprintf(pFile, "%s %lu\n", it->first.Get(), it->second);
+
+			fclose(pFile);
+
+			CLogFile::Printf("[Profiler] Wrote samples to %s.", strSampleFile.Get());
+		}
+	}
+}
+
+void CScriptProfiler::RequestStart(bool bSampling)
+{
+	g_iPendingCommand = (bSampling ? COMMAND_START_SAMPLING : COMMAND_START);
+}
+
+void CScriptProfiler::RequestStop()
+{
+	g_iPendingCommand = COMMAND_STOP;
+}
+
+void CScriptProfiler::RequestDump(const char * szFile)
+{
+	g_dumpFileMutex.Lock();
+	g_strDumpFile = szFile;
+	g_dumpFileMutex.Unlock();
+	g_iPendingCommand = COMMAND_DUMP;
+}
+
+void CScriptProfiler::Process()
+{
+	ePendingCommand eCommand = (ePendingCommand)g_iPendingCommand.exchange(COMMAND_NONE);
+
+	if(eCommand == COMMAND_NONE)
+		return;
+
+	switch(eCommand)
+	{
+		case COMMAND_START:
+			Start(false);
+			break;
+
+		case COMMAND_START_SAMPLING:
+			Start(true);
+			break;
+
+		case COMMAND_STOP:
+			Stop();
+			break;
+
+		case COMMAND_DUMP:
+			{
+				g_dumpFileMutex.Lock();
+				CString strFile = g_strDumpFile;
+				g_dumpFileMutex.Unlock();
+				Dump(strFile.Get());
+			}
+			break;
+	}
+}
+
+void CScriptProfiler::Shutdown()
+{
+	if(s_bEnabled && s_bSampling)
+		SetHooks(false);
+
+	s_bEnabled = false;
+	Reset();
+
+	s_natives.clear();
+}
@@ -0,0 +1,126 @@
+//========== IV:Multiplayer - https://github.com/IVMultiplayer/IVMultiplayer ==========
+//
+// File: CScriptProfiler.h
+// Project: Shared
+// Author: agent <agent@local>
+// License: See LICENSE in root directory
+//
+//==============================================================================
+
+#ifndef CScriptProfiler_h
+#define CScriptProfiler_h
+
+#include <Common.h>
+#include <list>
+#include <map>
+#include <vector>
+#include "CScriptVM.h"
+
+// Lua gets sampled every n instructions, squirrel every n function calls
+#define PROFILER_LUA_SAMPLE_INSTRUCTIONS	1000
+#define PROFILER_SQUIRREL_SAMPLE_CALLS		16
+
+// Deeper script stacks get cut off in the samples
+#define PROFILER_MAX_STACK_DEPTH			32
+
+class CResource;
+
+class CScriptProfiler {
+
+public:
+	// Passed to the native wrappers of the vms, owned by the profiler until the vm goes away
+	struct Native
+	{
+		CScriptVM::scriptFunction	pfnFunction;
+		CResource					* pResource;
+		CString						strName;
+	};
+
+private:
+	struct Statistics
+	{
+		unsigned long		ulCalls;
+		unsigned long long	ullTime;		// Including everything called from it (us)
+		unsigned long long	ullSelfTime;	// Without it (us)
+
+		Statistics() : ulCalls(0), ullTime(0), ullSelfTime(0) {}
+	};
+
+	enum eFrameType
+	{
+		FRAME_NATIVE,
+		FRAME_HANDLER,
+	};
+
+	struct Frame
+	{
+		eFrameType			eType;
+		CResource			* pResource;
+		CString				strName;
+		unsigned long long	ullStartTime;
+		unsigned long long	ullChildTime;
+	};
+
+	enum ePendingCommand
+	{
+		COMMAND_NONE,
+		COMMAND_START,
+		COMMAND_START_SAMPLING,
+		COMMAND_STOP,
+		COMMAND_DUMP,
+	};
+
+	static bool									s_bEnabled;
+	static bool									s_bSampling;
+	static unsigned long long					s_ullStartTime;
+	static unsigned long long					s_ullProfiledTime;
+
+	static std::map<CScriptVM *, std::map<CString, Native>> s_natives;
+	static std::vector<Frame>					s_stack;
+
+	static std::map<CString, Statistics>		s_nativeStatistics;
+	static std::map<CString, Statistics>		s_handlerStatistics;
+	static std::map<CString, Statistics>		s_resourceStatistics;
+	static std::map<CString, unsigned long long> s_foldedTime;
+	static std::map<CString, unsigned long>		s_foldedSamples;
+
+	static size_t			Enter(eFrameType eType, CResource * pResource, const CString& strName);
+	static void				Leave(size_t sDepth);
+
+	static void				Start(bool bSampling);
+	static void				Stop();
+	static void				Reset();
+	static void				Dump(const char * szFile);
+
+	static void				SetHooks(bool bEnabled);
+
+public:
+	static bool				IsEnabled() { return s_bEnabled; }
+
+	// Called by the vms for every registered native, the returned pointer stays valid until RemoveNatives.
+	// Registering the same name again reuses the wrapper
+	static Native			*AddNative(CScriptVM * pVM, CResource * pResource, const char * szName, CScriptVM::scriptFunction pfnFunction);
+
+	// Frees the wrappers of a vm, called when it gets destroyed
+	static void				RemoveNatives(CScriptVM * pVM);
+
+	// Calls a native through the profiler
+	static int				CallNative(Native * pNative, int * pVM);
+
+	// Times event handlers and timers, EnterHandler returns the depth to pass to LeaveHandler
+	static size_t			EnterHandler(CResource * pResource, const CString& strName) { return Enter(FRAME_HANDLER, pResource, strName); }
+	static void				LeaveHandler(size_t sDepth) { Leave(sDepth); }
+
+	// Called by the sampling hooks of the vms, strStack is the script stack from the outermost frame down
+	static void				AddSample(CResource * pResource, const CString& strStack);
+
+	// Thread safe, the command gets executed with the next Process call
+	static void				RequestStart(bool bSampling);
+	static void				RequestStop();
+	static void				RequestDump(const char * szFile);
+
+	static void				Process();
+	static void				Shutdown();
+};
+
+#endif // CScriptProfiler_h
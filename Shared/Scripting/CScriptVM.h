@@ -48,6 +48,9 @@ public:
 	virtual bool LoadScript(CString script) { return false; }		// Replace string with script
 	virtual bool LoadScripts(std::list<CScript> scripts) { return false; }
 
+	// Loads a chunk built by CScriptCache::Compile and runs its top-level code
+	virtual bool RunScript(const CString& script, const std::string& strChunk, bool bCached) { return false; }
+
 	virtual void Pop(bool& b) {}
 	virtual void Pop(int& i) {}
 	virtual void Pop(float& f) {}
@@ -66,6 +69,7 @@ public:
 	virtual void Push(const int& i) {}
 	virtual void Push(const float& f) {}
 	virtual void Push(const CString& str) {}
+	virtual void Push(const char* szString) {}
 	virtual void Push(const CVector3& vec) {}
 	virtual void PushArray(const CScriptArguments &array) {}
 	virtual void PushTable(const CScriptArguments &table) {}
@@ -79,10 +83,16 @@ public:
 
 	virtual void RegisterFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount = -1, const char* szFunctionTemplate = NULL, bool bPushRootTable = false) {}
 
+	// Class methods are registered once between RegisterScriptClass and FinishScriptClass,
+	// every instance created with SetClassInstance shares them
 	virtual void RegisterScriptClass(const char* className, scriptFunction pfnFunction, const char* baseClass = 0) {}
 	virtual void RegisterClassFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount = -1, const char* szFunctionTemplate = NULL) {}
+	virtual void FinishScriptClass() {}
 	virtual void SetClassInstance(const char* szClassName, void * pInstance) { }
 	virtual void* GetClassInstance(const char* szClassName) {return 0;}
+
+	// Installs/removes the sampling hook of the profiler
+	virtual void SetProfilerHook(bool bEnabled) {}
 };
 
 #endif // CScriptVM_h
\ No newline at end of file
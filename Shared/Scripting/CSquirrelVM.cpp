@@ -12,9 +12,14 @@
 #include <SharedUtility.h>
 #include <assert.h>
 #include <Squirrel/sqvm.h>
+#include "ResourceSystem/CResourceManager.h"
+#include "CScriptProfiler.h"
+#include "CScriptCache.h"
+#include <vector>
 #include <Squirrel/sqstdio.h>
 #include <Squirrel/sqstdaux.h>
 #include "CScriptArgument.h"
+#include "CScriptBinding.h"
 
 
 void PrintFunction(SQVM * pVM, const char * szFormat, ...)
@@ -29,7 +34,8 @@ void PrintFunction(SQVM * pVM, const char * szFormat, ...)
 
 CSquirrelVM::CSquirrelVM(CResource * pResource)
 	: CScriptVM(pResource),
-	m_iStackIndex(2)
+	m_iStackIndex(2),
+	m_iClassTop(-1)
 {
 	m_pVM = sq_open(1024);
 
@@ -40,11 +46,21 @@ CSquirrelVM::CSquirrelVM(CResource * pResource)
 	sq_pushroottable(m_pVM);
 
 	sq_setprintfunc(m_pVM, PrintFunction, PrintFunction);
+
+	// Let natives find our resource
+	if(CResourceManager::GetInstance())
+		CResourceManager::GetInstance()->AddVM((int *)m_pVM, pResource);
 }
 
 
 CSquirrelVM::~CSquirrelVM()
 {
+	if(CResourceManager::GetInstance())
+		CResourceManager::GetInstance()->RemoveVM((int *)m_pVM);
+
+	// Free the profiler wrappers of our natives
+	CScriptProfiler::RemoveNatives(this);
+
 	// Pop the root table from the stack
 	sq_pop(m_pVM, 1);
 
@@ -54,16 +70,114 @@ CSquirrelVM::~CSquirrelVM()
 }
 
 
+struct ChunkReader
+{
+	const std::string	* pChunk;
+	size_t				sOffset;
+};
+
+static SQInteger ReadChunk(SQUserPointer pUserData, SQUserPointer pBuffer, SQInteger iSize)
+{
+	ChunkReader * pReader = (ChunkReader *)pUserData;
+
+	// Not enough data left?
+	if((pReader->pChunk->size() - pReader->sOffset) < (size_t)iSize)
+		return -1;
+
+	memcpy(pBuffer, (pReader->pChunk->data() + pReader->sOffset), (size_t)iSize);
+	pReader->sOffset += (size_t)iSize;
+	return iSize;
+}
+
+static SQInteger WriteChunk(SQUserPointer pUserData, SQUserPointer pData, SQInteger iSize)
+{
+	((std::string *)pUserData)->append((const char *)pData, (size_t)iSize);
+	return iSize;
+}
+
+static void CompilerError(HSQUIRRELVM pVM, const SQChar * szDescription, const SQChar * szSource, SQInteger iLine, SQInteger iColumn)
+{
+	// Hand the message to Compile
+	*(CString *)sq_getforeignptr(pVM) = CString("%s (line %d, column %d)", szDescription, (int)iLine, (int)iColumn);
+}
+
+bool CSquirrelVM::Compile(const CString& strPath, const std::string& strSource, std::string& strChunk, CString& strError)
+{
+	// Use a private vm, the resource vm might not exist yet
+	HSQUIRRELVM pVM = sq_open(1024);
+
+	if(!pVM)
+	{
+		strError = "not enough memory";
+		return false;
+	}
+
+	sq_setforeignptr(pVM, &strError);
+	sq_setcompilererrorhandler(pVM, CompilerError);
+
+	bool bSuccess = false;
+
+	if(SQ_SUCCEEDED(sq_compilebuffer(pVM, strSource.data(), (SQInteger)strSource.size(), strPath.Get(), SQTrue)))
+	{
+		strChunk.clear();
+
+		if(SQ_SUCCEEDED(sq_writeclosure(pVM, WriteChunk, &strChunk)))
+			bSuccess = true;
+		else
+			strError = "failed to write the closure";
+	}
+
+	sq_close(pVM);
+	return bSuccess;
+}
+
 bool CSquirrelVM::LoadScript(CString script)
 {
-	CString scriptPath( "%s/%s", GetResource()->GetResourceDirectoryPath().Get(), script.Get());
-	
-	if(!SharedUtility::Exists(script.Get()) && SQ_FAILED(sqstd_dofile( m_pVM, scriptPath.Get(), SQFalse, SQTrue )))
+	std::string strChunk;
+	bool bCached = false;
+
+	if(!CScriptCache::Compile(GetResource(), SQUIRREL_VM, script, strChunk, bCached))
+		return false;
+
+	return RunScript(script, strChunk, bCached);
+}
+
+bool CSquirrelVM::RunScript(const CString& script, const std::string& strChunk, bool bCached)
+{
+	ChunkReader reader;
+	reader.pChunk = &strChunk;
+	reader.sOffset = 0;
+
+	if(SQ_FAILED(sq_readclosure(m_pVM, ReadChunk, &reader)))
+	{
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to load file %s.", GetResource()->GetName().Get(), script.Get());
+
+		// Compile it from source instead, this also replaces the broken cache file
+		if(bCached)
+		{
+			std::string strSourceChunk;
+
+			if(!CScriptCache::Compile(GetResource(), SQUIRREL_VM, script, strSourceChunk, bCached, false))
+				return false;
+
+			return RunScript(script, strSourceChunk, false);
+		}
+
+		return false;
+	}
+
+	// Run it with the root table as 'this'
+	sq_pushroottable(m_pVM);
+	SQRESULT result = sq_call(m_pVM, 1, SQFalse, SQTrue);
+	sq_pop(m_pVM, 1);
+
+	if(SQ_FAILED(result))
 	{
-		CLogFile::Printf("[%s] Failed to load file %s.", GetResource()->GetName().Get(), script.Get());
+		CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_ERROR, "[%s] Failed to run file %s.", GetResource()->GetName().Get(), script.Get());
 		return false;
 	}
-	CLogFile::Printf("\t[%s] Loaded file %s.", GetResource()->GetName().Get(), script.Get());
+
+	CLogFile::Logf(LOG_CATEGORY_SCRIPT, LOG_LEVEL_INFO, "\t[%s] Loaded file %s%s.", GetResource()->GetName().Get(), script.Get(), (bCached ? " (cached)" : ""));
 	return true;
 }
 
@@ -77,13 +191,24 @@ bool CSquirrelVM::LoadScripts(std::list<CScript> scripts)
 	return true;
 }
 
+static SQInteger ProfiledNative(SQVM * pVM)
+{
+	// The native is our free variable, it's pushed after the parameters
+	SQUserPointer pNative = NULL;
+	sq_getuserpointer(pVM, -1, &pNative);
+	sq_poptop(pVM);
+
+	return CScriptProfiler::CallNative((CScriptProfiler::Native *)pNative, (int *)pVM);
+}
+
 void CSquirrelVM::RegisterFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount, const char* szFunctionTemplate, bool bPushRootTable)
 {
 	// Push the function name onto the stack
 	sq_pushstring(m_pVM, szFunctionName, -1);
 
-	// Create a new function
-	sq_newclosure(m_pVM, (SQFUNCTION)pfnFunction, 0);
+	// Create a new function through the profiler wrapper, the native is its free variable
+	sq_pushuserpointer(m_pVM, CScriptProfiler::AddNative(this, GetResource(), szFunctionName, pfnFunction));
+	sq_newclosure(m_pVM, ProfiledNative, 1);
 
 	// Set the function parameter template and count
 	if(iParameterCount != -1)
@@ -102,6 +227,39 @@ void CSquirrelVM::RegisterFunction(const char* szFunctionName, scriptFunction pf
 	sq_createslot(m_pVM, -3);
 }
 
+static void ProfilerHook(SQVM * pVM, SQInteger iType, const SQChar * szSource, SQInteger iLine, const SQChar * szFunction)
+{
+	static unsigned int uiCalls = 0;
+
+	// Only sample every n-th call
+	if(iType != 'c' || (++uiCalls % PROFILER_SQUIRREL_SAMPLE_CALLS) != 0)
+		return;
+
+	// Collect the stack from the innermost function
+	std::vector<CString> frames;
+	SQStackInfos stackInfos;
+
+	for(SQInteger iLevel = 0; iLevel < PROFILER_MAX_STACK_DEPTH && SQ_SUCCEEDED(sq_stackinfos(pVM, iLevel, &stackInfos)); iLevel++)
+		frames.push_back(CString("%s (%s:%d)", (stackInfos.funcname ? stackInfos.funcname : "?"), (stackInfos.source ? stackInfos.source : "?"), (int)stackInfos.line));
+
+	CString strStack;
+
+	for(auto it = frames.rbegin(); it != frames.rend(); ++it)
+	{
+		if(!strStack.IsEmpty())
+			strStack += ";";
+
+		strStack += *it;
+	}
+
+	CScriptProfiler::AddSample(CResourceManager::GetInstance()->Get((int *)pVM), strStack);
+}
+
+void CSquirrelVM::SetProfilerHook(bool bEnabled)
+{
+	sq_setnativedebughook(m_pVM, (bEnabled ? ProfilerHook : NULL));
+}
+
 void CSquirrelVM::RegisterScriptClass(const char* className, scriptFunction pfnFunction, const char* baseClass)
 {
 	int n = 0;
@@ -121,50 +279,94 @@ void CSquirrelVM::RegisterScriptClass(const char* className, scriptFunction pfnF
 		return;
 	}
 
+	// Tag it, so natives can tell our instances from ones of script classes
+	sq_settypetag(m_pVM, -1, ScriptBinding::GetSquirrelClassTag());
+
 	sq_pushstring(m_pVM, _SC("constructor"), -1);
 	sq_newclosure(m_pVM, (SQFUNCTION)pfnFunction, 0);
 	sq_newslot(m_pVM, -3, false); // Add the constructor method
 
-	sq_newslot(m_pVM, -3, SQFalse); // Add the class
-
-	sq_pop(m_pVM, m_pVM->_top-oldtop);
+	// Keep the class on the stack until FinishScriptClass, the methods go into it
+	m_iClassTop = oldtop;
+	m_strClassName = className;
 }
 
-SQInteger deleteClassInstance(SQUserPointer ptr, SQInteger size)
+void CSquirrelVM::FinishScriptClass()
 {
-    int *p = static_cast<int *>(ptr);
-    delete p;
+	if(m_iClassTop == -1)
+		return;
+
+	sq_newslot(m_pVM, -3, SQFalse); // Add the class
 
-    return 0;
+	sq_settop(m_pVM, m_iClassTop);
+	m_iClassTop = -1;
 }
 
 void CSquirrelVM::SetClassInstance(const char* szClassName, void * pInstance)
 {
-	HSQOBJECT instance;
-	sq_resetobject(&instance);
-	sq_getstackobj(m_pVM, -1, &instance);
+	// Called as constructor? Then 'this' is a new instance of the class without a pointer yet.
+	// Natives called from other methods have the instance of that method there, leave it alone
+	if(sq_gettype(m_pVM, 1) == OT_INSTANCE)
+	{
+		SQUserPointer pCurrent = NULL;
+		sq_getinstanceup(m_pVM, 1, &pCurrent, NULL);
+
+		if(!pCurrent)
+		{
+			bool bConstructor = false;
+
+			sq_pushroottable(m_pVM);
+			sq_pushstring(m_pVM, szClassName, -1);
+
+			if(SQ_SUCCEEDED(sq_get(m_pVM, -2)))
+			{
+				// Takes the class at -2 and the instance at -1
+				sq_push(m_pVM, 1);
+				bConstructor = (sq_instanceof(m_pVM) == SQTrue);
+				sq_pop(m_pVM, 2);
+			}
+
+			sq_pop(m_pVM, 1);
+
+			if(bConstructor)
+			{
+				sq_setinstanceup(m_pVM, 1, (SQUserPointer)pInstance);
+				return;
+			}
+		}
+	}
 
+	// Otherwise create the instance and leave it on the stack to return it
 	sq_pushroottable(m_pVM);
 	sq_pushstring(m_pVM, szClassName, -1);
-	sq_get(m_pVM, -2);
-	sq_setinstanceup(m_pVM, -1, (SQUserPointer *)pInstance);
-	sq_setreleasehook(m_pVM, -1, deleteClassInstance);
+
+	if(SQ_FAILED(sq_get(m_pVM, -2)))
+	{
+		sq_pop(m_pVM, 1);
+		return;
+	}
+
+	sq_createinstance(m_pVM, -1);
+	sq_setinstanceup(m_pVM, -1, (SQUserPointer)pInstance);
+	sq_remove(m_pVM, -2);
+	sq_remove(m_pVM, -2);
 }
 
 void* CSquirrelVM::GetClassInstance(const char* szClassName)
 {
-	SQUserPointer pInstance = NULL;
-
-	if(SQ_FAILED(sq_getinstanceup(m_pVM, -1, &pInstance, NULL)))
-		pInstance = NULL;
-
-	return pInstance;
+	// The instance is 'this', it has to be one of a registered class
+	return ScriptBinding::GetSquirrelInstance(m_pVM, 1);
 }
 
 void CSquirrelVM::RegisterClassFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount, const char* szFunctionTemplate)
 {
+	if(m_iClassTop == -1)
+		return;
+
+	// Same wrapper as for global functions, profiled as Class.method
 	sq_pushstring(m_pVM, szFunctionName, -1);
-	sq_newclosure(m_pVM, (SQFUNCTION)pfnFunction, 0);
+	sq_pushuserpointer(m_pVM, CScriptProfiler::AddNative(this, GetResource(), CString("%s.%s", m_strClassName.Get(), szFunctionName), pfnFunction));
+	sq_newclosure(m_pVM, ProfiledNative, 1);
 	sq_newslot(m_pVM, -3, SQFalse);
 }
 
@@ -339,6 +541,11 @@ void CSquirrelVM::Push(const CString& str)
 	sq_pushstring(m_pVM, str.Get(), str.GetLength());
 }
 
+void CSquirrelVM::Push(const char* szString)
+{
+	sq_pushstring(m_pVM, szString, -1);
+}
+
 void CSquirrelVM::Push(const CVector3& vec)
 {
 	Push(vec.fX);
@@ -349,7 +556,7 @@ void CSquirrelVM::Push(const CVector3& vec)
 void CSquirrelVM::PushArray(const CScriptArguments &array)
 {
 	sq_newarray(m_pVM, 0);
-	for(auto pArgument : array.m_Arguments)
+	for(auto pArgument = array.begin(); pArgument != array.end(); ++pArgument)
 	{
 		pArgument->Push(this);
 
@@ -361,11 +568,11 @@ void CSquirrelVM::PushArray(const CScriptArguments &array)
 void CSquirrelVM::PushTable(const CScriptArguments &table)
 {
 	sq_newtable(m_pVM);
-	for(auto iter = table.m_Arguments.begin(); iter != table.m_Arguments.end(); iter++)
+	for(auto iter = table.begin(); iter != table.end(); iter++)
 	{
-		(*iter)->Push(this);
+		iter->Push(this);
 		++iter;
-		(*iter)->Push(this);
+		iter->Push(this);
 		sq_createslot(m_pVM, -3);
 	}
 }
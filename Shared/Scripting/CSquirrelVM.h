@@ -20,6 +20,8 @@ class CSquirrelVM : public CScriptVM {
 private:
 	SQVM*		m_pVM;
 	int m_iStackIndex;
+	int m_iClassTop;
+	CString m_strClassName;
 public:
 	CSquirrelVM(CResource * pResource);
 	~CSquirrelVM();
@@ -29,6 +31,10 @@ public:
 
 	virtual bool LoadScript(CString script);		// Replace string with script
 	virtual bool LoadScripts(std::list<CScript> scripts);
+	virtual bool RunScript(const CString& script, const std::string& strChunk, bool bCached);
+
+	// Compiles a script on a private vm, can be called from any thread
+	static bool	 Compile(const CString& strPath, const std::string& strSource, std::string& strChunk, CString& strError);
 
 	virtual void Pop(bool& b);
 	virtual void Pop(int& i);
@@ -46,6 +52,7 @@ public:
 	virtual void Push(const int& i);
 	virtual void Push(const float& f);
 	virtual void Push(const CString& str);
+	virtual void Push(const char* szString);
 	virtual void Push(const CVector3& vec);
 	virtual void PushArray(const CScriptArguments &array);
 	virtual void PushTable(const CScriptArguments &table);
@@ -59,10 +66,13 @@ public:
 
 	virtual void RegisterScriptClass(const char* className, scriptFunction pfnFunction, const char* baseClass = 0);
 	virtual void RegisterClassFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount = -1, const char* szFunctionTemplate = NULL);
+	virtual void FinishScriptClass();
 	virtual void SetClassInstance(const char* szClassName, void * pInstance);
 	void		 *GetClassInstance(const char* szClassName);
 
 	void		 RegisterFunction(const char* szFunctionName, scriptFunction pfnFunction, int iParameterCount = -1, const char* szFunctionTemplate = NULL, bool bPushRootTable = false);
+
+	virtual void SetProfilerHook(bool bEnabled);
 };
 
 #endif // CSquirrelVM_h
\ No newline at end of file
@@ -11,169 +11,55 @@
 
 #include <Scripting/CLuaVM.h>
 #include <Scripting/CSquirrelVM.h>
+#include <Scripting/CScriptBinding.h>
 #include <CLogFile.h>
 #include <Scripting/ResourceSystem/CResourceManager.h>
 
 void CMathNatives::Register(CScriptVM * pVM)
 {
-	pVM->RegisterFunction("getDistanceBetweenPoints2D", GetDistanceBetweenPoints2D);
-	pVM->RegisterFunction("getDistanceBetweenPoints3D", GetDistanceBetweenPoints3D);
-	pVM->RegisterFunction("isPointInCircle", IsPointInCircle);
-	pVM->RegisterFunction("isPointInTube", IsPointInTube);
-	pVM->RegisterFunction("isPointInBall", IsPointInBall);
-	pVM->RegisterFunction("isPointInArea", IsPointInArea);
-	pVM->RegisterFunction("isPointInCuboid", IsPointInCuboid);
+	pVM->RegisterFunction("getDistanceBetweenPoints2D", BIND_NATIVE(pVM, GetDistanceBetweenPoints2D));
+	pVM->RegisterFunction("getDistanceBetweenPoints3D", BIND_NATIVE(pVM, GetDistanceBetweenPoints3D));
+	pVM->RegisterFunction("isPointInCircle", BIND_NATIVE(pVM, IsPointInCircle));
+	pVM->RegisterFunction("isPointInTube", BIND_NATIVE(pVM, IsPointInTube));
+	pVM->RegisterFunction("isPointInBall", BIND_NATIVE(pVM, IsPointInBall));
+	pVM->RegisterFunction("isPointInArea", BIND_NATIVE(pVM, IsPointInArea));
+	pVM->RegisterFunction("isPointInCuboid", BIND_NATIVE(pVM, IsPointInCuboid));
 	pVM->RegisterFunction("isPointInPolygon", IsPointInPolygon);
 }
 
-int CMathNatives::GetDistanceBetweenPoints2D(int * VM)
+float CMathNatives::GetDistanceBetweenPoints2D(float x, float y, float xx, float yy)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float x, y, xx, yy;
-
-	pVM->Pop(x);
-	pVM->Pop(y);
-	pVM->Pop(xx);
-	pVM->Pop(yy);
-
-	pVM->Push(Math::GetDistanceBetweenPoints2D(x, y, xx, yy));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::GetDistanceBetweenPoints2D(x, y, xx, yy);
 }
 
-int CMathNatives::GetDistanceBetweenPoints3D(int * VM)
+float CMathNatives::GetDistanceBetweenPoints3D(float x, float y, float z, float xx, float yy, float zz)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float x, y, z, xx, yy, zz;
-
-	pVM->Pop(x);
-	pVM->Pop(y);
-	pVM->Pop(z);
-	pVM->Pop(xx);
-	pVM->Pop(yy);
-	pVM->Pop(zz);
-
-	pVM->Push(Math::GetDistanceBetweenPoints3D(x, y, z, xx, yy, zz));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::GetDistanceBetweenPoints3D(x, y, z, xx, yy, zz);
 }
 
-int CMathNatives::IsPointInCircle(int * VM)
+bool CMathNatives::IsPointInCircle(float x, float y, float xx, float yy, float radius)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float x, y, xx, yy, radius;
-
-	pVM->Pop(x);
-	pVM->Pop(y);
-	pVM->Pop(xx);
-	pVM->Pop(yy);
-	pVM->Pop(radius);
-
-	pVM->Push(Math::IsPointInCircle(x, y, radius, xx, yy));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::IsPointInCircle(x, y, radius, xx, yy);
 }
 
-int CMathNatives::IsPointInTube(int * VM)
+bool CMathNatives::IsPointInTube(float tubex, float tubey, float tubez, float tubeheight, float tuberadius, float x, float y, float z)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float tubex, tubey, tubez, tubeheight, tuberadius, x, y, z;
-
-	pVM->Pop(tubex);
-	pVM->Pop(tubey);
-	pVM->Pop(tubez);
-	pVM->Pop(tubeheight);
-	pVM->Pop(tuberadius);
-	pVM->Pop(x);
-	pVM->Pop(y);
-	pVM->Pop(z);
-
-	pVM->Push(Math::IsPointInTube(tubex, tubey, tubez, tubeheight, tuberadius, x, y, z));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::IsPointInTube(tubex, tubey, tubez, tubeheight, tuberadius, x, y, z);
 }
 
-int CMathNatives::IsPointInBall(int * VM)
+bool CMathNatives::IsPointInBall(float x, float y, float z, float xx, float yy, float zz, float radius)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float x, y, z, xx, yy, zz, radius;
-
-	pVM->Pop(x);
-	pVM->Pop(y);
-	pVM->Pop(z);
-	pVM->Pop(xx);
-	pVM->Pop(yy);
-	pVM->Pop(zz);
-	pVM->Pop(radius);
-
-	pVM->Push(Math::IsPointInBall(x, y, z, radius, xx, yy, zz));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::IsPointInBall(x, y, z, radius, xx, yy, zz);
 }
 
-int CMathNatives::IsPointInArea(int * VM)
+bool CMathNatives::IsPointInArea(float areax, float areay, float areaxx, float areayy, float pointx, float pointy)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float areax, areay, areaxx, areayy, pointx, pointy;
-
-	pVM->Pop(areax);
-	pVM->Pop(areay);
-	pVM->Pop(areaxx);
-	pVM->Pop(areayy);
-	pVM->Pop(pointx);
-	pVM->Pop(pointy);
-
-	pVM->Push(Math::IsPointInArea(areax, areay, areaxx, areayy, pointx, pointy));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::IsPointInArea(areax, areay, areaxx, areayy, pointx, pointy);
 }
 
-int CMathNatives::IsPointInCuboid(int * VM)
+bool CMathNatives::IsPointInCuboid(float areax, float areay, float areaz, float areaxx, float areayy, float areazz, float pointx, float pointy, float pointz)
 {
-	GET_SCRIPT_VM_SAFE;
-	pVM->ResetStackIndex();
-
-	float areax, areay, areaz, areaxx, areayy, areazz, pointx, pointy, pointz;
-
-	pVM->Pop(areax);
-	pVM->Pop(areay);
-	pVM->Pop(areaz);
-	pVM->Pop(areaxx);
-	pVM->Pop(areayy);
-	pVM->Pop(areazz);
-	pVM->Pop(pointx);
-	pVM->Pop(pointy);
-	pVM->Pop(pointz);
-
-	pVM->Push(Math::IsPointInCuboid(areax, areay, areaz, areaxx, areayy, areazz, pointx, pointy, pointz));
-
-	pVM->ResetStackIndex();
-
-	return 1;
+	return Math::IsPointInCuboid(areax, areay, areaz, areaxx, areayy, areazz, pointx, pointy, pointz);
 }
 
 int CMathNatives::IsPointInPolygon(int * VM)
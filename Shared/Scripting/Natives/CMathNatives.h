@@ -15,14 +15,14 @@
 class CMathNatives {
 
 private:
-	static int	GetDistanceBetweenPoints2D(int * pVM);
-	static int	GetDistanceBetweenPoints3D(int * pVM);
-	static int	IsPointInCircle(int * pVM);
-	static int	IsPointInTube(int * pVM);
-	static int	IsPointInBall(int * pVM);
-	static int	IsPointInArea(int * pVM);
-	static int	IsPointInCuboid(int * pVM);
-	static int	IsPointInPolygon(int * pVM);
+	static float	GetDistanceBetweenPoints2D(float x, float y, float xx, float yy);
+	static float	GetDistanceBetweenPoints3D(float x, float y, float z, float xx, float yy, float zz);
+	static bool		IsPointInCircle(float x, float y, float xx, float yy, float radius);
+	static bool		IsPointInTube(float tubex, float tubey, float tubez, float tubeheight, float tuberadius, float x, float y, float z);
+	static bool		IsPointInBall(float x, float y, float z, float xx, float yy, float zz, float radius);
+	static bool		IsPointInArea(float areax, float areay, float areaxx, float areayy, float pointx, float pointy);
+	static bool		IsPointInCuboid(float areax, float areay, float areaz, float areaxx, float areayy, float areazz, float pointx, float pointy, float pointz);
+	static int		IsPointInPolygon(int * pVM);
 public:
 	static void Register(CScriptVM* pVM);
 };
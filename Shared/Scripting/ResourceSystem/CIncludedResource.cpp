@@ -9,7 +9,10 @@
 
 #include "CIncludedResource.h"
 
-CIncludedResource::CIncludedResource()
+CIncludedResource::CIncludedResource(CResource * owner, const CString& strName)
+	: m_resource(NULL),
+	m_owner(owner),
+	m_strName(strName)
 {
 
 }
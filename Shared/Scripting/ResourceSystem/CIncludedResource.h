@@ -10,6 +10,7 @@
 #ifndef CIncludedResource_h
 #define CIncludedResource_h
 
+#include <CString.h>
 #include "CResource.h"
 
 class CIncludedResource {
@@ -17,11 +18,14 @@ class CIncludedResource {
 private:
 	class CResource *		m_resource; // the resource this links to
 	class CResource *		m_owner; // the resource this is inside
+	CString					m_strName;
 public:
-	CIncludedResource();
+	CIncludedResource(CResource * owner, const CString& strName);
 	~CIncludedResource();
 
 	inline CResource *          GetResource() { return m_resource; }
+	inline void                 SetResource(CResource * resource) { m_resource = resource; }
+	inline const CString&       GetName() { return m_strName; }
 };
 
 #endif // CIncludedResource_h
\ No newline at end of file
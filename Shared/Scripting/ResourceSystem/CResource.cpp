@@ -14,6 +14,7 @@
 #include "../CSquirrelVM.h"
 #include "CResourceServerScript.h"
 #include "CResourceClientScript.h"
+#include "CResourceClientFile.h"
 #include <SharedUtility.h>
 #include <CXML.h>
 #include <Scripting/Natives/Natives.h>
@@ -22,8 +23,14 @@
 #ifdef _CLIENT
 #else
 #include "../../Server/Scripting/Natives/Natives.h"
+#include "../../Server/CTimerWheel.h"
+#include "../../Server/CDatabaseManager.h"
+#include "../../Server/CHttpServer.h"
 #endif
 
+// The squirrel headers it includes break <memory>, so it has to come last
+#include "../CEvents.h"
+
 CResource::CResource()
 	: m_pVM(0),
 	m_strAbsPath(""),
@@ -98,7 +105,7 @@ bool CResource::Load()
 
 				CString strIncludedResource = pMetaXML->getAttribute("resource");
 				if(!strIncludedResource.IsEmpty())
-					m_includedResources.push_back(new CIncludedResource()); // TODO PARAMS
+					m_includedResources.push_back(new CIncludedResource(this, strIncludedResource));
 				else
 					CLogFile::Printf("[WARNING] Emtpy 'resource' attribute from 'include' node of 'meta.xml' for resource %s", m_strResourceName.Get());
 			}
@@ -168,7 +175,8 @@ bool CResource::Load()
 			{
 				CString strFile = pMetaXML->getAttribute("src");
 
-				CLogFile::Printf("\t[TODO] Implement client file manager which handles resource client files and then the loading stuff");
+				if(!strFile.IsEmpty())
+					m_resourceFiles.push_back(new CResourceClientFile(this, strFile.Get(), (GetResourceDirectoryPath() + strFile).Get()));
 			}
 			if(!pMetaXML->nextNode())
 				break;
@@ -184,19 +192,46 @@ bool CResource::Load()
 	return true;
 }
 
+bool CResource::Compile()
+{
+	if(!IsLoaded())
+		return false;
+
+	eVMType vmType;
+
+	if(GetResourceScriptType() == LUA_RESOURCE)
+		vmType = LUA_VM;
+	else if(GetResourceScriptType() == SQUIRREL_RESOURCE)
+		vmType = SQUIRREL_VM;
+	else
+		return false;
+
+	for(auto pResourceFile : m_resourceFiles)
+	{
+		if(pResourceFile->GetType() == CResourceFile::RESOURCE_FILE_TYPE_SERVER_SCRIPT)
+		{
+			if(!((CResourceServerScript *)pResourceFile)->Compile(vmType))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 bool CResource::Start(std::list<CResource*> * dependents, bool bStartManually, bool bStartIncludedResources)
 {
 	if(IsLoaded())
 	{
-		
+		unsigned long ulStartTime = SharedUtility::GetTime();
+
 		CreateVM();
 
 		for(auto pResourceFile : m_resourceFiles)
 		{
 			if(!pResourceFile->Start())
 			{
-				// Stop all the resource items without any warnings
-				//StopAllResourceFiles();
+				// Scripts which already ran may have left timers, handlers, queries and downloads behind
+				Stop();
 				DestroyVM();
 
 				m_bActive = false;
@@ -232,6 +267,10 @@ bool CResource::Start(std::list<CResource*> * dependents, bool bStartManually, b
 			}
 		}
 
+		m_bActive = true;
+
+		// Compare cold and warm script cache starts
+		CLogFile::Printf("\t[%s] Started in %lums.", m_strResourceName.Get(), (SharedUtility::GetTime() - ulStartTime));
 		return true;
 	}
 
@@ -240,6 +279,26 @@ bool CResource::Start(std::list<CResource*> * dependents, bool bStartManually, b
 
 bool CResource::Stop(bool bStopManually)
 {
+	// Remove its event handlers
+	if(m_pVM && CEvents::GetInstance())
+		CEvents::GetInstance()->RemoveScript(m_pVM);
+
+#ifdef _SERVER
+	// Kill all timers of this resource
+	if(CTimerWheel::GetInstance())
+		CTimerWheel::GetInstance()->RemoveResource(this);
+
+	// Drop its pending queries and close its databases
+	if(CDatabaseManager::GetInstance())
+		CDatabaseManager::GetInstance()->RemoveResource(this);
+
+	// Its files can't be downloaded anymore
+	if(CHttpServer::GetInstance())
+		CHttpServer::GetInstance()->RemoveResource(m_strResourceName);
+#endif
+
+	m_bActive = false;
+
 	CLogFile::Printf("[TODO] Implement %s", __FUNCTION__);
 	return true;
 }
@@ -275,6 +334,8 @@ bool CResource::CreateVM()
 #ifdef _SERVER
 		CScriptClasses::Register(m_pVM);
 		CServerNatives::Register(m_pVM);
+		CTimerNatives::Register(m_pVM);
+		CDatabaseNatives::Register(m_pVM);
 #endif
 
 		CEventNatives::Register(m_pVM);
@@ -60,6 +60,8 @@ public:
 	void		DestroyVM();
 
 	bool		Load();
+	// Compiles the server scripts without touching the vm, safe to call from a worker thread
+	bool		Compile();
 	bool		Unload();
 	void		Reload();
 
@@ -70,6 +72,7 @@ public:
 	int								GetDependentCount() { return m_dependents.size(); }
 	std::list<CIncludedResource*>*	GetIncludedResources() { return &m_includedResources; }
 	int								GetIncludedResourcesCount() { return m_includedResources.size(); }
+	std::list<CResourceFile*>*		GetResourceFiles() { return &m_resourceFiles; }
 
 	void		AddDependent(CResource* pResource);
 	void		RemoveDependet(CResource* pResource);
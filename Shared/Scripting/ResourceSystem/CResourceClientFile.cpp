@@ -8,14 +8,43 @@
 //==============================================================================
 
 #include "CResourceClientFile.h"
+#include "CResource.h"
+#include <CLogFile.h>
 
+#ifdef _SERVER
+#include "../../Server/CHttpServer.h"
+#endif
 
-CResourceClientFile::CResourceClientFile()
+CResourceClientFile::CResourceClientFile(CResource * resource, const char * szShortName, const char * szResourceFileName)
+	: CResourceFile(resource, szShortName, szResourceFileName)
 {
-
+	m_type = RESOURCE_FILE_TYPE_CLIENT_FILE;
 }
 
 CResourceClientFile::~CResourceClientFile()
 {
 
+}
+
+bool CResourceClientFile::Start()
+{
+#ifdef _SERVER
+	// Hash it now, the resource syncs of the players only use the result
+	if(!UpdateChecksum())
+		CLogFile::Logf(LOG_CATEGORY_NETWORK, LOG_LEVEL_ERROR, "[network] Can't read client file %s of resource %s.", m_strShortName.Get(), m_resource->GetName().Get());
+
+	// Let the clients download it
+	if(CHttpServer::GetInstance())
+		CHttpServer::GetInstance()->AddFile(m_resource->GetName(), m_strShortName, m_strResourceFileName);
+#endif
+	return true;
+}
+
+bool CResourceClientFile::Stop()
+{
+#ifdef _SERVER
+	if(CHttpServer::GetInstance())
+		CHttpServer::GetInstance()->RemoveFile(m_resource->GetName(), m_strShortName);
+#endif
+	return true;
 }
\ No newline at end of file
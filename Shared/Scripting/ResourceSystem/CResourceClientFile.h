@@ -10,13 +10,20 @@
 #ifndef CResourceClientFile_h
 #define CResourceClientFile_h
 
-class CResourceClientFile {
+#include "CResourceFile.h"
+
+class CResource;
+
+class CResourceClientFile : public CResourceFile {
 
 private:
 
 public:
-	CResourceClientFile();
+	CResourceClientFile(CResource * resource, const char * szShortName, const char * szResourceFileName);
 	~CResourceClientFile();
+
+	bool	Start();
+	bool	Stop();
 };
 
 #endif // CResourceClientFile_h
\ No newline at end of file
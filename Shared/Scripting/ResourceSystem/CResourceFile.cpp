@@ -8,6 +8,9 @@
 //==============================================================================
 
 #include "CResourceFile.h"
+#include <CRC.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 
 CResourceFile::CResourceFile(CResource * resource, const char * szShortName, const char * szResourceFileName)
@@ -26,9 +29,44 @@ CResourceFile::CResourceFile(CResource * resource, const char * szShortName, con
 	m_strWindowsName = m_strShortName;
 
 	m_resource = resource;
+
+	m_bChecksumValid = false;
+	m_uiChecksum = 0;
+	m_llSize = 0;
+	m_modificationTime = 0;
 }
 
 CResourceFile::~CResourceFile()
 {
 
+}
+
+bool CResourceFile::UpdateChecksum()
+{
+	struct stat fileStat;
+
+	if(stat(m_strResourceFileName.Get(), &fileStat) != 0)
+	{
+		m_bChecksumValid = false;
+		return false;
+	}
+
+	// Did the file change since we last looked at it?
+	if(!m_bChecksumValid || m_llSize != (long long)fileStat.st_size || m_modificationTime != fileStat.st_mtime)
+	{
+		CFileChecksum checksum;
+
+		if(!checksum.Calculate(m_strResourceFileName))
+		{
+			m_bChecksumValid = false;
+			return false;
+		}
+
+		m_uiChecksum = checksum.GetChecksum();
+		m_llSize = (long long)fileStat.st_size;
+		m_modificationTime = fileStat.st_mtime;
+		m_bChecksumValid = true;
+	}
+
+	return true;
 }
\ No newline at end of file
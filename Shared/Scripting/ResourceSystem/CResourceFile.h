@@ -33,6 +33,12 @@ protected:
 	CString						m_strShortName;         // just the filename
 	CString						m_strWindowsName;       // the name with backwards slashes
 	eResourceType				m_type;
+
+	// Content checksum, only recalculated when the size or modification time of the file changed
+	bool						m_bChecksumValid;
+	unsigned int				m_uiChecksum;
+	long long					m_llSize;
+	time_t						m_modificationTime;
 public:
 	CResourceFile(CResource * resource, const char * szShortName, const char * szResourceFileName);
 	~CResourceFile();
@@ -40,6 +46,12 @@ public:
 	inline eResourceType		GetType() { return m_type; }
 	inline const char *			GetName() { return m_strShortName.Get(); }
 
+	// Recalculates the checksum if the file changed since the last call, done when the resource starts
+	bool						UpdateChecksum();
+
+	// The checksum of the last update, doesn't touch the file
+	inline bool					GetChecksum(unsigned int& uiChecksum, long long& llSize) { uiChecksum = m_uiChecksum; llSize = m_llSize; return m_bChecksumValid; }
+
 	virtual bool				Start() = 0;
 	virtual bool				Stop() = 0;
 };
@@ -12,7 +12,12 @@
 #include "../CSquirrelVM.h"
 #include <assert.h>
 #include <CLogFile.h>
+#include <SharedUtility.h>
+#include <Threading/CThread.h>
+#include <RakNet/RakSleep.h>
 #include <algorithm>
+#include <vector>
+#include <thread>
 
 CResourceManager* CResourceManager::s_pInstance = NULL;
 
@@ -51,32 +56,40 @@ void CResourceManager::RemoveResource(CResource * pResource)
 	m_resources.remove(pResource);
 }
 
+void CResourceManager::AddVM(int * pVM, CResource * pResource)
+{
+	m_vmResources[pVM] = pResource;
+}
+
+void CResourceManager::RemoveVM(int * pVM)
+{
+	m_vmResources.erase(pVM);
+}
+
 CResource * CResourceManager::Get(int * pVM) // TODO: change to GetResourceByVM
-{ 
-	for(auto pResource : m_resources) 
-	{ 
-		if(pResource)
-		{
-			if(pResource->GetVM()->GetVMType() == LUA_VM)
-			{
-				CLuaVM* pLuaVM = (CLuaVM*)pResource->GetVM();
-				if(pLuaVM && pLuaVM->GetVM() == (lua_State*)pVM) {
-					return pResource;
-				}
-			} 
-			else if(pResource->GetVM()->GetVMType() == SQUIRREL_VM) 
-			{
-				CSquirrelVM* pLuaVM = (CSquirrelVM*)pResource->GetVM();
-				if(pLuaVM && pLuaVM->GetVM() == (SQVM*)pVM) {
-					return pResource;
-				}
-			}
-		}
+{
+	// Natives only get the raw vm handle, which doesn't tell us the vm type,
+	// so every vm registers its handle when it's opened
+	auto it = m_vmResources.find(pVM);
+
+	if(it == m_vmResources.end())
+		return 0;
+
+	return it->second;
+}
+
+
+CResource * CResourceManager::GetResource(CString strResourceName)
+{
+	for(auto pResource : m_resources)
+	{
+		if(pResource->GetName() == strResourceName)
+			return pResource;
 	}
+
 	return 0;
 }
 
-
 bool CResourceManager::Reload(CResource* pResource)
 {
 	pResource->Reload();
@@ -153,4 +166,225 @@ CResource* CResourceManager::Load(CString strAbsPath, CString strResourceName)
 	}
 
 	return 0;
+}
+
+enum eSortState
+{
+	SORT_NONE,
+	SORT_VISITING,
+	SORT_DONE,
+};
+
+struct LoadJob
+{
+	CString			strName;
+	CResource		* pResource;
+	bool			bCompiled;
+	eSortState		sortState;
+	unsigned long	ulLoadTime;
+	unsigned long	ulCompileTime;
+	unsigned long	ulStartTime;
+};
+
+struct LoadQueue
+{
+	CString					strAbsPath;
+	std::vector<LoadJob>	jobs;
+	size_t					sNextJob;
+	unsigned int			uiFinishedWorkers;
+	CMutex					mutex;
+};
+
+static void ProcessLoadQueue(LoadQueue * pQueue)
+{
+	while(true)
+	{
+		// Take the next job
+		pQueue->mutex.Lock();
+		size_t sJob = pQueue->sNextJob++;
+		pQueue->mutex.Unlock();
+
+		if(sJob >= pQueue->jobs.size())
+			break;
+
+		// Every job is only touched by one thread until all workers are done
+		LoadJob& job = pQueue->jobs[sJob];
+
+		// Parse the meta file
+		unsigned long ulTime = SharedUtility::GetTime();
+		job.pResource = new CResource(pQueue->strAbsPath, job.strName);
+		job.ulLoadTime = (SharedUtility::GetTime() - ulTime);
+
+		// Compile the scripts, the vm is created later on the main thread
+		ulTime = SharedUtility::GetTime();
+		job.bCompiled = job.pResource->Compile();
+		job.ulCompileTime = (SharedUtility::GetTime() - ulTime);
+	}
+}
+
+static void LoadWorker(CThread * pThread)
+{
+	LoadQueue * pQueue = pThread->GetUserData<LoadQueue *>();
+
+	ProcessLoadQueue(pQueue);
+
+	pQueue->mutex.Lock();
+	pQueue->uiFinishedWorkers++;
+	pQueue->mutex.Unlock();
+}
+
+static void AddInDependencyOrder(std::vector<LoadJob>& jobs, const std::unordered_map<std::string, size_t>& jobIndices, size_t sJob, std::vector<size_t>& order)
+{
+	LoadJob& job = jobs[sJob];
+
+	if(job.sortState == SORT_DONE)
+		return;
+
+	if(job.sortState == SORT_VISITING)
+	{
+		CLogFile::Printf("Warning: Resource %s includes itself, the start order of the cycle is undefined.", job.strName.Get());
+		return;
+	}
+
+	job.sortState = SORT_VISITING;
+
+	// The included resources have to run first
+	if(job.pResource->IsLoaded())
+	{
+		for(auto pIncludedResource : *job.pResource->GetIncludedResources())
+		{
+			auto it = jobIndices.find(pIncludedResource->GetName().Get());
+
+			if(it != jobIndices.end())
+				AddInDependencyOrder(jobs, jobIndices, it->second, order);
+		}
+	}
+
+	job.sortState = SORT_DONE;
+	order.push_back(sJob);
+}
+
+int CResourceManager::LoadAndStart(CString strAbsPath, const std::list<CString>& resourceNames, int& iFailed)
+{
+	unsigned long ulStartupTime = SharedUtility::GetTime();
+	LoadQueue queue;
+	queue.strAbsPath = strAbsPath;
+	queue.sNextJob = 0;
+	queue.uiFinishedWorkers = 0;
+
+	std::unordered_map<std::string, size_t> jobIndices;
+
+	for(auto strResource : resourceNames)
+	{
+		// Skip empty entries and resources listed twice
+		if(strResource.IsEmpty() || jobIndices.find(strResource.Get()) != jobIndices.end())
+			continue;
+
+		LoadJob job;
+		job.strName = strResource;
+		job.pResource = NULL;
+		job.bCompiled = false;
+		job.sortState = SORT_NONE;
+		job.ulLoadTime = 0;
+		job.ulCompileTime = 0;
+		job.ulStartTime = 0;
+
+		jobIndices[strResource.Get()] = queue.jobs.size();
+		queue.jobs.push_back(job);
+	}
+
+	iFailed = 0;
+
+	if(queue.jobs.empty())
+		return 0;
+
+	// The calling thread works on the queue too
+	unsigned int uiThreads = std::thread::hardware_concurrency();
+	uiThreads = std::min(std::min((uiThreads > 1 ? (uiThreads - 1) : 0), (unsigned int)(queue.jobs.size() - 1)), (unsigned int)RESOURCE_LOADER_MAX_THREADS);
+
+	CThread * pThreads = (uiThreads > 0 ? new CThread[uiThreads] : NULL);
+
+	for(unsigned int i = 0; i < uiThreads; i++)
+	{
+		pThreads[i].SetUserData(&queue);
+		pThreads[i].Start(LoadWorker);
+	}
+
+	ProcessLoadQueue(&queue);
+
+	// Wait for the workers
+	while(true)
+	{
+		queue.mutex.Lock();
+		bool bFinished = (queue.uiFinishedWorkers == uiThreads);
+		queue.mutex.Unlock();
+
+		if(bFinished)
+			break;
+
+		RakSleep(1);
+	}
+
+	for(unsigned int i = 0; i < uiThreads; i++)
+	{
+		while(pThreads[i].IsRunning())
+			RakSleep(1);
+	}
+
+	SAFE_DELETE_ARRAY(pThreads);
+
+	unsigned long ulLoadTime = (SharedUtility::GetTime() - ulStartupTime);
+
+	// Included resources start before the resources including them, the rest keeps the configured order
+	std::vector<size_t> order;
+
+	for(size_t i = 0; i < queue.jobs.size(); i++)
+		AddInDependencyOrder(queue.jobs, jobIndices, i, order);
+
+	// Run the top-level code of the scripts, natives and vms aren't thread safe
+	int iStarted = 0;
+
+	for(auto sJob : order)
+	{
+		LoadJob& job = queue.jobs[sJob];
+
+		if(!job.pResource->IsLoaded() || !job.bCompiled)
+		{
+			CLogFile::Printf("Warning: Failed to %s resource %s.", (job.pResource->IsLoaded() ? "compile" : "load"), job.strName.Get());
+			SAFE_DELETE(job.pResource);
+			iFailed++;
+			continue;
+		}
+
+		AddResource(job.pResource);
+
+		// Link the included resources which are available
+		for(auto pIncludedResource : *job.pResource->GetIncludedResources())
+			pIncludedResource->SetResource(GetResource(pIncludedResource->GetName()));
+
+		unsigned long ulTime = SharedUtility::GetTime();
+		bool bStarted = StartResource(job.pResource);
+		job.ulStartTime = (SharedUtility::GetTime() - ulTime);
+
+		if(bStarted)
+		{
+			iStarted++;
+		}
+		else
+		{
+			CLogFile::Printf("Warning: Failed to start resource %s.", job.strName.Get());
+			iFailed++;
+		}
+	}
+
+	// Report where the time went
+	CLogFile::Printf("Loaded resources in %lums on %d thread(s), started them in %lums:", ulLoadTime, (uiThreads + 1), (SharedUtility::GetTime() - ulStartupTime - ulLoadTime));
+
+	for(auto sJob : order)
+	{
+		LoadJob& job = queue.jobs[sJob];
+		CLogFile::Printf("\t%-24s load %4lums  compile %4lums  start %4lums", job.strName.Get(), job.ulLoadTime, job.ulCompileTime, job.ulStartTime);
+	}
+
+	return iStarted;
 }
\ No newline at end of file
@@ -12,12 +12,19 @@
 
 #include "CResource.h"
 #include "../CLuaVM.h"
+#include <unordered_map>
+
+// Upper limit for the worker threads loading the resources at startup
+#define RESOURCE_LOADER_MAX_THREADS 8
 
 class CResourceManager {
 
 private:
 	CString					m_strResourceDirectory;
 	std::list<CResource*>	m_resources;
+
+	// Maps the native vm handles (lua_State / SQVM) to their resource
+	std::unordered_map<int*, CResource*>	m_vmResources;
 	static CResourceManager*s_pInstance;
 public:
 	CResourceManager();
@@ -29,6 +36,10 @@ public:
 	CString		GetResourceDirectory() { return m_strResourceDirectory; }
 
 	CResource	*Load(CString strAbsPath, CString strResourceName);
+
+	// Loads the meta files and compiles the scripts on worker threads, then starts the resources
+	// in dependency order on the calling thread. Returns the number of started resources
+	int			LoadAndStart(CString strAbsPath, const std::list<CString>& resourceNames, int& iFailed);
 	void		Unload(CResource* pResource);
 
 	bool		StartResource(CResource* pResource, std::list<CResource*> * dependents = NULL, bool bStartedManually = false, bool bStartIncludedResources = true);
@@ -39,7 +50,11 @@ public:
 	void		RemoveResource(CResource* pResource);
 
 	CResource				*GetResource(CString strResourceName);
-	std::list<CResource*>	GetResources() { m_resources; }
+	std::list<CResource*>	GetResources() { return m_resources; }
+
+	// Called by the vms when they open/close their native vm
+	void		AddVM(int * pVM, CResource * pResource);
+	void		RemoveVM(int * pVM);
 
 	CResource *Get(int * pVM);
 };
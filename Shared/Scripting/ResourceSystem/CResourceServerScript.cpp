@@ -10,9 +10,12 @@
 #include "CResourceServerScript.h"
 
 #include "CResource.h"
+#include "../CScriptCache.h"
 
 CResourceServerScript::CResourceServerScript(CResource * resource, const char * szShortName, const char * szResourceFileName)
-	: CResourceScriptFile(resource, szShortName, szResourceFileName)
+	: CResourceScriptFile(resource, szShortName, szResourceFileName),
+	m_bCompiled(false),
+	m_bCached(false)
 {
 	m_type = RESOURCE_FILE_TYPE_SERVER_SCRIPT;
 }
@@ -22,10 +25,26 @@ CResourceServerScript::~CResourceServerScript()
 
 }
 
+bool CResourceServerScript::Compile(eVMType vmType)
+{
+	m_bCompiled = CScriptCache::Compile(m_resource, vmType, m_strShortName, m_strChunk, m_bCached);
+	return m_bCompiled;
+}
+
 bool CResourceServerScript::Start()
 {
-	m_resource->GetVM()->LoadScript(m_strShortName);
-	return true;
+	CScriptVM * pVM = m_resource->GetVM();
+
+	// Compile it now if the startup pipeline didn't do it already
+	if(!m_bCompiled && !Compile(pVM->GetVMType()))
+		return false;
+
+	bool bSuccess = pVM->RunScript(m_strShortName, m_strChunk, m_bCached);
+
+	// The chunk is only needed once
+	std::string().swap(m_strChunk);
+	m_bCompiled = false;
+	return bSuccess;
 }
 
 bool CResourceServerScript::Stop()
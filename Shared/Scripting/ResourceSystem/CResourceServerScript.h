@@ -11,17 +11,25 @@
 #define CResourceServerScript_h
 
 #include "CResourceScriptFile.h"
+#include "../CScriptVM.h"
+#include <string>
 
 class CResource;
 
 class CResourceServerScript : public CResourceScriptFile {
 
 private:
+	// Chunk compiled ahead of Start, only kept until it ran
+	std::string		m_strChunk;
+	bool			m_bCompiled;
+	bool			m_bCached;
 
 public:
 	CResourceServerScript(CResource * resource, const char * szShortName, const char * szResourceFileName);
 	~CResourceServerScript();
 
+	bool	Compile(eVMType vmType);
+
 	bool	Start();
 	bool	Stop();
 };